@@ -0,0 +1,145 @@
+#include "../include/game/creature_store.hpp"
+#include "../include/game/constants.hpp"
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <shared_mutex>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+// Сравнение прежней раскладки NPC (отдельный объект в куче с мьютексами)
+// и CreatureStore на циклах движения и подсчета статистики.
+// Использование: creature_store_bench [существ] [тиков]
+
+namespace {
+  // Раскладка NPC до перехода на CreatureStore
+  struct LegacyCreature {
+    NPCType type_;
+    double x_ = 0;
+    double y_ = 0;
+    std::string name_;
+    bool alive_ = true;
+    double moveDistance_ = 1.0;
+    double attackRange_ = 1.0;
+    mutable std::shared_mutex positionMutex_;
+    mutable std::mutex stateMutex_;
+
+    bool isAlive() const {
+      std::lock_guard lock(stateMutex_);
+      return alive_;
+    }
+
+    void move(MoveDirection direction) {
+      if (!isAlive()) return;
+      std::unique_lock lock(positionMutex_);
+      switch (direction) {
+        case MoveDirection::TOP: 
+          y_ = std::clamp(y_ + moveDistance_, ArenaConfig::WORLD_MIN_Y, ArenaConfig::WORLD_MAX_Y); 
+          break;
+        case MoveDirection::RIGHT: 
+          x_ = std::clamp(x_ + moveDistance_, ArenaConfig::WORLD_MIN_X, ArenaConfig::WORLD_MAX_X); 
+          break;
+        case MoveDirection::BOTTOM: 
+          y_ = std::clamp(y_ - moveDistance_, ArenaConfig::WORLD_MIN_Y, ArenaConfig::WORLD_MAX_Y); 
+          break;
+        case MoveDirection::LEFT: 
+          x_ = std::clamp(x_ - moveDistance_, ArenaConfig::WORLD_MIN_X, ArenaConfig::WORLD_MAX_X); 
+          break;
+      }
+    }
+  };
+
+  template <typename Body>
+  double measure(int ticks, Body&& body) {
+    auto start = std::chrono::steady_clock::now();
+    for (int tick = 0; tick < ticks; ++tick) {
+      body();
+    }
+    auto finish = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(finish - start).count() / ticks;
+  }
+}
+
+int main(int argc, char* argv[]) {
+  size_t population = argc > 1 ? std::stoul(argv[1]) : 1000000;
+  int ticks = argc > 2 ? std::stoi(argv[2]) : 10;
+
+  std::mt19937 gen(2024);
+  std::uniform_real_distribution<double> coord(ArenaConfig::WORLD_MIN_X, ArenaConfig::WORLD_MAX_X);
+  std::uniform_int_distribution<int> dirDist(0, 3);
+
+  std::vector<std::unique_ptr<LegacyCreature>> legacy;
+  CreatureStore store;
+  legacy.reserve(population);
+  store.reserve(population);
+
+  for (size_t i = 0; i < population; ++i) {
+    NPCType type = static_cast<NPCType>(1 + (i % 3));
+    double x = coord(gen);
+    double y = coord(gen);
+    std::string name = "NPC_" + std::to_string(i + 1);
+
+    auto creature = std::make_unique<LegacyCreature>();
+    creature->type_ = type;
+    creature->x_ = x;
+    creature->y_ = y;
+    creature->name_ = name;
+    creature->moveDistance_ = ArenaConfig::Mobility::KNIGHT_STEP;
+    creature->attackRange_ = ArenaConfig::Combat::KNIGHT_SWORD_REACH;
+    legacy.push_back(std::move(creature));
+
+    store.add(type, x, y, name, ArenaConfig::Mobility::KNIGHT_STEP,
+              ArenaConfig::Combat::KNIGHT_SWORD_REACH);
+  }
+
+  const double legacyMove = measure(ticks, [&]() {
+    for (auto& creature : legacy) {
+      creature->move(static_cast<MoveDirection>(dirDist(gen)));
+    }
+  });
+  const double storeMove = measure(ticks, [&]() {
+    for (size_t i = 0; i < store.size(); ++i) {
+      if (store.isAlive(i)) {
+        store.move(i, static_cast<MoveDirection>(dirDist(gen)));
+      }
+    }
+  });
+
+  size_t sink = 0;
+  const double legacyStats = measure(ticks, [&]() {
+    for (const auto& creature : legacy) {
+      if (creature->isAlive() && creature->type_ == NPCType::DRAGON) ++sink;
+    }
+  });
+  const double storeStats = measure(ticks, [&]() {
+    const uint8_t* types = store.typeData();
+    const uint8_t* alive = store.aliveData();
+    for (size_t i = 0; i < store.size(); ++i) {
+      if (alive[i] && types[i] == NPCType::DRAGON) ++sink;
+    }
+  });
+
+  const size_t legacyBytes = sizeof(LegacyCreature) + sizeof(std::unique_ptr<LegacyCreature>);
+  const size_t storeHotBytes = CreatureStore::hotBytesPerCreature();
+  const size_t storeBytes = storeHotBytes + sizeof(NameId);
+
+  std::cout << std::fixed << std::setprecision(2);
+  std::cout << "Существ: " << population << ", тиков: " << ticks << "\n\n";
+  std::cout << "Байт на существо (без учета кучи; имя - id в общей таблице):\n";
+  std::cout << "  прежний NPC:            " << legacyBytes << "\n";
+  std::cout << "  CreatureStore, горячие: " << storeHotBytes
+            << " (" << static_cast<double>(legacyBytes) / storeHotBytes << "x меньше)\n";
+  std::cout << "  CreatureStore, всего:   " << storeBytes
+            << " (" << static_cast<double>(legacyBytes) / storeBytes << "x меньше)\n\n";
+  std::cout << "Фаза движения, мс/тик:     " << legacyMove << " -> " << storeMove
+            << " (" << legacyMove / storeMove << "x)\n";
+  std::cout << "Подсчет статистики, мс/тик: " << legacyStats << " -> " << storeStats
+            << " (" << legacyStats / storeStats << "x)\n";
+  std::cout << "(контрольная сумма " << sink << ")\n";
+
+  return 0;
+}
@@ -0,0 +1,369 @@
+#include "../include/game/dungeon_master.hpp"
+#include "../include/game/factory.hpp"
+#include "../include/game/constants.hpp"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdio>
+
+// Микробенчмарки горячих путей NPC и боевой системы.
+// Результаты пишутся в JSON для построения графиков регрессий.
+// Использование: micro_bench [--populations 1000,10000] [--min-time 0.2]
+//                            [--out файл.json] [--filter подстрока]
+
+namespace {
+  struct BenchOptions {
+    std::vector<size_t> populations = {1000, 10000, 100000};
+    double minTime = 0.2;
+    std::string output;
+    std::string filter;
+  };
+
+  struct BenchResult {
+    std::string name;
+    size_t population;
+    size_t iterations;
+    double nsPerOp;
+    double itemsPerOp;
+  };
+
+  // Тело замера возвращает измеренное время (с) и число обработанных элементов,
+  // чтобы подготовку состояния можно было исключить из замера
+  struct Sample {
+    double seconds;
+    size_t items;
+  };
+  using BenchBody = std::function<Sample()>;
+
+  struct BenchCase {
+    std::string name;
+    std::function<BenchBody(size_t population)> setup;
+  };
+
+  template <typename Body>
+  double timeIt(Body&& body) {
+    auto start = std::chrono::steady_clock::now();
+    body();
+    auto finish = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(finish - start).count();
+  }
+
+  // Не дает компилятору выбросить результат
+  volatile double benchSink = 0;
+
+  // Временный файл удаляется вместе с последним владельцем
+  struct TemporaryFile {
+    std::string path;
+    explicit TemporaryFile(const std::string& tag): path("micro_bench_" + tag + ".tmp") {}
+    ~TemporaryFile() { std::remove(path.c_str()); }
+  };
+
+  std::unique_ptr<DungeonMaster> makeWorld(size_t population) {
+    auto world = std::make_unique<DungeonMaster>(false);
+    world->setSeed(2024);
+    world->initializeCreatures(static_cast<int>(population));
+    return world;
+  }
+
+  std::vector<BenchCase> makeCases() {
+    std::vector<BenchCase> cases;
+
+    cases.push_back({"npc_distance", [](size_t population) -> BenchBody {
+      auto swarm = std::make_shared<std::vector<std::unique_ptr<NPC>>>(
+          CreatureFactory::createRandomSwarm(static_cast<int>(population)));
+      return [swarm]() {
+        double total = 0;
+        const size_t count = swarm->size();
+        double seconds = timeIt([&]() {
+          for (size_t i = 0; i + 1 < count; ++i) {
+            total += (*swarm)[i]->distance(*(*swarm)[i + 1]);
+          }
+        });
+        benchSink = total;
+        return Sample{seconds, count - 1};
+      };
+    }});
+
+    cases.push_back({"npc_can_kill", [](size_t population) -> BenchBody {
+      auto swarm = std::make_shared<std::vector<std::unique_ptr<NPC>>>(
+          CreatureFactory::createRandomSwarm(static_cast<int>(population)));
+      return [swarm]() {
+        size_t kills = 0;
+        const size_t count = swarm->size();
+        double seconds = timeIt([&]() {
+          for (size_t i = 0; i + 1 < count; ++i) {
+            kills += (*swarm)[i]->canKill(*(*swarm)[i + 1]);
+          }
+        });
+        benchSink = static_cast<double>(kills);
+        return Sample{seconds, count - 1};
+      };
+    }});
+
+    cases.push_back({"detect_potential_combats", [](size_t population) -> BenchBody {
+      std::shared_ptr<DungeonMaster> world = makeWorld(population);
+      return [world, population]() {
+        double seconds = timeIt([&]() { world->detectPotentialCombats(); });
+        world->clearCombatQueue();
+        return Sample{seconds, population};
+      };
+    }});
+
+    cases.push_back({"resolve_combat_queue", [](size_t population) -> BenchBody {
+      return [population]() {
+        auto world = makeWorld(population);
+        world->detectPotentialCombats();
+        double seconds = timeIt([&]() { world->resolveCombatQueue(); });
+        return Sample{seconds, population};
+      };
+    }});
+
+    // Полный тик без разбиения и с разбиением на тайлы (мир создается вне замера)
+    for (size_t tiles : {size_t{0}, size_t{4}, size_t{8}}) {
+      cases.push_back({"world_tick_tiles_" + std::to_string(tiles), [tiles](size_t population) -> BenchBody {
+        return [tiles, population]() {
+          auto world = makeWorld(population);
+          world->setWorldTiles(tiles, tiles);
+          double seconds = timeIt([&]() {
+            world->processMovementPhase();
+            world->detectPotentialCombats();
+            world->resolveCombatQueue();
+          });
+          return Sample{seconds, population};
+        };
+      }});
+    }
+
+    cases.push_back({"npc_serialize", [](size_t population) -> BenchBody {
+      auto swarm = std::make_shared<std::vector<std::unique_ptr<NPC>>>(
+          CreatureFactory::createRandomSwarm(static_cast<int>(population)));
+      return [swarm]() {
+        size_t bytes = 0;
+        double seconds = timeIt([&]() {
+          for (const auto& creature : *swarm) {
+            bytes += creature->serialize().size();
+          }
+        });
+        benchSink = static_cast<double>(bytes);
+        return Sample{seconds, swarm->size()};
+      };
+    }});
+
+    cases.push_back({"npc_deserialize", [](size_t population) -> BenchBody {
+      auto lines = std::make_shared<std::vector<std::string>>();
+      for (const auto& creature : CreatureFactory::createRandomSwarm(static_cast<int>(population))) {
+        lines->push_back(creature->serialize());
+      }
+      return [lines]() {
+        double total = 0;
+        double seconds = timeIt([&]() {
+          for (const auto& line : *lines) {
+            total += NPC::deserialize(line)->getX();
+          }
+        });
+        benchSink = total;
+        return Sample{seconds, lines->size()};
+      };
+    }});
+
+    cases.push_back({"save_scenario", [](size_t population) -> BenchBody {
+      std::shared_ptr<DungeonMaster> world = makeWorld(population);
+      auto file = std::make_shared<TemporaryFile>("save");
+      return [world, file, population]() {
+        double seconds = timeIt([&]() { world->saveScenario(file->path); });
+        return Sample{seconds, population};
+      };
+    }});
+
+    cases.push_back({"load_scenario", [](size_t population) -> BenchBody {
+      auto file = std::make_shared<TemporaryFile>("load");
+      makeWorld(population)->saveScenario(file->path);
+      return [file]() {
+        DungeonMaster world(false);
+        double seconds = timeIt([&]() { world.loadScenario(file->path); });
+        return Sample{seconds, world.getCreatureCount()};
+      };
+    }});
+
+    cases.push_back({"save_snapshot", [](size_t population) -> BenchBody {
+      std::shared_ptr<DungeonMaster> world = makeWorld(population);
+      auto file = std::make_shared<TemporaryFile>("save_snapshot");
+      return [world, file, population]() {
+        double seconds = timeIt([&]() { world->saveScenario(file->path, BINARY_SNAPSHOT); });
+        return Sample{seconds, population};
+      };
+    }});
+
+    cases.push_back({"load_snapshot", [](size_t population) -> BenchBody {
+      auto file = std::make_shared<TemporaryFile>("load_snapshot");
+      makeWorld(population)->saveScenario(file->path, BINARY_SNAPSHOT);
+      return [file]() {
+        DungeonMaster world(false);
+        double seconds = timeIt([&]() { world.loadScenario(file->path); });
+        return Sample{seconds, world.getCreatureCount()};
+      };
+    }});
+
+    cases.push_back({"create_random_swarm", [](size_t population) -> BenchBody {
+      return [population]() {
+        size_t created = 0;
+        double seconds = timeIt([&]() {
+          created = CreatureFactory::createRandomSwarm(static_cast<int>(population)).size();
+        });
+        return Sample{seconds, created};
+      };
+    }});
+
+    cases.push_back({"create_random_swarm_arena", [](size_t population) -> BenchBody {
+      return [population]() {
+        size_t created = 0;
+        double seconds = timeIt([&]() {
+          CreatureArena arena(population);
+          CreatureFactory::createRandomSwarm(arena, static_cast<int>(population));
+          created = arena.size();
+        });
+        return Sample{seconds, created};
+      };
+    }});
+
+    cases.push_back({"event_bus_publish_flush", [](size_t population) -> BenchBody {
+      // Подписчик хочет только движение: бои отсекаются маской при публикации
+      struct MoveCounter : EventSubscriber {
+        size_t received = 0;
+        EventMask interests() const override { return eventBit(MOVE_EVENT); }
+        void deliver(const GameEvent*, size_t count) override { received += count; }
+      };
+      return [population]() {
+        EventBus bus;
+        MoveCounter counter;
+        bus.subscribe(&counter);
+        GameEvent event{};
+        double seconds = timeIt([&]() {
+          for (size_t i = 0; i < population; ++i) {
+            event.type = (i & 1) ? MOVE_EVENT : BATTLE_EVENT;
+            event.tick = i;
+            bus.publish(event);
+          }
+          bus.flush();
+        });
+        benchSink = static_cast<double>(counter.received);
+        return Sample{seconds, population};
+      };
+    }});
+
+    return cases;
+  }
+
+  BenchResult runCase(const BenchCase& benchCase, size_t population, double minTime) {
+    BenchBody body = benchCase.setup(population);
+    body(); // прогрев
+
+    size_t iterations = 0;
+    size_t items = 0;
+    double seconds = 0;
+    while (seconds < minTime || iterations == 0) {
+      Sample sample = body();
+      seconds += sample.seconds;
+      items += sample.items;
+      ++iterations;
+    }
+
+    BenchResult result;
+    result.name = benchCase.name;
+    result.population = population;
+    result.iterations = iterations;
+    result.nsPerOp = seconds * 1e9 / iterations;
+    result.itemsPerOp = static_cast<double>(items) / iterations;
+    return result;
+  }
+
+  std::vector<size_t> parseList(const std::string& text) {
+    std::vector<size_t> values;
+    std::stringstream ss(text);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+      if (!item.empty()) values.push_back(std::stoul(item));
+    }
+    return values;
+  }
+
+  BenchOptions parseOptions(int argc, char* argv[]) {
+    BenchOptions options;
+    for (int i = 1; i < argc; ++i) {
+      std::string arg = argv[i];
+      auto value = [&]() -> std::string {
+        if (i + 1 >= argc) {
+          throw std::invalid_argument("Не указано значение для " + arg);
+        }
+        return argv[++i];
+      };
+
+      if (arg == "--populations") options.populations = parseList(value());
+      else if (arg == "--min-time") options.minTime = std::stod(value());
+      else if (arg == "--out") options.output = value();
+      else if (arg == "--filter") options.filter = value();
+      else throw std::invalid_argument("Неизвестный параметр: " + arg);
+    }
+    return options;
+  }
+
+  void writeJson(std::ostream& out, const BenchOptions& options,
+                 const std::vector<BenchResult>& results) {
+    out << "{\n";
+    out << "  \"context\": {\n";
+    out << "    \"compiler\": \"" << __VERSION__ << "\",\n";
+    out << "    \"hardware_threads\": " << std::thread::hardware_concurrency() << ",\n";
+    out << "    \"min_time_s\": " << options.minTime << "\n";
+    out << "  },\n";
+    out << "  \"benchmarks\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+      const auto& result = results[i];
+      const double nsPerItem = result.itemsPerOp > 0 ? result.nsPerOp / result.itemsPerOp : 0;
+      out << "    {\"name\": \"" << result.name << "\""
+          << ", \"population\": " << result.population
+          << ", \"iterations\": " << result.iterations
+          << ", \"ns_per_op\": " << result.nsPerOp
+          << ", \"items_per_op\": " << result.itemsPerOp
+          << ", \"ns_per_item\": " << nsPerItem << "}"
+          << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n";
+    out << "}\n";
+  }
+}
+
+int main(int argc, char* argv[]) {
+  try {
+    BenchOptions options = parseOptions(argc, argv);
+    std::vector<BenchResult> results;
+
+    for (const auto& benchCase : makeCases()) {
+      if (!options.filter.empty() && benchCase.name.find(options.filter) == std::string::npos) {
+        continue;
+      }
+      for (size_t population : options.populations) {
+        results.push_back(runCase(benchCase, population, options.minTime));
+        const auto& result = results.back();
+        std::cerr << result.name << " [" << result.population << "]: "
+                  << result.nsPerOp / 1e6 << " мс/оп\n";
+      }
+    }
+
+    if (options.output.empty()) {
+      writeJson(std::cout, options, results);
+    } else {
+      std::ofstream out(options.output);
+      writeJson(out, options, results);
+    }
+  } catch (const std::exception& e) {
+    std::cerr << "Ошибка: " << e.what() << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,51 @@
+#include "../include/game/dungeon_master.hpp"
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <algorithm>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Масштабирование фазы движения по числу потоков.
+// Использование: movement_bench [существ] [тиков] [потоки...]
+
+int main(int argc, char* argv[]) {
+  int population = argc > 1 ? std::stoi(argv[1]) : 1000000;
+  int ticks = argc > 2 ? std::stoi(argv[2]) : 10;
+  std::vector<size_t> threadCounts;
+  for (int i = 3; i < argc; ++i) {
+    threadCounts.push_back(std::stoul(argv[i]));
+  }
+  if (threadCounts.empty()) {
+    const size_t cores = std::max(1u, std::thread::hardware_concurrency());
+    for (size_t threads = 1; threads <= cores; threads *= 2) {
+      threadCounts.push_back(threads);
+    }
+  }
+
+  DungeonMaster world(false);
+  world.initializeCreatures(population);
+
+  std::cout << "Существ: " << population << ", тиков: " << ticks << "\n";
+  double baseline = 0;
+  for (size_t threads : threadCounts) {
+    world.setWorkerThreads(threads);
+    world.processMovementPhase();
+
+    auto start = std::chrono::steady_clock::now();
+    for (int tick = 0; tick < ticks; ++tick) {
+      world.processMovementPhase();
+    }
+    auto finish = std::chrono::steady_clock::now();
+    double perTick = std::chrono::duration<double, std::milli>(finish - start).count() / ticks;
+    if (baseline == 0) baseline = perTick;
+
+    std::cout << std::fixed << std::setprecision(2)
+              << "потоков " << std::setw(3) << threads
+              << ": " << std::setw(9) << perTick << " мс/тик, ускорение "
+              << baseline / perTick << "x\n";
+  }
+
+  return 0;
+}
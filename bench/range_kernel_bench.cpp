@@ -0,0 +1,105 @@
+#include "../include/game/range_kernel.hpp"
+#include "../include/game/creature_store.hpp"
+#include "../include/game/random_stream.hpp"
+#include "../include/game/constants.hpp"
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <string>
+#include <vector>
+
+// Пропускная способность ядра проверки дальности: пар за наносекунду
+// для скалярной и AVX2-версии на блоках разного размера.
+// Использование: range_kernel_bench [проходов] [размер_блока...]
+
+namespace {
+  // Существа в квадрате 3x3 ячейки - так выглядит блок при поиске боев
+  CandidateBlock makeBlock(CreatureStore& store, size_t size) {
+    const double side = 3 * ArenaConfig::Combat::MAX_ATTACK_RANGE;
+    std::vector<size_t> ids;
+    for (size_t i = 0; i < size; ++i) {
+      RandomStream stream(2024, 0, i, RandomPurpose::PLACEMENT);
+      NPCType type = static_cast<NPCType>(stream.uniformInt(KNIGHT, DRAGON));
+      double range = type == KNIGHT ? ArenaConfig::Combat::KNIGHT_SWORD_REACH
+                   : type == ELF ? ArenaConfig::Combat::ELF_BOW_RANGE
+                   : ArenaConfig::Combat::DRAGON_BREATH_RANGE;
+      ids.push_back(store.add(type, stream.uniformReal(0, side), stream.uniformReal(0, side),
+                              "NPC", 0, range));
+    }
+    
+    CandidateBlock block;
+    block.pack(store, ids);
+    return block;
+  }
+  
+  // Все пары блока, как в detectPotentialCombats; возвращает число попаданий
+  size_t sweep(RangeKernel::BlockTest kernel, const CandidateBlock& block,
+               std::vector<uint8_t>& hits) {
+    size_t found = 0;
+    for (size_t h = 0; h < block.size(); ++h) {
+      kernel(RangeProbe::fromBlock(block, h), block, h + 1, block.size(), hits.data());
+      for (size_t k = h + 1; k < block.size(); ++k) {
+        found += hits[k] != 0;
+      }
+    }
+    return found;
+  }
+  
+  double pairsPerNanosecond(RangeKernel::BlockTest kernel, const CandidateBlock& block,
+                            int passes, size_t& found) {
+    std::vector<uint8_t> hits(block.size());
+    auto start = std::chrono::steady_clock::now();
+    for (int pass = 0; pass < passes; ++pass) {
+      found = sweep(kernel, block, hits);
+    }
+    auto finish = std::chrono::steady_clock::now();
+    
+    double nanoseconds = std::chrono::duration<double, std::nano>(finish - start).count();
+    double pairs = static_cast<double>(passes) * block.size() * (block.size() - 1) / 2;
+    return nanoseconds > 0 ? pairs / nanoseconds : 0.0;
+  }
+}
+
+int main(int argc, char* argv[]) {
+  int passes = 200;
+  std::vector<size_t> sizes = {16, 64, 256, 1024};
+  
+  if (argc > 1) passes = std::stoi(argv[1]);
+  if (argc > 2) {
+    sizes.clear();
+    for (int i = 2; i < argc; ++i) {
+      sizes.push_back(std::stoul(argv[i]));
+    }
+  }
+  
+  std::cout << "Выбранное ядро: " << RangeKernel::selectedName() << "\n\n";
+  std::cout << std::setw(8) << "block" << std::setw(14) << "scalar p/ns"
+            << std::setw(14) << "avx2 p/ns" << std::setw(10) << "x" << std::setw(10) << "hits" << "\n";
+  
+  bool consistent = true;
+  for (size_t size : sizes) {
+    CreatureStore store;
+    CandidateBlock block = makeBlock(store, size);
+    
+    size_t scalarFound = 0;
+    size_t avxFound = 0;
+    double scalar = pairsPerNanosecond(RangeKernel::testBlockScalar, block, passes, scalarFound);
+    double avx = RangeKernel::avx2Supported()
+               ? pairsPerNanosecond(RangeKernel::testBlockAvx2, block, passes, avxFound)
+               : 0.0;
+    if (RangeKernel::avx2Supported() && avxFound != scalarFound) {
+      consistent = false;
+    }
+    
+    std::cout << std::fixed << std::setprecision(3)
+              << std::setw(8) << size << std::setw(14) << scalar << std::setw(14) << avx
+              << std::setw(10) << (scalar > 0 && avx > 0 ? avx / scalar : 0.0)
+              << std::setw(10) << scalarFound << "\n";
+  }
+  
+  if (!consistent) {
+    std::cout << "ОШИБКА: результаты ядер расходятся\n";
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,85 @@
+#include "../include/game/replay.hpp"
+#include "../include/game/dungeon_master.hpp"
+#include "../include/game/tick_scheduler.hpp"
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <string>
+#include <cstdio>
+
+// Запись и повтор с внешними воздействиями: между тиками появляются и
+// сдвигаются существа, затем повтор идет от каждого опорного кадра до конца
+// и сверяется с записью. Код возврата 1 - повтор разошелся.
+// Использование: replay_bench [существ] [тиков] [интервал_кадров] [файл]
+
+int main(int argc, char* argv[]) {
+  int population = argc > 1 ? std::stoi(argv[1]) : 20000;
+  uint64_t ticks = argc > 2 ? std::stoull(argv[2]) : 200;
+  uint64_t interval = argc > 3 ? std::stoull(argv[3]) : 50;
+  std::string fileName = argc > 4 ? argv[4] : "replay_bench.rep";
+
+  using Clock = std::chrono::steady_clock;
+  const WorldBounds& world = arenaSettings().world;
+
+  double recordMs = 0;
+  Replay::Recorder::Stats recorded{};
+  {
+    DungeonMaster arena(false);
+    arena.setSeed(2024);
+    arena.initializeCreatures(population);
+    TickScheduler scheduler;
+    arena.registerTickPhases(scheduler);
+
+    auto start = Clock::now();
+    Replay::Recorder recorder(fileName, arena, interval);
+    for (uint64_t tick = 0; tick < ticks; ++tick) {
+      // Воздействия детерминированы по тику, чтобы их было видно в записи
+      const double x = world.minX + (world.maxX - world.minX) * static_cast<double>(tick % 97) / 97;
+      const double y = world.minY + (world.maxY - world.minY) * static_cast<double>(tick % 89) / 89;
+      arena.spawnCreature(static_cast<NPCType>(1 + tick % 3), x, y, "Гость_" + std::to_string(tick));
+      for (size_t k = 0; k < 4; ++k) {
+        arena.relocateCreature((tick * 131 + k * 7919) % static_cast<size_t>(population),
+                               static_cast<MoveDirection>((tick + k) % 4));
+      }
+      scheduler.runTick();
+      recorder.afterTick();
+    }
+    recorder.close();
+    recordMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    recorded = recorder.getStats();
+  }
+
+  std::cout << std::fixed << std::setprecision(2);
+  std::cout << "Существ: " << population << ", тиков: " << ticks << ", опорный кадр каждые "
+            << interval << "\n\n";
+  std::cout << "Запись, мс/тик:     " << recordMs / static_cast<double>(ticks) << "\n";
+  std::cout << "Воздействий:        " << recorded.inputs << ", опорных кадров " << recorded.keyframes
+            << ", " << recorded.bytes << " байт\n\n";
+
+  bool matched = true;
+  Replay::Player probe(fileName);
+  for (uint64_t target = probe.startTick(); target <= probe.endTick(); target += interval) {
+    DungeonMaster arena(false);
+    TickScheduler scheduler;
+    arena.registerTickPhases(scheduler);
+    Replay::Player player(fileName);
+
+    auto start = Clock::now();
+    const uint64_t restored = player.restore(arena, target);
+    const double seekMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    while (arena.getTick() < player.endTick()) {
+      player.applyInputs(arena);
+      scheduler.runTick();
+    }
+    const bool same = player.finish(arena);
+    const double totalMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    matched = matched && same;
+
+    std::cout << "С тика " << std::setw(5) << target << " (кадр " << restored << "): переход "
+              << seekMs << " мс, до конца " << totalMs << " мс, "
+              << (same ? "совпал" : "РАЗОШЕЛСЯ") << "\n";
+  }
+
+  std::remove(fileName.c_str());
+  return matched ? 0 : 1;
+}
@@ -0,0 +1,106 @@
+#include "../include/game/dungeon_master.hpp"
+#include "../include/game/constants.hpp"
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <string>
+#include <vector>
+
+// Сравнение полного перебора и пространственной сетки в detectPotentialCombats.
+// Использование: spatial_grid_bench [тиков] [предел_перебора] [популяция...]
+
+namespace {
+  struct DetectionSample {
+    double milliseconds = 0;
+    size_t pairTests = 0;
+  };
+
+  DetectionSample measureDetection(DungeonMaster& world, CombatDetection mode) {
+    world.setCombatDetection(mode);
+
+    auto start = std::chrono::steady_clock::now();
+    world.detectPotentialCombats();
+    auto finish = std::chrono::steady_clock::now();
+
+    DetectionSample sample;
+    sample.milliseconds = std::chrono::duration<double, std::milli>(finish - start).count();
+    sample.pairTests = world.getLastPairTests();
+    world.clearCombatQueue();
+    return sample;
+  }
+
+  // setw считает байты, а заголовки в UTF-8 - выравниваем по символам
+  std::string column(const std::string& text, size_t width) {
+    size_t symbols = 0;
+    for (unsigned char c : text) {
+      if ((c & 0xC0) != 0x80) ++symbols;
+    }
+    return std::string(width > symbols ? width - symbols : 0, ' ') + text;
+  }
+}
+
+int main(int argc, char* argv[]) {
+  int ticks = 5;
+  int bruteForceLimit = 20000;
+  std::vector<int> populations = {1000, 5000, 20000, 100000};
+
+  if (argc > 1) ticks = std::stoi(argv[1]);
+  if (argc > 2) bruteForceLimit = std::stoi(argv[2]);
+  if (argc > 3) {
+    populations.clear();
+    for (int i = 3; i < argc; ++i) {
+      populations.push_back(std::stoi(argv[i]));
+    }
+  }
+
+  // Ячейка зависит от дальностей в настройках - берем ее у мира
+  const double cellSize = DungeonMaster(false).getCombatCellSize();
+  std::cout << "Тиков на замер: " << ticks
+            << ", размер ячейки: " << cellSize << "\n\n";
+  std::cout << column("существ", 10)
+            << column("перебор, пар", 16)
+            << column("перебор, мс", 14)
+            << column("сетка, пар", 16)
+            << column("сетка, мс", 14)
+            << column("ускорение", 12) << "\n";
+
+  for (int population : populations) {
+    DungeonMaster world(false);
+    world.initializeCreatures(population);
+    const bool runBruteForce = population <= bruteForceLimit;
+
+    DetectionSample brute, grid;
+    for (int tick = 0; tick < ticks; ++tick) {
+      world.processMovementPhase();
+
+      auto gridTick = measureDetection(world, SPATIAL_GRID);
+      grid.milliseconds += gridTick.milliseconds;
+      grid.pairTests += gridTick.pairTests;
+
+      if (runBruteForce) {
+        auto bruteTick = measureDetection(world, BRUTE_FORCE);
+        brute.milliseconds += bruteTick.milliseconds;
+        brute.pairTests += bruteTick.pairTests;
+      }
+    }
+
+    std::cout << std::fixed << std::setprecision(2)
+              << std::setw(10) << population;
+    if (runBruteForce) {
+      std::cout << std::setw(16) << brute.pairTests / ticks
+                << std::setw(14) << brute.milliseconds / ticks;
+    } else {
+      std::cout << std::setw(16) << "-" << std::setw(14) << "-";
+    }
+    std::cout << std::setw(16) << grid.pairTests / ticks
+              << std::setw(14) << grid.milliseconds / ticks;
+    if (runBruteForce && grid.milliseconds > 0) {
+      std::cout << std::setw(11) << brute.milliseconds / grid.milliseconds << "x";
+    } else {
+      std::cout << std::setw(12) << "-";
+    }
+    std::cout << "\n";
+  }
+
+  return 0;
+}
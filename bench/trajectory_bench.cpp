@@ -0,0 +1,78 @@
+#include "../include/game/trajectory.hpp"
+#include "../include/game/creature_store.hpp"
+#include "../include/game/constants.hpp"
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <random>
+#include <string>
+#include <cstdio>
+
+// Запись траекторий: время capture() в потоке симуляции, полное время с
+// закрытием файла, размер записи и время перехода к последнему тику.
+// Использование: trajectory_bench [существ] [тиков] [файл]
+
+int main(int argc, char* argv[]) {
+  size_t population = argc > 1 ? std::stoul(argv[1]) : 1000000;
+  int ticks = argc > 2 ? std::stoi(argv[2]) : 64;
+  std::string fileName = argc > 3 ? argv[3] : "trajectory_bench.traj";
+
+  std::mt19937 gen(2024);
+  std::uniform_real_distribution<double> coord(ArenaConfig::WORLD_MIN_X, ArenaConfig::WORLD_MAX_X);
+  std::uniform_int_distribution<int> dirDist(0, 3);
+  std::uniform_int_distribution<size_t> victim(0, population - 1);
+
+  CreatureStore store;
+  store.reserve(population);
+  for (size_t i = 0; i < population; ++i) {
+    store.add(static_cast<NPCType>(1 + (i % 3)), coord(gen), coord(gen), "NPC",
+              ArenaConfig::Mobility::KNIGHT_STEP, ArenaConfig::Combat::KNIGHT_SWORD_REACH);
+  }
+
+  const Trajectory::WriterOptions options{ArenaConfig::Recording::TRAJECTORY_QUANTUM,
+                                          ArenaConfig::Recording::TRAJECTORY_CHUNK_TICKS,
+                                          ArenaConfig::Recording::TRAJECTORY_BUFFERED_TICKS};
+  double captureMs = 0;
+  auto start = std::chrono::steady_clock::now();
+  Trajectory::Writer writer(fileName, DEFAULT_WORLD_BOUNDS, 2024, options);
+  for (int tick = 0; tick < ticks; ++tick) {
+    // Движение и немного смертей, как в тике арены
+    for (size_t i = 0; i < store.size(); ++i) {
+      if (store.isAlive(i)) {
+        store.move(i, static_cast<MoveDirection>(dirDist(gen)), false);
+      }
+    }
+    for (size_t k = 0; k < population / 1000; ++k) {
+      store.setAlive(victim(gen), false);
+    }
+
+    auto before = std::chrono::steady_clock::now();
+    writer.capture(store, static_cast<uint64_t>(tick));
+    captureMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - before).count();
+  }
+  writer.close();
+  const double totalMs = std::chrono::duration<double, std::milli>(
+      std::chrono::steady_clock::now() - start).count();
+  const auto stats = writer.getStats();
+
+  Trajectory::Reader reader(fileName);
+  const uint64_t target = static_cast<uint64_t>(ticks - 1);
+  auto seekStart = std::chrono::steady_clock::now();
+  const Trajectory::Frame frame = reader.frame(target);
+  const double seekMs = std::chrono::duration<double, std::milli>(
+      std::chrono::steady_clock::now() - seekStart).count();
+
+  std::cout << std::fixed << std::setprecision(2);
+  std::cout << "Существ: " << population << ", тиков: " << ticks << "\n\n";
+  std::cout << "capture(), мс/тик:          " << captureMs / ticks << "\n";
+  std::cout << "С кодированием и записью:   " << totalMs / ticks << " мс/тик, ожиданий "
+            << stats.stalls << "\n";
+  std::cout << "Байт на существо-тик:       "
+            << static_cast<double>(stats.bytes) / (static_cast<double>(population) * ticks)
+            << " (без сжатия " << 2 * sizeof(double) + 1 << ", "
+            << static_cast<double>(stats.rawBytes) / stats.bytes << "x)\n";
+  std::cout << "Переход к тику " << frame.tick << ", мс:     " << seekMs << "\n";
+
+  std::remove(fileName.c_str());
+  return 0;
+}
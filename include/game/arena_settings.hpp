@@ -0,0 +1,76 @@
+#ifndef ARENA_SETTINGS_HPP
+#define ARENA_SETTINGS_HPP
+
+#include <array>
+#include <string>
+#include <cstddef>
+#include "../npc/npc.hpp"
+#include "./constants.hpp"
+
+// Прямоугольник мира
+struct WorldBounds {
+  double minX;
+  double maxX;
+  double minY;
+  double maxY;
+
+  bool contains(double x, double y) const {
+    return x >= minX && x <= maxX && y >= minY && y <= maxY;
+  }
+  bool operator==(const WorldBounds& other) const {
+    return minX == other.minX && maxX == other.maxX &&
+           minY == other.minY && maxY == other.maxY;
+  }
+};
+
+// Мир по умолчанию; для него в горячих циклах есть пути с границами
+// времени компиляции
+struct DefaultWorld {
+  static constexpr double minX = ArenaConfig::WORLD_MIN_X;
+  static constexpr double maxX = ArenaConfig::WORLD_MAX_X;
+  static constexpr double minY = ArenaConfig::WORLD_MIN_Y;
+  static constexpr double maxY = ArenaConfig::WORLD_MAX_Y;
+};
+constexpr WorldBounds DEFAULT_WORLD_BOUNDS{DefaultWorld::minX, DefaultWorld::maxX,
+                                           DefaultWorld::minY, DefaultWorld::maxY};
+
+// Параметры запуска: по умолчанию - константы ArenaConfig, поверх них
+// файл настроек ("ключ = значение", # - комментарий) и командная строка.
+// Ключи: world.min_x, world.max_x, world.min_y, world.max_y, population,
+// <тип>.step и <тип>.range (knight, elf, dragon), timing.tick_interval,
+// timing.display_interval, timing.session_duration, timing.log_flush_interval
+// (мс), threads (0 - по числу ядер), tiles (N x N, 0 - без тайлов)
+struct ArenaSettings {
+  WorldBounds world = DEFAULT_WORLD_BOUNDS;
+  int population = ArenaConfig::INITIAL_POPULATION;
+  std::array<double, NPC_TYPE_COUNT> step{};
+  std::array<double, NPC_TYPE_COUNT> range{};
+
+  int tickInterval = ArenaConfig::Timing::TICK_INTERVAL;
+  int displayInterval = ArenaConfig::Timing::DISPLAY_INTERVAL;
+  int sessionDuration = ArenaConfig::Timing::DEFAULT_SESSION_DURATION;
+  int logFlushInterval = ArenaConfig::Timing::LOG_FLUSH_INTERVAL;
+
+  size_t threads = 0;
+  size_t tiles = ArenaConfig::Sharding::TILE_COLUMNS;
+
+  ArenaSettings();
+
+  void set(const std::string& key, const std::string& value);
+  // "ключ=значение" из командной строки
+  void set(const std::string& assignment);
+  void loadFile(const std::string& fileName);
+  // Бросает invalid_argument при несогласованных значениях
+  void validate() const;
+
+  // Ячейка сетки боев не меньше наибольшей дальности
+  double maxAttackRange() const;
+  bool defaultWorld() const { return world == DEFAULT_WORLD_BOUNDS; }
+};
+
+// Настройки процесса. Меняются до создания мира: хранилища и сетки
+// копируют их при создании, процессы-шарды наследуют при запуске
+const ArenaSettings& arenaSettings();
+void applyArenaSettings(const ArenaSettings& settings);
+
+#endif
@@ -0,0 +1,66 @@
+#ifndef ARENA_SHARD_HPP
+#define ARENA_SHARD_HPP
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "./creature_store.hpp"
+#include "./spatial_grid.hpp"
+#include "./combat_components.hpp"
+#include "./shard_channel.hpp"
+
+// Разбиение строк сетки боев на полосы шардов: у шарда k строки
+// [rowBegin[k], rowBegin[k + 1]) во всю ширину мира
+struct ShardLayout {
+  std::vector<int> rowBegin;
+  std::vector<uint32_t> shardOfRow;
+  int columns = 0;
+
+  ShardLayout(const SpatialGrid& grid, size_t shards);
+  size_t shards() const { return rowBegin.size() - 1; }
+  uint32_t shardOfCell(int cell) const { return shardOfRow[cell / columns]; }
+};
+
+// Шард распределенной арены: живет в отдельном процессе и по командам
+// координатора ведет существ своей полосы. Индексы существ общие для всех
+// процессов (от них зависят потоки случайности), поэтому столбцы хранилища
+// полноразмерные, но в сетке только свои живые существа и ореол - первая
+// строка шарда ниже (соседи вперед из последней своей строки).
+// Пограничные бои и все связанные с ними решает координатор.
+class ArenaShard {
+  private:
+    ShardLayout layout_;
+    size_t index_;
+    int rowBegin_;
+    int rowEnd_;
+    uint64_t seed_;
+    uint64_t tick_;
+
+    CreatureStore creatures_;
+    SpatialGrid grid_;
+    std::vector<uint8_t> owned_;   // и погибшие здесь существа
+    std::vector<size_t> halo_;
+
+    std::vector<size_t> residents_;
+    std::vector<CombatPair> pairs_;
+    std::vector<CombatPair> crossPairs_;
+    CombatComponents components_;
+
+    ShardCreature record(size_t id) const;
+    void acceptRecord(const ShardCreature& creature);
+
+    void moveResidents(MessageBuffer& request, MessageBuffer& reply);
+    void acceptImmigrants(MessageBuffer& request, MessageBuffer& reply);
+    void detectCombats(MessageBuffer& request, MessageBuffer& reply);
+    void resolveCombats(MessageBuffer& request, MessageBuffer& reply);
+    void applyDeaths(MessageBuffer& request, MessageBuffer& reply);
+    void collect(MessageBuffer& reply) const;
+
+  public:
+    ArenaShard(const CreatureStore& world, uint64_t seed, uint64_t tick, size_t shards, size_t index);
+
+    // Обслуживает команды координатора до SHARD_STOP
+    void serve(ShardChannel& channel);
+};
+
+#endif
@@ -0,0 +1,65 @@
+#ifndef COMBAT_COMPONENTS_HPP
+#define COMBAT_COMPONENTS_HPP
+
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+#include "./combat_queue.hpp"
+
+// Порядок последовательного разрешения боев: по паре (меньший, больший)
+struct CombatPairOrder {
+  bool operator()(const CombatPair& lhs, const CombatPair& rhs) const {
+    return std::minmax(lhs.first, lhs.second) < std::minmax(rhs.first, rhs.second);
+  }
+};
+
+// Склейка упорядоченных списков попарными слияниями: O(n log списков)
+template <typename Item, typename Order>
+void mergeSorted(const std::vector<const std::vector<Item>*>& lists, std::vector<Item>& merged,
+                 Order order) {
+  merged.clear();
+  std::vector<size_t> bounds{0};
+  for (const auto& list : lists) {
+    merged.insert(merged.end(), list->begin(), list->end());
+    bounds.push_back(merged.size());
+  }
+
+  while (bounds.size() > 2) {
+    std::vector<size_t> next{0};
+    for (size_t k = 2; k < bounds.size(); k += 2) {
+      std::inplace_merge(merged.begin() + bounds[k - 2], merged.begin() + bounds[k - 1],
+                         merged.begin() + bounds[k], order);
+      next.push_back(bounds[k]);
+    }
+    if (bounds.size() % 2 == 0) {
+      next.push_back(bounds.back());
+    }
+    bounds.swap(next);
+  }
+}
+
+// Компоненты связности боев по общим участникам. Если в компоненте есть
+// пограничное существо (его бои разрешает кто-то другой), откладываются все
+// ее бои - тогда порядок боев каждого существа совпадает с общим порядком пар.
+// Записи по существам: части мира с непересекающимися существами (тайлы)
+// могут работать с одним объектом параллельно
+class CombatComponents {
+  private:
+    std::vector<uint8_t> border_;
+    std::vector<uint32_t> parent_;
+
+    uint32_t find(uint32_t id);
+
+  public:
+    // Все существа не пограничные; вызывается до параллельной работы
+    void reset(size_t creatures);
+    void markBorder(size_t id) { border_[id] = 1; }
+
+    // Объединяет участников пар и распространяет метки на компоненты
+    void build(const std::vector<CombatPair>& pairs);
+    // После build: бой нужно отложить
+    bool deferred(const CombatPair& pair) { return border_[find(static_cast<uint32_t>(pair.first))] != 0; }
+};
+
+#endif
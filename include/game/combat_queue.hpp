@@ -0,0 +1,61 @@
+#ifndef COMBAT_QUEUE_HPP
+#define COMBAT_QUEUE_HPP
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <utility>
+#include <cstddef>
+#include "./lock_free_ring.hpp"
+
+using CombatPair = std::pair<size_t, size_t>;
+
+// Очередь кандидатов в бой: детекторы добавляют пары без блокировок,
+// боевая фаза забирает их параллельно. При переполнении кольца пары
+// уходят в резервный список под мьютексом, порядок одного производителя
+// при этом сохраняется.
+class CombatQueue {
+  public:
+    struct Stats {
+      size_t capacity;
+      size_t occupancy;
+      size_t highWaterMark;
+      size_t pushed;
+      size_t overflowed;
+    };
+    
+  private:
+    LockFreeRing<CombatPair> ring_;
+    
+    // Медленный путь при переполнении
+    std::mutex spillMutex_;
+    std::vector<CombatPair> spill_;
+    size_t spillHead_ = 0;
+    std::atomic<bool> spilling_{false};
+    std::atomic<size_t> spillPending_{0};
+    
+    std::atomic<size_t> highWaterMark_{0};
+    std::atomic<size_t> pushed_{0};
+    std::atomic<size_t> overflowed_{0};
+    
+    void updateHighWaterMark();
+    
+  public:
+    explicit CombatQueue(size_t capacity);
+    
+    CombatQueue(const CombatQueue&) = delete;
+    CombatQueue& operator=(const CombatQueue&) = delete;
+    
+    void push(const CombatPair& combat);
+    bool tryPop(CombatPair& combat);
+    void clear();
+    
+    size_t capacity() const { return ring_.capacity(); }
+    size_t size() const;
+    bool empty() const { return size() == 0; }
+    
+    Stats getStats() const;
+    void resetStats();
+};
+
+#endif
@@ -2,11 +2,11 @@
 #define COMBAT_VISITOR_HPP
 
 #include "../npc/npc.hpp"
-#include "./observer.hpp"
+#include "./creature_store.hpp"
+#include "./event_bus.hpp"
+#include "./random_stream.hpp"
 #include <vector>
 #include <memory>
-#include <random>
-#include <mutex>
 
 enum BattleOutcome {
   ATTACKER_VICTORY,
@@ -17,19 +17,30 @@ enum BattleOutcome {
 
 class CombatMediator {
   private:
-    const std::vector<std::unique_ptr<NPC>>& combatants_;
-    const std::vector<Observer*>& monitors_;
-    mutable std::mutex combatLogMutex_;
+    const CreatureStore& combatants_;
+    EventBus* events_;
+    uint64_t seed_;
+    uint64_t tick_;
     
     void logBattleResult(NPC& victor, NPC& defeated) const;
     void logMovement(NPC& creature, MoveDirection path) const;
-    void rollDice(std::mt19937& generator, int& attackerRoll, int& defenderRoll) const;
+    void rollDice(RandomStream& stream, int& attackerRoll, int& defenderRoll) const;
+    RandomStream combatStream(const NPC& attacker, const NPC& defender) const;
     
   public:
-    CombatMediator(const std::vector<std::unique_ptr<NPC>>& participants, 
-                   const std::vector<Observer*>& watchers);
+    // События боев и движения публикуются в шину (nullptr - без событий).
+    // Броски кубиков определяются зерном, тиком и парой участников
+    CombatMediator(const CreatureStore& participants, EventBus* events,
+                   uint64_t seed, uint64_t tick);
     
     BattleOutcome engage(NPC& attacker, NPC& defender);
+    
+    // engage в два шага: decide только бросает кубики и ничего не меняет
+    // (живость участников проверяет вызывающий), settle применяет исход
+    BattleOutcome decide(const NPC& attacker, const NPC& defender) const;
+    void settle(NPC& attacker, NPC& defender, BattleOutcome outcome);
+    // Только события уже примененного исхода (смерти выставлены раньше)
+    void report(NPC& attacker, NPC& defender, BattleOutcome outcome) const;
     void relocate(NPC& creature, MoveDirection direction);
     
     // Симуляция расширенного боя
@@ -2,7 +2,12 @@
 #define CONSTANTS_HPP
 
 #include <string>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
 
+// Значения по умолчанию: мир, численность, шаги, дальности, тайминги
+// и потоки переопределяются при запуске (ArenaSettings)
 namespace ArenaConfig {
     // Размеры мира
     constexpr double WORLD_MIN_X = 0.0;
@@ -25,21 +30,59 @@ namespace ArenaConfig {
         constexpr double KNIGHT_SWORD_REACH = 10.0;
         constexpr double ELF_BOW_RANGE = 50.0;
         constexpr double DRAGON_BREATH_RANGE = 30.0;
+        constexpr double MAX_ATTACK_RANGE = std::max({KNIGHT_SWORD_REACH,
+                                                      ELF_BOW_RANGE,
+                                                      DRAGON_BREATH_RANGE});
         constexpr int ATTACK_DICE_SIDES = 6;
         constexpr int DEFENSE_DICE_SIDES = 6;
+        constexpr size_t QUEUE_CAPACITY = 16384;
+        // Меньше боев в пачке - разрешаем ее в вызывающем потоке
+        constexpr size_t PARALLEL_BATCH_MIN = 256;
+        // Наименьший кусок подсчета статистики для пула
+        constexpr size_t STATS_GRAIN = 16384;
+    }
+    
+    // Разбиение мира на тайлы по ячейкам сетки боев (0 - без разбиения)
+    namespace Sharding {
+        constexpr size_t TILE_COLUMNS = 4;
+        constexpr size_t TILE_ROWS = 4;
+        // Предел ячеек сетки боев (2048 x 2048, около 100 МБ корзин):
+        // большой мир при малой дальности отвергается, а не съедает память
+        constexpr size_t MAX_GRID_CELLS = size_t{1} << 22;
     }
     
     // Тайминги (в миллисекундах)
     namespace Timing {
-        constexpr int MOVEMENT_INTERVAL = 300;
-        constexpr int COMBAT_INTERVAL = 50;
+        constexpr int TICK_INTERVAL = 300;
         constexpr int DISPLAY_INTERVAL = 1000;
         constexpr int DEFAULT_SESSION_DURATION = 30000; // 30 секунд
+        constexpr int LOG_FLUSH_INTERVAL = 250;
+    }
+    
+    // Трасса: событий на поток (около 40 байт на событие)
+    namespace Tracing {
+        constexpr size_t EVENTS_PER_THREAD = 1 << 16;
+    }
+    
+    // Запись траекторий
+    namespace Recording {
+        constexpr double TRAJECTORY_QUANTUM = 0.01;
+        constexpr size_t TRAJECTORY_CHUNK_TICKS = 64;
+        constexpr size_t TRAJECTORY_BUFFERED_TICKS = 4;
+        // Опорные кадры повтора: чаще - быстрее переход, больше файл
+        constexpr uint64_t REPLAY_KEYFRAME_TICKS = 100;
+    }
+    
+    // Асинхронная запись журналов
+    namespace Logging {
+        constexpr size_t ASYNC_QUEUE_CAPACITY = 16384;
+        constexpr size_t BATCH_BYTES = 64 * 1024;
     }
     
     // Файлы
     namespace Files {
         const std::string DEFAULT_SAVE_FILE = "arena_state.txt";
+        const std::string SNAPSHOT_EXTENSION = ".snap";
         const std::string COMBAT_LOG_FILE = "combat_log.txt";
         const std::string MOVEMENT_LOG_FILE = "movement_log.txt";
         const std::string EVENT_LOG_FILE = "game_events.txt";
@@ -0,0 +1,56 @@
+#ifndef CREATURE_ARENA_HPP
+#define CREATURE_ARENA_HPP
+
+#include <vector>
+#include <memory>
+#include <new>
+#include <cstddef>
+#include "../npc/npc.hpp"
+#include "./creature_store.hpp"
+
+// Арена для массового создания существ: строки лежат в одном общем
+// хранилище, объекты NPC - в больших кусках памяти. Объекты арены не
+// владеют хранилищем и не освобождаются по одному, поэтому арена
+// освобождается целиком за число кусков. Арена не потокобезопасна.
+class CreatureArena {
+  private:
+    static constexpr size_t OBJECTS_PER_CHUNK = 4096;
+    
+    std::shared_ptr<CreatureStore> store_;
+    std::vector<std::unique_ptr<unsigned char[]>> chunks_;
+    size_t used_ = OBJECTS_PER_CHUNK;
+    std::vector<NPC*> creatures_;
+    
+    void* allocateObject();
+    
+  public:
+    explicit CreatureArena(size_t expected = 0);
+    
+    CreatureArena(const CreatureArena&) = delete;
+    CreatureArena& operator=(const CreatureArena&) = delete;
+    
+    // Создает объект Creature поверх строки slot общего хранилища
+    template <typename Creature>
+    Creature& emplace(size_t slot);
+    
+    CreatureStore& store() { return *store_; }
+    size_t size() const { return creatures_.size(); }
+    NPC& operator[](size_t index) const { return *creatures_[index]; }
+    size_t chunkCount() const { return chunks_.size(); }
+    
+    // Сбрасывает все существа разом
+    void release();
+};
+
+template <typename Creature>
+Creature& CreatureArena::emplace(size_t slot) {
+  static_assert(sizeof(Creature) == sizeof(NPC), "Существа арены не добавляют полей к NPC");
+  
+  // Псевдоним без счетчика ссылок: хранилищем владеет арена
+  std::shared_ptr<CreatureStore> view(std::shared_ptr<CreatureStore>(), store_.get());
+  Creature* creature = ::new (allocateObject()) Creature(view, slot);
+  creatures_.push_back(creature);
+  return *creature;
+}
+
+#endif
@@ -0,0 +1,22 @@
+#ifndef CREATURE_POOL_HPP
+#define CREATURE_POOL_HPP
+
+#include <cstddef>
+
+// Пул памяти под объекты NPC (через NPC::operator new/delete): память
+// берется кусками по SLOTS_PER_CHUNK слотов, у каждого потока свои
+// список свободных слотов и текущий кусок, мьютекс нужен только при
+// выделении нового куска. Куски живут до конца программы.
+class CreaturePool {
+  public:
+    static constexpr size_t SLOT_SIZE = 64;
+    static constexpr size_t SLOTS_PER_CHUNK = 4096;
+    
+    // Блоки больше SLOT_SIZE уходят в обычный operator new
+    static void* allocate(size_t size);
+    static void deallocate(void* pointer, size_t size);
+    
+    static size_t chunkCount();
+};
+
+#endif
@@ -0,0 +1,141 @@
+#ifndef CREATURE_STORE_HPP
+#define CREATURE_STORE_HPP
+
+#include <vector>
+#include <array>
+#include <string>
+#include <string_view>
+#include <cstdint>
+#include <cstddef>
+#include "../npc/npc.hpp"
+#include "./name_table.hpp"
+#include "./arena_settings.hpp"
+
+class SpatialGrid;
+
+// Итог проверки пары: кто из двух может напасть на другого
+enum PairVerdict : uint8_t {
+  NO_KILL,
+  FIRST_KILLS,
+  SECOND_KILLS
+};
+
+// Хранилище существ в виде структуры массивов (SoA): горячие поля лежат
+// в отдельных плотных массивах, холодные (имена) - отдельно.
+// Синхронизация лежит на владельце (DungeonMaster::creatureMutex_).
+class CreatureStore {
+  private:
+    std::vector<double> x_;
+    std::vector<double> y_;
+    std::vector<uint8_t> type_;
+    std::vector<uint8_t> alive_;
+    std::vector<float> moveDistance_;
+    std::vector<float> attackRange_;
+    
+    // Холодные данные: id имен в глобальной NameTable
+    std::vector<NameId> names_;
+    
+    SpatialGrid* grid_ = nullptr;
+    
+    // Границы мира берутся из настроек при создании хранилища
+    WorldBounds bounds_ = arenaSettings().world;
+    bool defaultWorld_ = bounds_ == DEFAULT_WORLD_BOUNDS;
+    
+    using PairKernel = PairVerdict (CreatureStore::*)(size_t, size_t) const;
+    static const std::array<PairKernel, NPC_TYPE_COUNT * NPC_TYPE_COUNT> PAIR_KERNELS;
+    
+  public:
+    size_t add(NPCType type, double x, double y, NameId name,
+               double moveDistance, double attackRange, bool alive = true);
+    size_t add(NPCType type, double x, double y, std::string_view name,
+               double moveDistance, double attackRange, bool alive = true) {
+      return add(type, x, y, internName(name), moveDistance, attackRange, alive);
+    }
+    size_t add(const NPC& creature);
+    void reserve(size_t count);
+    void clear();
+    // Копия столбцов без пространственного индекса (кадры мира)
+    void copyFrom(const CreatureStore& other);
+    size_t size() const { return x_.size(); }
+    const WorldBounds& bounds() const { return bounds_; }
+    bool empty() const { return x_.empty(); }
+    
+    NPCType type(size_t id) const { return static_cast<NPCType>(type_[id]); }
+    double x(size_t id) const { return x_[id]; }
+    double y(size_t id) const { return y_[id]; }
+    bool isAlive(size_t id) const { return alive_[id] != 0; }
+    double moveDistance(size_t id) const { return moveDistance_[id]; }
+    double attackRange(size_t id) const { return attackRange_[id]; }
+    NameId nameId(size_t id) const { return names_[id]; }
+    std::string_view name(size_t id) const { return nameText(names_[id]); }
+    
+    void setType(size_t id, NPCType type) { type_[id] = static_cast<uint8_t>(type); }
+    void setName(size_t id, std::string_view name) { names_[id] = internName(name); }
+    // reindex = false откладывает обновление сетки (параллельное движение)
+    void setPosition(size_t id, double x, double y, bool reindex = true);
+    void setAlive(size_t id, bool alive);
+    void move(size_t id, MoveDirection direction, bool reindex = true);
+    
+    double distance(size_t first, size_t second) const;
+    double squaredDistance(size_t first, size_t second) const;
+    bool canKill(size_t attacker, size_t defender) const;
+    
+    // Ядро проверки пары для известных при компиляции типов: сравнивает
+    // квадраты расстояний, лишние ветки убираются по матрице охоты
+    template <NPCType First, NPCType Second>
+    PairVerdict testPair(size_t first, size_t second) const;
+    
+    // Выбор ядра по типам; пары, которые не могут сражаться, отсекаются
+    // без расчета расстояния. Первым проверяется нападение first на second
+    PairVerdict testPair(size_t first, size_t second) const {
+      const NPCType firstType = type(first);
+      const NPCType secondType = type(second);
+      if (!canInteract(firstType, secondType)) {
+        return NO_KILL;
+      }
+      return (this->*PAIR_KERNELS[firstType * NPC_TYPE_COUNT + secondType])(first, second);
+    }
+    
+    // Пространственный индекс обновляется при движении и смерти
+    void attachGrid(SpatialGrid* grid);
+    
+    // Плотные массивы для горячих циклов
+    const double* xData() const { return x_.data(); }
+    const double* yData() const { return y_.data(); }
+    const uint8_t* typeData() const { return type_.data(); }
+    const uint8_t* aliveData() const { return alive_.data(); }
+    
+    static constexpr size_t hotBytesPerCreature() {
+      return 2 * sizeof(double) + 2 * sizeof(uint8_t) + 2 * sizeof(float);
+    }
+};
+
+template <NPCType First, NPCType Second>
+PairVerdict CreatureStore::testPair(size_t first, size_t second) const {
+  if constexpr (!canInteract(First, Second)) {
+    return NO_KILL;
+  } else {
+    if (!alive_[first] || !alive_[second]) {
+      return NO_KILL;
+    }
+    
+    const double squared = squaredDistance(first, second);
+    if constexpr (canPrey(First, Second)) {
+      const double range = attackRange_[first];
+      if (squared <= range * range) return FIRST_KILLS;
+    }
+    if constexpr (canPrey(Second, First)) {
+      const double range = attackRange_[second];
+      if (squared <= range * range) return SECOND_KILLS;
+    }
+    return NO_KILL;
+  }
+}
+
+inline double CreatureStore::squaredDistance(size_t first, size_t second) const {
+  const double distanceX = x_[first] - x_[second];
+  const double distanceY = y_[first] - y_[second];
+  return distanceX * distanceX + distanceY * distanceY;
+}
+
+#endif
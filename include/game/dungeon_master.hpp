@@ -2,29 +2,187 @@
 #define DUNGEON_MASTER_HPP
 
 #include <vector>
+#include <array>
 #include <memory>
-#include <queue>
-#include <random>
+#include <atomic>
 #include <shared_mutex>
+#include <mutex>
 #include "../npc/npc.hpp"
 #include "./factory.hpp"
 #include "./observer.hpp"
 #include "./combat_visitor.hpp"
+#include "./creature_store.hpp"
+#include "./spatial_grid.hpp"
+#include "./worker_pool.hpp"
+#include "./random_stream.hpp"
+#include "./combat_queue.hpp"
+#include "./event_bus.hpp"
+#include "./triple_buffer.hpp"
+#include "./tick_scheduler.hpp"
+#include "./tile_map.hpp"
+#include "./metrics.hpp"
+#include "./snapshot.hpp"
+
+enum CombatDetection {
+  BRUTE_FORCE,
+  SPATIAL_GRID
+};
+
+// Операции мира с замером длительности (enableMetrics)
+enum WorldPhase {
+  PHASE_MOVE,
+  PHASE_INDEX,
+  PHASE_DETECT,
+  PHASE_RESOLVE,
+  PHASE_STATS,
+  PHASE_FRAME,
+  PHASE_EVENTS,
+  PHASE_RENDER,
+  PHASE_SAVE,
+  PHASE_LOAD,
+  WORLD_PHASE_COUNT
+};
+
+// Внешние воздействия на мир между тиками (запись повторов). Вызывается
+// под блокировкой мира в порядке применения; tick - тик мира на момент
+// воздействия
+class WorldInputListener {
+  public:
+    virtual ~WorldInputListener() = default;
+
+    virtual void onSpawn(uint64_t tick, NPCType type, double x, double y, const std::string& name) = 0;
+    virtual void onRelocate(uint64_t tick, size_t index, MoveDirection direction) = 0;
+};
+
+// Формат файла сценария
+enum ScenarioFormat {
+  TEXT_SCENARIO,
+  BINARY_SNAPSHOT
+};
 
 class DungeonMaster {
+  public:
+    // Статистика
+    struct GameStats {
+        int totalCreatures;
+        int aliveCreatures;
+        int knights;
+        int elves;
+        int dragons;
+    };
+    
+    // Состояние существа, посчитанное вне мира (процессы-шарды)
+    struct CreatureState {
+      size_t index;
+      double x;
+      double y;
+      bool alive;
+    };
+    
+    // Неизменяемый кадр мира на границе тика: копия существ и счетчики
+    struct WorldFrame {
+      CreatureStore creatures;
+      GameStats stats{0, 0, 0, 0, 0};
+      uint64_t seed = 0;
+      uint64_t tick = 0;
+      uint64_t version = 0;
+    };
+    
   private:
-    std::vector<std::unique_ptr<NPC>> creatures_;
+    CreatureStore creatures_;
     std::vector<Observer*> watchers_;
-    std::queue<std::pair<size_t, size_t>> combatQueue_;
-    mutable std::shared_mutex creatureMutex_;
-    std::mutex queueMutex_;
+    // События копятся в буферах потоков и раздаются в конце тика
+    mutable EventBus events_;
+    std::unique_ptr<CombatQueue> combatQueue_;
+    // Ожидание захвата замеряется, если включены метрики
+    mutable TimedSharedMutex creatureMutex_;
+    
+    // Поиск боев
+    SpatialGrid grid_;
+    CombatDetection detectionMode_ = SPATIAL_GRID;
+    std::atomic<size_t> lastPairTests_{0};
+    
+    // Разрешение боев пачками без общих участников
+    std::vector<CombatPair> pendingCombats_;
+    // Буферы пачек живут между тиками; batchFrontier_ всегда нулевой
+    // вне resolveCombatBatches, поэтому сбрасываются только задетые элементы
+    std::vector<uint32_t> batchFrontier_;
+    std::vector<uint32_t> batchOf_;
+    std::vector<size_t> batchStart_;
+    std::vector<size_t> batchOrder_;
+    std::vector<size_t> batchFill_;
+    std::vector<uint8_t> batchAlive_;
+    std::vector<BattleOutcome> batchOutcomes_;
+    size_t lastCombatBatches_ = 0;
+    size_t lastBattles_ = 0;
+    GameStats tickStats_{0, 0, 0, 0, 0};
+    
+    // Параллельные фазы
+    std::shared_ptr<WorkerPool> workers_;
+    std::vector<std::vector<size_t>> cellChanges_;
+    
+    // Тайлы: движение, поиск и бои без блокировок внутри фазы
+    TileMap tiles_;
+    std::vector<TileMap::Battle> tileBattles_;
+    bool tilePairsReady_ = false;
+    
+    // Кадры для читателей: писатель публикует под creatureMutex_,
+    // читатели разбирают кадры между собой и писателя не ждут.
+    // Внешние воздействия кадр не копируют, а только помечают устаревшим:
+    // его опубликует конец тика или первый читатель (publishStaleFrame)
+    mutable TripleBuffer<WorldFrame> frames_;
+    mutable std::mutex frameReaderMutex_;
+    mutable uint64_t frameVersion_ = 0;
+    mutable std::atomic<bool> frameStale_{false};
+    
+    // Метрики: без enableMetrics указатели пустые и замеры не делаются
+    struct WorldMetrics {
+      std::array<LatencyHistogram*, WORLD_PHASE_COUNT> phases{};
+      MetricGauge* queueDepth = nullptr;
+      MetricGauge* aliveCreatures = nullptr;
+      MetricCounter* events = nullptr;
+      MetricCounter* battles = nullptr;
+      MetricCounter* ticks = nullptr;
+    };
+    WorldMetrics metrics_;
+    WorldInputListener* inputListener_ = nullptr;
+    
+    // Детерминированная случайность: потоки задаются (зерно, тик, id, назначение)
+    uint64_t seed_;
+    uint64_t tick_ = 0;
     
     // Вспомогательные методы
     bool validateCoordinates(double x, double y) const;
-    void broadcastEvent(const std::string& event) const;
+    void checkAttackRange(double range) const;
+    void publishNotice(uint64_t tick, NoticeKind kind, uint64_t count,
+                       const std::string& text = "") const;
+    void publishFrame() const;
+    void publishFrame(const GameStats& stats) const;
+    // Под frameReaderMutex_: читатели публикуют по очереди
+    void publishStaleFrame() const;
+    size_t placeCreature(NPCType type, double x, double y, const std::string& name);
+    void loadScenarioLocked(const std::string& fileName);
+    void loadSnapshotLocked(const Snapshot::View& snapshot, const std::string& source);
+    void saveFrame(const WorldFrame& frame, const std::string& fileName, ScenarioFormat format) const;
+    NPC viewCreature(size_t index) const;
+    static NPC viewCreature(const CreatureStore& store, size_t index);
+    void testCombatPair(size_t first, size_t second) const;
+    size_t resolveCombatBatches(CombatMediator& mediator, size_t& battles);
+    void resolveTileCombats();
+    // Поиск боев в тайлах пишет их списки пар и tilePairsReady_
+    bool detectsInTiles() const { return tiles_.enabled() && detectionMode_ == SPATIAL_GRID; }
+    // Сетка и перебор: только читают мир, вызываются под shared_lock
+    void detectCombatsShared();
+    
+    // Фазы тика; вызываются под unique_lock
+    void moveCreaturesLocked();
+    void updateSpatialIndexLocked();
+    void resolveCombatsLocked();
+    void collectTickStatsLocked();
     
   public:
     DungeonMaster();
+    explicit DungeonMaster(bool withDefaultWatchers);
     ~DungeonMaster();
     
     // Инициализация
@@ -35,38 +193,101 @@ class DungeonMaster {
     void spawnCreature(const std::string& type, double x, double y, const std::string& name);
     void relocateCreature(size_t index, MoveDirection direction);
     
+    // Последний опубликованный кадр; reader вызывается под мьютексом
+    // читателей, симуляция при этом не останавливается
+    template <typename Reader>
+    void readFrame(Reader&& reader) const {
+      std::lock_guard lock(frameReaderMutex_);
+      if (frameStale_.load(std::memory_order_acquire)) {
+        publishStaleFrame();
+      }
+      frames_.update();
+      reader(frames_.front());
+    }
+    
     // Сохранение/загрузка
+    // Формат загрузки определяется по сигнатуре файла, формат сохранения -
+    // по расширению (.snap - двоичный снимок, иначе текст)
     void loadScenario(const std::string& fileName);
     void saveScenario(const std::string& fileName) const;
+    void saveScenario(const std::string& fileName, ScenarioFormat format) const;
+    // Снимок из памяти (опорный кадр повтора); в пустой мир - с зерном и тиком
+    void loadSnapshot(const Snapshot::View& snapshot, const std::string& source);
     
-    // Отображение
+    // Отображение и статистика читают последний кадр
     void displayCreature(const std::string& name) const;
     void displayAllCreatures() const;
     void displayLivingCreatures() const;
     void renderMap() const;
     
-    // Игровая механика
+    // Игровая механика: тик целиком
+    // (processMovementPhase, detectPotentialCombats, resolveCombatQueue)
     void processMovementPhase();
     void detectPotentialCombats();
     void resolveCombatQueue();
+    
+    // Те же фазы по отдельности для TickScheduler
+    void moveCreatures();
+    void updateSpatialIndex();
+    void resolveCombats();
+    void collectTickStats();
+    void publishTickFrame();
+    // Граф тика: движение -> сетка -> поиск -> бои -> статистика -> {кадр, события}
+    void registerTickPhases(TickScheduler& scheduler);
     void executeCombat(size_t attackerIdx, size_t defenderIdx);
+    void clearCombatQueue();
+    
+    // Режим поиска боев
+    void setCombatDetection(CombatDetection mode);
+    CombatDetection getCombatDetection() const;
+    size_t getLastPairTests() const;
+    // Ячейка сетки боев - наибольшая дальность атаки из настроек
+    double getCombatCellSize() const;
+    
+    // Очередь боев: емкость можно менять только между тиками
+    void setCombatQueueCapacity(size_t capacity);
+    CombatQueue::Stats getCombatQueueStats() const;
+    size_t getLastCombatBatches() const;
+    
+    // Шина событий: подписчики получают события пачками в конце тика
+    // (resolveCombatQueue) и после загрузки, сохранения и создания существ
+    EventBus& getEventBus() { return events_; }
+    size_t flushEvents() const;
+    
+    // Главное зерно симуляции; сбрасывает счетчик тиков
+    void setSeed(uint64_t seed);
+    uint64_t getSeed() const;
+    uint64_t getTick() const;
+    // Переносит внешние состояния существ в мир, ставит тик и публикует кадр
+    void restoreCreatures(const std::vector<CreatureState>& states, uint64_t tick);
+    
+    // Число потоков для фаз симуляции (1 - последовательно, 0 - по числу ядер).
+    // Пул общий для всех фаз; registerTickPhases отдает его планировщику
+    void setWorkerThreads(size_t threads);
+    size_t getWorkerThreads() const;
+    std::shared_ptr<WorkerPool> getWorkerPool() const;
+    
+    // Разбиение на тайлы columns x rows ячеек сетки (0 - выключено);
+    // тайлы работают только с поиском по сетке
+    void setWorldTiles(size_t columns, size_t rows);
+    TileMap::Stats getTileStats() const;
     
     // Геттеры для многопоточности
     size_t getCreatureCount() const;
     bool isCreatureAlive(size_t index) const;
     std::string getCreatureInfo(size_t index) const;
-    std::shared_mutex* getMutex() { return &creatureMutex_; }
-    
-    // Статистика
-    struct GameStats {
-        int totalCreatures;
-        int aliveCreatures;
-        int knights;
-        int elves;
-        int dragons;
-    };
+    TimedSharedMutex* getMutex() { return &creatureMutex_; }
     
     GameStats getCurrentStats() const;
+    
+    // Длительности фаз, ожидание creatureMutex_, глубина очереди боев,
+    // события и численность - в registry (должен пережить мир).
+    // Включается до запуска тиков
+    void enableMetrics(MetricsRegistry& registry);
+    
+    // Слушатель внешних воздействий (nullptr - отключить); должен пережить
+    // подключение
+    void setInputListener(WorldInputListener* listener);
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,178 @@
+#ifndef EVENT_BUS_HPP
+#define EVENT_BUS_HPP
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <memory>
+#include <type_traits>
+#include <cstdint>
+#include <cstddef>
+#include "./name_table.hpp"
+
+class NPC;
+
+// Типы событий симуляции; номер типа - бит в маске подписки
+enum EventType : uint8_t {
+  BATTLE_EVENT,
+  MOVE_EVENT,
+  SPAWN_EVENT,
+  DEATH_EVENT,
+  TICK_EVENT,
+  NOTICE_EVENT,
+  EVENT_TYPE_COUNT
+};
+
+using EventMask = uint32_t;
+
+constexpr EventMask eventBit(EventType type) {
+  return EventMask{1} << type;
+}
+
+constexpr EventMask ALL_EVENTS = (EventMask{1} << EVENT_TYPE_COUNT) - 1;
+
+// Служебные сообщения мира (загрузка, сохранение, инициализация)
+enum NoticeKind : uint8_t {
+  WORLD_INITIALIZED,
+  SCENARIO_LOADED,
+  SNAPSHOT_LOADED,
+  SCENARIO_SAVED,
+  SNAPSHOT_SAVED
+};
+
+// События - простые структуры без владения памятью: имена передаются
+// id из NameTable, текст собирает только подписчик
+struct BattleEvent {
+  uint32_t victor;
+  uint32_t defeated;
+  NameId victorName;
+  NameId defeatedName;
+  uint8_t victorType;
+  uint8_t defeatedType;
+};
+
+struct MoveEvent {
+  uint32_t creature;
+  NameId name;
+  uint8_t direction;
+  double x;
+  double y;
+};
+
+struct SpawnEvent {
+  uint32_t creature;
+  NameId name;
+  uint8_t type;
+  double x;
+  double y;
+};
+
+struct DeathEvent {
+  uint32_t creature;
+  uint32_t killer;
+  NameId name;
+  uint8_t type;
+};
+
+struct TickEvent {
+  uint32_t alive;
+  uint32_t battles;
+};
+
+struct NoticeEvent {
+  NoticeKind kind;
+  uint64_t count;
+  NameId text;      // имя файла и т.п., интернируется в NameTable
+};
+
+struct GameEvent {
+  EventType type;
+  uint64_t tick;
+  union {
+    BattleEvent battle;
+    MoveEvent move;
+    SpawnEvent spawn;
+    DeathEvent death;
+    TickEvent tickEnd;
+    NoticeEvent notice;
+  };
+};
+
+static_assert(std::is_trivially_copyable_v<GameEvent>, "События копируются побайтно");
+
+GameEvent makeBattleEvent(uint64_t tick, const NPC& victor, const NPC& defeated);
+GameEvent makeDeathEvent(uint64_t tick, const NPC& creature, const NPC& killer);
+GameEvent makeMoveEvent(uint64_t tick, const NPC& creature, uint8_t direction);
+GameEvent makeSpawnEvent(uint64_t tick, const NPC& creature);
+GameEvent makeTickEvent(uint64_t tick, uint32_t alive, uint32_t battles);
+GameEvent makeNoticeEvent(uint64_t tick, NoticeKind kind, uint64_t count,
+                          const std::string& text = "");
+
+// Текст события для журналов событий (рождение, смерть, тик, сообщения)
+void appendEventText(std::string& out, const GameEvent& event);
+
+// Подписчик получает события пачкой и только типов из своей маски
+class EventSubscriber {
+  public:
+    virtual ~EventSubscriber() = default;
+
+    virtual EventMask interests() const = 0;
+    virtual void deliver(const GameEvent* events, size_t count) = 0;
+};
+
+// Шина событий: издатели пишут в буфер своего потока, flush в конце тика
+// собирает буферы и раздает подписчикам. Событие, на которое никто не
+// подписан, не создается: издатель сначала проверяет wants().
+class EventBus {
+  private:
+    struct ThreadBuffer {
+      std::thread::id owner;
+      std::mutex mutex;           // спорят только издатель и flush
+      std::vector<GameEvent> events;
+    };
+
+    const uint64_t busId_;
+    std::atomic<EventMask> interest_{0};
+
+    mutable std::mutex registryMutex_;
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers_;
+    std::vector<EventSubscriber*> subscribers_;
+
+    // Доставка идет в одном потоке за раз
+    std::mutex deliveryMutex_;
+    std::vector<GameEvent> batch_;
+    std::vector<GameEvent> filtered_;
+
+    std::atomic<size_t> published_{0};
+    std::atomic<size_t> delivered_{0};
+
+    ThreadBuffer& localBuffer();
+    void updateInterest();
+
+  public:
+    EventBus();
+
+    EventBus(const EventBus&) = delete;
+    EventBus& operator=(const EventBus&) = delete;
+
+    // Подписчиком владеет вызывающий
+    void subscribe(EventSubscriber* subscriber);
+    void unsubscribe(EventSubscriber* subscriber);
+
+    bool wants(EventType type) const {
+      return (interest_.load(std::memory_order_relaxed) & eventBit(type)) != 0;
+    }
+
+    void publish(const GameEvent& event);
+
+    // Доставляет накопленное; события одного потока - в порядке публикации,
+    // потоки - в порядке первой публикации
+    size_t flush();
+
+    size_t getPublished() const { return published_.load(std::memory_order_relaxed); }
+    size_t getDelivered() const { return delivered_.load(std::memory_order_relaxed); }
+};
+
+#endif
@@ -2,10 +2,13 @@
 #define FACTORY_HPP
 
 #include "../npc/npc.hpp"
+#include "./creature_store.hpp"
+#include "./creature_arena.hpp"
 #include <memory>
 #include <string>
 #include <fstream>
-#include <random>
+#include <cstddef>
+#include <cstdint>
 #include <vector>
 
 class CreatureFactory {
@@ -14,6 +17,8 @@ class CreatureFactory {
     static std::unique_ptr<NPC> createCreature(NPCType type);
     static std::unique_ptr<NPC> createCreature(NPCType type, double x, double y, 
                                                const std::string& name);
+    static size_t createCreature(CreatureStore& store, NPCType type, double x, double y,
+                                 const std::string& name);
     
     // Альтернативные методы создания
     static std::unique_ptr<NPC> createRandomCreature();
@@ -31,12 +36,24 @@ class CreatureFactory {
                                                                  int count);
     static std::vector<std::unique_ptr<NPC>> createRandomSwarm(int count);
     
+    // Создание в арене: без выделений памяти на каждое существо
+    static NPC& createCreature(CreatureArena& arena, NPCType type, double x, double y,
+                               const std::string& name);
+    static void createCreatureSwarm(CreatureArena& arena, NPCType type, int count);
+    static void createRandomSwarm(CreatureArena& arena, int count);
+    
     // Утилиты
     static std::string generateCreatureName(NPCType type);
     static bool validatePosition(double x, double y);
     
+    // Зерно общего генератора фабрики и имен (см. seedSharedRandom)
+    static void setSeed(uint64_t seed);
+    
   private:
-    static std::mt19937& getRandomEngine();
+    static std::unique_ptr<NPC> wrapCreature(const std::shared_ptr<CreatureStore>& owner,
+                                             size_t slot);
+    static NPC& placeInArena(CreatureArena& arena, size_t slot);
+    static int pickIndex(size_t count);
     static std::string getRandomKnightName();
     static std::string getRandomElfName();
     static std::string getRandomDragonName();
@@ -0,0 +1,95 @@
+#ifndef LOCK_FREE_RING_HPP
+#define LOCK_FREE_RING_HPP
+
+#include <atomic>
+#include <memory>
+#include <cstddef>
+
+// Ограниченная очередь без блокировок на кольцевом буфере (схема Вьюкова):
+// у каждой ячейки свой счетчик последовательности, поэтому производители
+// и потребители не берут мьютексов. Емкость округляется до степени двойки.
+template <typename T>
+class LockFreeRing {
+  private:
+    struct Cell {
+      std::atomic<size_t> sequence;
+      T value;
+    };
+    
+    std::unique_ptr<Cell[]> cells_;
+    size_t mask_;
+    alignas(64) std::atomic<size_t> enqueuePos_{0};
+    alignas(64) std::atomic<size_t> dequeuePos_{0};
+    
+    static size_t roundUp(size_t value) {
+      size_t result = 2;
+      while (result < value) result <<= 1;
+      return result;
+    }
+    
+  public:
+    explicit LockFreeRing(size_t capacity): mask_(roundUp(capacity) - 1) {
+      cells_ = std::make_unique<Cell[]>(mask_ + 1);
+      for (size_t i = 0; i <= mask_; ++i) {
+        cells_[i].sequence.store(i, std::memory_order_relaxed);
+      }
+    }
+    
+    LockFreeRing(const LockFreeRing&) = delete;
+    LockFreeRing& operator=(const LockFreeRing&) = delete;
+    
+    bool tryPush(const T& value) {
+      size_t position = enqueuePos_.load(std::memory_order_relaxed);
+      while (true) {
+        Cell& cell = cells_[position & mask_];
+        const size_t sequence = cell.sequence.load(std::memory_order_acquire);
+        const auto difference = static_cast<std::ptrdiff_t>(sequence) -
+                                static_cast<std::ptrdiff_t>(position);
+        if (difference == 0) {
+          if (enqueuePos_.compare_exchange_weak(position, position + 1,
+                                                std::memory_order_relaxed)) {
+            cell.value = value;
+            cell.sequence.store(position + 1, std::memory_order_release);
+            return true;
+          }
+        } else if (difference < 0) {
+          return false; // очередь заполнена
+        } else {
+          position = enqueuePos_.load(std::memory_order_relaxed);
+        }
+      }
+    }
+    
+    bool tryPop(T& value) {
+      size_t position = dequeuePos_.load(std::memory_order_relaxed);
+      while (true) {
+        Cell& cell = cells_[position & mask_];
+        const size_t sequence = cell.sequence.load(std::memory_order_acquire);
+        const auto difference = static_cast<std::ptrdiff_t>(sequence) -
+                                static_cast<std::ptrdiff_t>(position + 1);
+        if (difference == 0) {
+          if (dequeuePos_.compare_exchange_weak(position, position + 1,
+                                                std::memory_order_relaxed)) {
+            value = cell.value;
+            cell.sequence.store(position + mask_ + 1, std::memory_order_release);
+            return true;
+          }
+        } else if (difference < 0) {
+          return false; // очередь пуста
+        } else {
+          position = dequeuePos_.load(std::memory_order_relaxed);
+        }
+      }
+    }
+    
+    size_t capacity() const { return mask_ + 1; }
+    
+    // Приблизительный размер: точен, только когда нет параллельных операций
+    size_t sizeApprox() const {
+      const size_t head = dequeuePos_.load(std::memory_order_relaxed);
+      const size_t tail = enqueuePos_.load(std::memory_order_relaxed);
+      return tail > head ? tail - head : 0;
+    }
+};
+
+#endif
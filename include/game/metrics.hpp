@@ -0,0 +1,220 @@
+#ifndef METRICS_HPP
+#define METRICS_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <ostream>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "./trace.hpp"
+
+// Гистограмма задержек в наносекундах в духе HDR: корзины лог-линейные,
+// 16 корзин на каждую степень двойки (ошибка квантиля не больше 1/16).
+// Запись - несколько relaxed-атомиков, писать можно из любых потоков
+class LatencyHistogram {
+  public:
+    static constexpr int SUB_BITS = 4;
+    static constexpr uint64_t SUB_BUCKETS = uint64_t{1} << SUB_BITS;
+    // Старшая степень двойки: 2^40 нс - около 18 минут, больше - в последнюю корзину
+    static constexpr int MAX_EXPONENT = 40;
+    static constexpr size_t BUCKETS = (MAX_EXPONENT - SUB_BITS + 2) * SUB_BUCKETS;
+
+    // Согласованная копия для расчета квантилей
+    struct Snapshot {
+      std::vector<uint64_t> counts;
+      uint64_t count = 0;
+      uint64_t sum = 0;
+      uint64_t max = 0;
+
+      // Верхняя граница корзины, в которую попал квантиль q (0..1)
+      uint64_t percentile(double q) const;
+    };
+
+  private:
+    std::array<std::atomic<uint64_t>, BUCKETS> counts_{};
+    std::atomic<uint64_t> count_{0};
+    std::atomic<uint64_t> sum_{0};
+    std::atomic<uint64_t> max_{0};
+
+  public:
+    static size_t bucketOf(uint64_t nanos);
+    static uint64_t bucketUpperBound(size_t bucket);
+
+    void record(uint64_t nanos);
+    Snapshot snapshot() const;
+    uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+};
+
+class MetricCounter {
+  private:
+    std::atomic<uint64_t> value_{0};
+
+  public:
+    void add(uint64_t amount = 1) { value_.fetch_add(amount, std::memory_order_relaxed); }
+    uint64_t value() const { return value_.load(std::memory_order_relaxed); }
+};
+
+class MetricGauge {
+  private:
+    std::atomic<int64_t> value_{0};
+
+  public:
+    void set(int64_t value) { value_.store(value, std::memory_order_relaxed); }
+    int64_t value() const { return value_.load(std::memory_order_relaxed); }
+};
+
+// Замер области: без гистограммы (метрики выключены) часы не читаются
+class ScopedLatency {
+  private:
+    LatencyHistogram* histogram_;
+    std::chrono::steady_clock::time_point start_;
+
+  public:
+    explicit ScopedLatency(LatencyHistogram* histogram): histogram_(histogram) {
+      if (histogram_ != nullptr) {
+        start_ = std::chrono::steady_clock::now();
+      }
+    }
+    ~ScopedLatency() {
+      if (histogram_ != nullptr) {
+        histogram_->record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start_).count()));
+      }
+    }
+
+    ScopedLatency(const ScopedLatency&) = delete;
+    ScopedLatency& operator=(const ScopedLatency&) = delete;
+};
+
+// shared_mutex с замером ожидания захвата. Захват без конкуренции
+// (try_lock удался) пишется нулем без чтения часов; ожидание под
+// конкуренцией попадает еще и в трассу (TraceScope)
+class TimedSharedMutex {
+  private:
+    std::shared_mutex mutex_;
+    std::atomic<LatencyHistogram*> exclusiveWait_{nullptr};
+    std::atomic<LatencyHistogram*> sharedWait_{nullptr};
+
+  public:
+    // nullptr - без замеров; подключать можно в любой момент
+    void attach(LatencyHistogram* exclusiveWait, LatencyHistogram* sharedWait) {
+      exclusiveWait_.store(exclusiveWait, std::memory_order_relaxed);
+      sharedWait_.store(sharedWait, std::memory_order_relaxed);
+    }
+
+    void lock() {
+      LatencyHistogram* wait = exclusiveWait_.load(std::memory_order_relaxed);
+      if (mutex_.try_lock()) {
+        if (wait != nullptr) wait->record(0);
+        return;
+      }
+      ScopedLatency timer(wait);
+      TraceScope trace("ожидание creatureMutex_", "lock");
+      mutex_.lock();
+    }
+    bool try_lock() { return mutex_.try_lock(); }
+    void unlock() { mutex_.unlock(); }
+
+    void lock_shared() {
+      LatencyHistogram* wait = sharedWait_.load(std::memory_order_relaxed);
+      if (mutex_.try_lock_shared()) {
+        if (wait != nullptr) wait->record(0);
+        return;
+      }
+      ScopedLatency timer(wait);
+      TraceScope trace("ожидание creatureMutex_ (чтение)", "lock");
+      mutex_.lock_shared();
+    }
+    bool try_lock_shared() { return mutex_.try_lock_shared(); }
+    void unlock_shared() { mutex_.unlock_shared(); }
+};
+
+// Формат выгрузки
+enum MetricsFormat {
+  PROMETHEUS_TEXT,
+  JSON_METRICS
+};
+
+// Реестр метрик. Метрики заводятся при настройке и живут, пока жив реестр
+// (адреса стабильны); обновлять их можно из любых потоков без реестра.
+// Метка - одна пара ключ="значение" (фаза, режим блокировки), может быть пустой
+class MetricsRegistry {
+  public:
+    enum Kind { HISTOGRAM, COUNTER, GAUGE };
+
+  private:
+    struct Entry {
+      Kind kind;
+      std::string name;
+      std::string labelKey;
+      std::string labelValue;
+      std::string help;
+      size_t index;
+    };
+
+    std::deque<LatencyHistogram> histograms_;
+    std::deque<MetricCounter> counters_;
+    std::deque<MetricGauge> gauges_;
+    std::vector<Entry> entries_;
+    mutable std::mutex registryMutex_;
+
+    // Для скорости счетчиков: значения при прошлой выгрузке
+    mutable std::vector<uint64_t> lastCounterValues_;
+    mutable std::chrono::steady_clock::time_point lastExport_;
+    mutable bool exported_ = false;
+
+    const Entry* find(Kind kind, const std::string& name, const std::string& labelValue) const;
+    std::vector<double> counterRates() const;
+
+  public:
+    LatencyHistogram& histogram(const std::string& name, const std::string& help,
+                                const std::string& labelKey = "", const std::string& labelValue = "");
+    MetricCounter& counter(const std::string& name, const std::string& help);
+    MetricGauge& gauge(const std::string& name, const std::string& help);
+
+    // Гистограммы - сводки с квантилями в секундах; у счетчиков
+    // дополнительно скорость в секунду с прошлой выгрузки
+    void write(std::ostream& out, MetricsFormat format) const;
+    // Через временный файл и rename: читатель не видит половину выгрузки
+    void writeFile(const std::string& fileName, MetricsFormat format) const;
+};
+
+// Периодическая выгрузка реестра в файл из фонового потока;
+// формат по расширению (.json - JSON, иначе текст Prometheus)
+class MetricsExporter {
+  private:
+    const MetricsRegistry& registry_;
+    std::string fileName_;
+    MetricsFormat format_;
+    std::chrono::milliseconds interval_;
+
+    std::thread writer_;
+    std::mutex wakeMutex_;
+    std::condition_variable wakeUp_;
+    bool stopping_ = false;
+    std::atomic<size_t> exports_{0};
+
+    void writerLoop();
+
+  public:
+    MetricsExporter(const MetricsRegistry& registry, const std::string& fileName,
+                    std::chrono::milliseconds interval);
+    // Последняя выгрузка - при остановке
+    ~MetricsExporter();
+
+    MetricsExporter(const MetricsExporter&) = delete;
+    MetricsExporter& operator=(const MetricsExporter&) = delete;
+
+    size_t getExports() const { return exports_.load(std::memory_order_relaxed); }
+    static MetricsFormat formatFor(const std::string& fileName);
+};
+
+#endif
@@ -0,0 +1,72 @@
+#ifndef NAME_TABLE_HPP
+#define NAME_TABLE_HPP
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+using NameId = uint32_t;
+
+// Глобальная таблица интернированных имен: каждое различное имя хранится
+// один раз и получает компактный id. Чтение текста по id не берет
+// блокировок: записи лежат в кусках, которые не перемещаются.
+// Id 0 - пустое имя.
+class NameTable {
+  private:
+    static constexpr size_t CHUNK_BITS = 12;
+    static constexpr size_t CHUNK_SIZE = size_t{1} << CHUNK_BITS;
+    static constexpr size_t MAX_CHUNKS = 4096;
+    static constexpr size_t TEXT_BLOCK = 64 * 1024;
+    
+    struct Entry {
+      const char* data;
+      uint32_t length;
+    };
+    
+    std::array<std::atomic<Entry*>, MAX_CHUNKS> chunks_{};
+    std::vector<std::unique_ptr<Entry[]>> ownedChunks_;
+    std::vector<std::unique_ptr<char[]>> textBlocks_;
+    size_t textUsed_ = TEXT_BLOCK;
+    
+    mutable std::shared_mutex indexMutex_;
+    std::unordered_map<std::string_view, NameId> index_;
+    std::atomic<uint32_t> size_{0};
+    
+    const char* storeText(std::string_view text);
+    
+  public:
+    NameTable();
+    
+    NameTable(const NameTable&) = delete;
+    NameTable& operator=(const NameTable&) = delete;
+    
+    NameId intern(std::string_view text);
+    bool find(std::string_view text, NameId& id) const;
+    
+    std::string_view view(NameId id) const {
+      const Entry& entry = chunks_[id >> CHUNK_BITS].load(std::memory_order_acquire)
+                                  [id & (CHUNK_SIZE - 1)];
+      return std::string_view(entry.data, entry.length);
+    }
+    
+    size_t size() const { return size_.load(std::memory_order_acquire); }
+    
+    static NameTable& global();
+};
+
+inline NameId internName(std::string_view text) {
+  return NameTable::global().intern(text);
+}
+
+inline std::string_view nameText(NameId id) {
+  return NameTable::global().view(id);
+}
+
+#endif
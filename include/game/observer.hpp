@@ -6,14 +6,23 @@
 #include <mutex>
 #include <memory>
 #include <vector>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <ctime>
+#include <condition_variable>
 #include "../npc/npc.hpp"
+#include "./constants.hpp"
+#include "./arena_settings.hpp"
+#include "./lock_free_ring.hpp"
+#include "./event_bus.hpp"
 
-class GameEventLogger {
+// Журналы - подписчики шины событий. recordBattle/recordMovement
+// доставляют одно событие сразу, в обход шины
+class GameEventLogger : public EventSubscriber {
   public:
-    virtual ~GameEventLogger() = default;
-    
-    virtual void recordBattle(const NPC& victor, const NPC& defeated) = 0;
-    virtual void recordMovement(const NPC& creature, MoveDirection direction) = 0;
+    void recordBattle(const NPC& victor, const NPC& defeated);
+    void recordMovement(const NPC& creature, MoveDirection direction);
     virtual void recordGameEvent(const std::string& event) = 0;
     virtual void displayWorldState(const std::vector<const NPC*>& creatures) = 0;
 };
@@ -24,28 +33,80 @@ class ConsoleDisplay : public GameEventLogger {
     
     std::string formatCoordinates(double x, double y) const;
     std::string formatCreatureType(NPCType type) const;
+    void appendEvent(std::string& out, const GameEvent& event) const;
     
   public:
-    void recordBattle(const NPC& victor, const NPC& defeated) override;
-    void recordMovement(const NPC& creature, MoveDirection direction) override;
+    static constexpr EventMask DEFAULT_INTERESTS =
+        eventBit(BATTLE_EVENT) | eventBit(MOVE_EVENT) | eventBit(SPAWN_EVENT) | eventBit(NOTICE_EVENT);
+    
+    EventMask interests() const override { return DEFAULT_INTERESTS; }
+    void deliver(const GameEvent* events, size_t count) override;
     void recordGameEvent(const std::string& event) override;
     void displayWorldState(const std::vector<const NPC*>& creatures) override;
 };
 
+// Параметры FileRecorder: в асинхронном режиме события кладутся в кольцевой
+// буфер, а фоновый поток форматирует и пишет их пачками
+struct RecorderOptions {
+  bool async = true;
+  size_t queueCapacity = ArenaConfig::Logging::ASYNC_QUEUE_CAPACITY;
+  std::chrono::milliseconds flushInterval{arenaSettings().logFlushInterval};
+};
+
+// Запись журнала: событие шины (имена - id в NameTable, текст собирает
+// писатель) или произвольный текст, который копируется
+struct LogRecord {
+  static constexpr size_t TEXT_CAPACITY = 96;
+  
+  enum Kind : uint8_t { GAME_EVENT, TEXT };
+  
+  Kind kind = TEXT;
+  std::time_t time = 0;
+  GameEvent event{};
+  char text[TEXT_CAPACITY] = {};
+};
+
 class FileRecorder : public GameEventLogger {
   private:
     std::ofstream battleLog_;
     std::ofstream movementLog_;
     std::ofstream eventLog_;
     mutable std::mutex fileMutex_;
+    RecorderOptions options_;
+    
+    // Метка времени форматируется не чаще раза в секунду
+    std::time_t cachedSecond_ = -1;
+    char cachedStamp_[32] = {};
+    
+    // Асинхронный режим
+    std::unique_ptr<LockFreeRing<LogRecord>> queue_;
+    std::thread writer_;
+    std::atomic<bool> stopping_{false};
+    std::mutex wakeMutex_;
+    std::condition_variable wakeUp_;
+    std::atomic<size_t> droppedRecords_{0};
+    std::atomic<size_t> writtenRecords_{0};
     
     void writeToLog(std::ofstream& stream, const std::string& message);
+    const char* timestamp(std::time_t now);
+    void enqueue(const LogRecord& record);
+    void writerLoop();
+    void appendRecord(const LogRecord& record, std::string& battles,
+                      std::string& movements, std::string& events);
     
   public:
+    static constexpr EventMask DEFAULT_INTERESTS =
+        eventBit(BATTLE_EVENT) | eventBit(MOVE_EVENT) | eventBit(SPAWN_EVENT) | eventBit(NOTICE_EVENT);
+    
     FileRecorder();
+    explicit FileRecorder(const RecorderOptions& options);
+    
+    bool isAsync() const { return queue_ != nullptr; }
+    size_t getDroppedRecords() const { return droppedRecords_; }
+    size_t getWrittenRecords() const { return writtenRecords_; }
     
-    void recordBattle(const NPC& victor, const NPC& defeated) override;
-    void recordMovement(const NPC& creature, MoveDirection direction) override;
+    EventMask interests() const override { return DEFAULT_INTERESTS; }
+    void deliver(const GameEvent* events, size_t count) override;
     void recordGameEvent(const std::string& event) override;
     void displayWorldState(const std::vector<const NPC*>& creatures) override;
     
@@ -0,0 +1,47 @@
+#ifndef RANDOM_STREAM_HPP
+#define RANDOM_STREAM_HPP
+
+#include <cstdint>
+#include <limits>
+
+enum RandomPurpose : uint64_t {
+  PLACEMENT = 1,
+  MOVEMENT = 2,
+  COMBAT = 3,
+  NAMING = 4,
+  TRAITS = 5
+};
+
+// Счетный генератор: значение зависит только от ключа
+// (главное зерно, тик, id существа, назначение, подключ) и номера вызова.
+// Результат не зависит от числа потоков и порядка обработки существ.
+class RandomStream {
+  private:
+    uint64_t key_;
+    uint64_t counter_ = 0;
+    
+  public:
+    using result_type = uint64_t;
+    
+    RandomStream(uint64_t seed, uint64_t tick, uint64_t id, RandomPurpose purpose,
+                 uint64_t subkey = 0);
+    
+    uint64_t next();
+    int uniformInt(int low, int high);
+    double uniformReal(double low, double high);
+    
+    // Совместимость с UniformRandomBitGenerator
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+    result_type operator()() { return next(); }
+    
+    static uint64_t mix(uint64_t value);
+};
+
+// Общий поток для вспомогательных генераторов вне тиков (фабрика, имена).
+// Потокобезопасен; детерминирован при детерминированном порядке вызовов.
+void seedSharedRandom(uint64_t seed);
+RandomStream nextSharedStream(RandomPurpose purpose);
+uint64_t generateSeed();
+
+#endif
@@ -0,0 +1,98 @@
+#ifndef RANGE_KERNEL_HPP
+#define RANGE_KERNEL_HPP
+
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+#include "./creature_store.hpp"
+
+// Биты результата пакетной проверки для пары (зонд, кандидат)
+enum RangeHit : uint8_t {
+  PROBE_KILLS = 1,
+  CANDIDATE_KILLS = 2
+};
+
+// Упакованный блок кандидатов (SoA) для пакетной проверки дальности:
+// вместо типов хранятся маска добычи и бит типа, радиусы - в квадрате
+struct CandidateBlock {
+  std::vector<double> x;
+  std::vector<double> y;
+  std::vector<double> rangeSquared;
+  std::vector<uint8_t> preyMask;
+  std::vector<uint8_t> typeBit;
+  
+  void pack(const CreatureStore& store, const std::vector<size_t>& ids);
+  void clear();
+  void append(const CreatureStore& store, size_t id);
+  // Копия кандидатов [begin, end) другого блока (ореол тайла)
+  void append(const CandidateBlock& other, size_t begin, size_t end);
+  size_t size() const { return x.size(); }
+};
+
+// Проверяемое существо, развернутое для сравнения с блоком
+struct RangeProbe {
+  double x;
+  double y;
+  double rangeSquared;
+  uint8_t preyMask;
+  uint8_t typeBit;
+  
+  static RangeProbe fromBlock(const CandidateBlock& block, size_t index);
+};
+
+namespace RangeKernel {
+  // Для кандидатов [begin, end) пишет в hits[k] биты RangeHit.
+  // Существа считаются живыми: в блок попадают только живые
+  using BlockTest = void (*)(const RangeProbe& probe, const CandidateBlock& block,
+                             size_t begin, size_t end, uint8_t* hits);
+  
+  void testBlockScalar(const RangeProbe& probe, const CandidateBlock& block,
+                       size_t begin, size_t end, uint8_t* hits);
+  void testBlockAvx2(const RangeProbe& probe, const CandidateBlock& block,
+                     size_t begin, size_t end, uint8_t* hits);
+  
+  // Выбор реализации по возможностям процессора при первом вызове
+  bool avx2Supported();
+  BlockTest selected();
+  const char* selectedName();
+  
+  inline void testBlock(const RangeProbe& probe, const CandidateBlock& block,
+                        size_t begin, size_t end, uint8_t* hits) {
+    selected()(probe, block, begin, end, hits);
+  }
+  
+  // Все пары блока ячейки (SpatialGrid::forEachCellBlock): зонд block[h],
+  // h < homeCount, против хвоста блока. found(attacker, defender, k) - для пар,
+  // где один может убить другого; как в testPair, первым проверяется
+  // существо с меньшим индексом. Возвращает число проверенных пар
+  template <typename Found>
+  size_t forEachBlockHit(const CandidateBlock& packed, const std::vector<size_t>& block,
+                         size_t homeCount, std::vector<uint8_t>& hits, Found&& found) {
+    const BlockTest test = selected();
+    const size_t count = block.size();
+    hits.resize(count);
+    size_t pairTests = 0;
+    
+    for (size_t h = 0; h < homeCount; ++h) {
+      test(RangeProbe::fromBlock(packed, h), packed, h + 1, count, hits.data());
+      pairTests += count - h - 1;
+      
+      for (size_t k = h + 1; k < count; ++k) {
+        if (hits[k] == 0) continue;
+        
+        const size_t probe = block[h];
+        const size_t candidate = block[k];
+        const bool probeFirst = probe < candidate;
+        if ((hits[k] & (probeFirst ? PROBE_KILLS : CANDIDATE_KILLS)) != 0) {
+          found(std::min(probe, candidate), std::max(probe, candidate), k);
+        } else {
+          found(std::max(probe, candidate), std::min(probe, candidate), k);
+        }
+      }
+    }
+    return pairTests;
+  }
+}
+
+#endif
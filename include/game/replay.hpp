@@ -0,0 +1,185 @@
+#ifndef REPLAY_HPP
+#define REPLAY_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "./dungeon_master.hpp"
+#include "./arena_settings.hpp"
+
+// Запись повтора:
+//   [Header][Record]...[Footer]
+// Record - заголовок и данные, выровненные по 8 байт: опорный кадр
+// (двоичный снимок мира), появление или перемещение существа. Первый
+// опорный кадр - начальный мир, следующие - каждые keyframeInterval тиков.
+// Тики между ними не пишутся: симуляция детерминирована по зерну и тику,
+// повтор пересчитывает их сам. Воздействие относится к тику мира, в
+// который оно случилось, и применяется в порядке записи после кадра,
+// стоящего перед ним в файле. В конце - контрольная сумма итогового мира.
+// Заголовок хранит мир, шаги и дальности: с ними создаются новые существа
+namespace Replay {
+  constexpr char MAGIC[8] = {'B', 'A', 'L', 'R', 'E', 'P', 'L', '\0'};
+  constexpr char FOOTER_MAGIC[8] = {'B', 'A', 'L', 'R', 'E', 'N', 'D', '\0'};
+  constexpr uint32_t VERSION = 2;
+
+  enum RecordKind : uint32_t {
+    KEYFRAME = 1,
+    SPAWN = 2,
+    RELOCATE = 3
+  };
+
+  struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t headerSize;
+    uint64_t seed;
+    uint64_t startTick;
+    uint64_t keyframeInterval;
+    WorldBounds world;
+    double step[NPC_TYPE_COUNT];
+    double range[NPC_TYPE_COUNT];
+  };
+
+  struct RecordHeader {
+    uint64_t tick;
+    uint32_t kind;
+    uint32_t reserved;
+    uint64_t size;            // данные без выравнивания
+  };
+
+  struct SpawnInput {
+    double x;
+    double y;
+    uint8_t type;
+    uint8_t reserved[3];
+    uint32_t nameLength;      // имя следует за записью
+  };
+
+  struct RelocateInput {
+    uint64_t index;
+    uint8_t direction;
+    uint8_t reserved[7];
+  };
+
+  struct Footer {
+    uint64_t endTick;
+    uint64_t finalChecksum;   // stateChecksum мира при закрытии
+    char magic[8];
+  };
+
+  static_assert(sizeof(Header) == 136, "Формат заголовка повтора изменился");
+  static_assert(sizeof(RecordHeader) == 24, "Формат записи повтора изменился");
+  static_assert(sizeof(SpawnInput) == 24, "Формат появления в повторе изменился");
+  static_assert(sizeof(RelocateInput) == 16, "Формат перемещения в повторе изменился");
+  static_assert(sizeof(Footer) == 24, "Формат конца повтора изменился");
+
+  // Сумма по координатам и флагам жизни - для сверки повтора с записью
+  uint64_t stateChecksum(const CreatureStore& creatures);
+
+  // Пишет повтор мира с момента создания: начальный кадр сразу, ввод -
+  // по мере воздействий (слушатель мира), опорные кадры - из afterTick()
+  class Recorder : public WorldInputListener {
+    public:
+      struct Stats {
+        uint64_t ticks;
+        uint64_t inputs;
+        uint64_t keyframes;
+        uint64_t bytes;
+      };
+
+    private:
+      DungeonMaster& world_;
+      std::ofstream out_;
+      Header header_;
+      // Воздействия приходят из потоков, меняющих мир
+      std::mutex writeMutex_;
+      Stats stats_{0, 0, 0, 0};
+      uint64_t lastKeyframe_ = 0;
+      bool closed_ = false;
+
+      void writeRecord(uint64_t tick, RecordKind kind, const void* data, size_t size,
+                       const std::string& tail = "");
+      void writeKeyframe();
+
+    public:
+      Recorder(const std::string& fileName, DungeonMaster& world, uint64_t keyframeInterval);
+      // Закрывает файл, если close() не вызывали (ошибки при этом теряются)
+      ~Recorder() override;
+
+      Recorder(const Recorder&) = delete;
+      Recorder& operator=(const Recorder&) = delete;
+
+      void onSpawn(uint64_t tick, NPCType type, double x, double y, const std::string& name) override;
+      void onRelocate(uint64_t tick, size_t index, MoveDirection direction) override;
+
+      // Вызывается после каждого тика, до воздействий следующего
+      void afterTick();
+      // Отключается от мира и дописывает контрольную сумму
+      void close();
+
+      Stats getStats() const { return stats_; }
+  };
+
+  // Воспроизведение: мир восстанавливается из ближайшего опорного кадра,
+  // дальше тики считаются заново с записанными воздействиями
+  class Player {
+    public:
+      struct Input {
+        uint64_t tick;
+        RecordKind kind;
+        NPCType type;
+        double x;
+        double y;
+        std::string name;
+        size_t index;
+        MoveDirection direction;
+      };
+
+    private:
+      struct Keyframe {
+        uint64_t tick;
+        size_t offset;            // данные снимка
+        size_t size;
+        size_t firstInput;        // воздействия после кадра
+      };
+
+      void* mapping_ = nullptr;
+      size_t size_ = 0;
+      std::string fileName_;
+      const Header* header_ = nullptr;
+      const Footer* footer_ = nullptr;
+      std::vector<Keyframe> keyframes_;
+      std::vector<Input> inputs_;
+      size_t nextInput_ = 0;
+
+      void parse();
+
+    public:
+      explicit Player(const std::string& fileName);
+      ~Player();
+
+      Player(const Player&) = delete;
+      Player& operator=(const Player&) = delete;
+
+      const Header& header() const { return *header_; }
+      // Мир, шаги и дальности записи - до создания мира повтора
+      void applySettings(ArenaSettings& settings) const;
+      uint64_t startTick() const { return header_->startTick; }
+      uint64_t endTick() const { return footer_->endTick; }
+      size_t keyframeCount() const { return keyframes_.size(); }
+      size_t inputCount() const { return inputs_.size(); }
+
+      // Загружает в пустой мир последний опорный кадр не позже target;
+      // возвращает его тик. Настройки процесса должны совпадать с записью
+      uint64_t restore(DungeonMaster& world, uint64_t target);
+      // Воздействия текущего тика мира - перед запуском следующего
+      size_t applyInputs(DungeonMaster& world);
+      // Мир дошел до endTick: оставшиеся воздействия и сверка с записью
+      bool finish(DungeonMaster& world);
+  };
+}
+
+#endif
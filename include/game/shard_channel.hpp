@@ -0,0 +1,143 @@
+#ifndef SHARD_CHANNEL_HPP
+#define SHARD_CHANNEL_HPP
+
+#include <vector>
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+#include <stdexcept>
+#include <type_traits>
+
+// Команды координатора; шард отвечает сообщением того же типа
+enum ShardMessage : uint32_t {
+  SHARD_TICK,        // -> тик; <- эмигранты по шардам-получателям
+  SHARD_IMMIGRANTS,  // -> мигранты; <- ореол для шарда выше
+  SHARD_HALO,        // -> ореол шарда ниже; <- пограничные существа шарда ниже
+  SHARD_BORDER,      // -> свои пограничные; <- бои, отложенные пары, участники
+  SHARD_DEATHS,      // -> погибшие в отложенных боях; <- счетчики шарда
+  SHARD_COLLECT,     // <- все свои существа
+  SHARD_STOP
+};
+
+// Изменчивая часть существа; тип, шаг и дальность у всех процессов общие
+struct ShardCreature {
+  uint64_t id;
+  double x;
+  double y;
+  uint32_t alive;
+  uint32_t reserved;
+};
+
+struct ShardPair {
+  uint64_t first;
+  uint64_t second;
+};
+
+struct ShardBattle {
+  ShardPair pair;
+  uint32_t outcome;    // BattleOutcome
+  uint32_t reserved;
+};
+
+// Живые существа шарда по типам
+struct ShardCounts {
+  uint64_t alive;
+  uint64_t knights;
+  uint64_t elves;
+  uint64_t dragons;
+};
+
+// Тело сообщения: значения и векторы POD подряд, без выравнивания.
+// Процессы одной сборки на одной машине, поэтому порядок байт общий
+class MessageBuffer {
+  private:
+    std::vector<uint8_t> bytes_;
+    size_t readPos_ = 0;
+
+    void take(void* target, size_t size) {
+      if (readPos_ + size > bytes_.size()) {
+        throw std::runtime_error("Сообщение шарда короче ожидаемого");
+      }
+      std::memcpy(target, bytes_.data() + readPos_, size);
+      readPos_ += size;
+    }
+
+  public:
+    template <typename T>
+    void put(const T& value) {
+      static_assert(std::is_trivially_copyable_v<T>);
+      const auto* raw = reinterpret_cast<const uint8_t*>(&value);
+      bytes_.insert(bytes_.end(), raw, raw + sizeof(T));
+    }
+
+    template <typename T>
+    void putVector(const std::vector<T>& values) {
+      static_assert(std::is_trivially_copyable_v<T>);
+      put<uint64_t>(values.size());
+      const auto* raw = reinterpret_cast<const uint8_t*>(values.data());
+      bytes_.insert(bytes_.end(), raw, raw + values.size() * sizeof(T));
+    }
+
+    template <typename T>
+    T get() {
+      T value;
+      take(&value, sizeof(T));
+      return value;
+    }
+
+    template <typename T>
+    void getVector(std::vector<T>& values) {
+      const auto count = get<uint64_t>();
+      if (count > (bytes_.size() - readPos_) / sizeof(T)) {
+        throw std::runtime_error("Сообщение шарда короче ожидаемого");
+      }
+      values.resize(count);
+      take(values.data(), count * sizeof(T));
+    }
+
+    void clear() {
+      bytes_.clear();
+      readPos_ = 0;
+    }
+    const uint8_t* data() const { return bytes_.data(); }
+    size_t size() const { return bytes_.size(); }
+    void assign(size_t size) {
+      bytes_.resize(size);
+      readPos_ = 0;
+    }
+    uint8_t* writable() { return bytes_.data(); }
+};
+
+// Конец Unix-сокета между координатором и шардом. Сообщение - заголовок
+// (тип, длина) и тело; чтение и запись дожимаются до конца
+class ShardChannel {
+  private:
+    int fd_ = -1;
+    size_t bytesSent_ = 0;
+    size_t bytesReceived_ = 0;
+
+    void writeAll(const void* data, size_t size);
+    void readAll(void* data, size_t size);
+
+  public:
+    ShardChannel() = default;
+    explicit ShardChannel(int fd): fd_(fd) {}
+    ~ShardChannel();
+
+    ShardChannel(ShardChannel&& other) noexcept;
+    ShardChannel& operator=(ShardChannel&& other) noexcept;
+    ShardChannel(const ShardChannel&) = delete;
+    ShardChannel& operator=(const ShardChannel&) = delete;
+
+    // Пара связанных концов: первый остается у координатора
+    static void makePair(ShardChannel& coordinator, ShardChannel& shard);
+
+    void send(ShardMessage type, const MessageBuffer& body);
+    ShardMessage receive(MessageBuffer& body);
+    void close();
+
+    size_t getBytesSent() const { return bytesSent_; }
+    size_t getBytesReceived() const { return bytesReceived_; }
+};
+
+#endif
@@ -0,0 +1,73 @@
+#ifndef SHARD_COORDINATOR_HPP
+#define SHARD_COORDINATOR_HPP
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <sys/types.h>
+#include "./dungeon_master.hpp"
+#include "./arena_shard.hpp"
+#include "./shard_channel.hpp"
+
+// Распределенная арена: мир делится на полосы строк сетки боев, каждую
+// ведет свой процесс (ArenaShard), связь - пары Unix-сокетов. Тик идет
+// в режиме lockstep, раунд за раундом для всех шардов сразу:
+//   движение -> мигранты -> ореолы -> пограничные метки -> бои -> смерти.
+// Отложенные пограничные бои координатор разрешает сам в порядке пар,
+// поэтому итог совпадает с однопроцессной симуляцией при любом числе шардов.
+// Процессы запускаются fork() после создания мира и получают его копию;
+// в мир (DungeonMaster) состояния возвращает collect().
+class ShardCoordinator {
+  public:
+    struct Stats {
+      size_t shards;
+      size_t migrants;          // переходы между шардами за последний тик
+      size_t haloCreatures;     // копии в ореолах за последний тик
+      size_t deferredCombats;   // пограничные бои последнего тика
+      size_t pairTests;
+      size_t bytesSent;         // всего за время работы
+      size_t bytesReceived;
+    };
+
+  private:
+    DungeonMaster& world_;
+    ShardLayout layout_;
+    std::vector<ShardChannel> channels_;
+    std::vector<pid_t> processes_;
+
+    // Копия мира для пограничных боев и журнала: обновляются только
+    // участники боев
+    CreatureStore creatures_;
+    SpatialGrid grid_;
+    uint64_t seed_ = 0;
+    uint64_t tick_ = 0;
+    DungeonMaster::GameStats stats_{0, 0, 0, 0, 0};
+    Stats shardStats_{0, 0, 0, 0, 0, 0, 0};
+
+    std::vector<MessageBuffer> requests_;
+    std::vector<MessageBuffer> replies_;
+
+    // Запросы всем шардам, затем ответы всех шардов
+    void exchange(ShardMessage type);
+    void clearRequests();
+    void stop();
+
+  public:
+    // 2 <= shards <= числа строк сетки боев. Процесс в момент вызова
+    // однопоточный: мир без рабочих потоков (setWorkerThreads(1))
+    ShardCoordinator(DungeonMaster& world, size_t shards);
+    ~ShardCoordinator();
+
+    ShardCoordinator(const ShardCoordinator&) = delete;
+    ShardCoordinator& operator=(const ShardCoordinator&) = delete;
+
+    void runTick();
+    // Перенос существ из шардов в мир (перед сохранением и выводом)
+    void collect();
+
+    DungeonMaster::GameStats getStats() const { return stats_; }
+    Stats getShardStats() const;
+    uint64_t getTick() const { return tick_; }
+};
+
+#endif
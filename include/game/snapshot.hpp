@@ -0,0 +1,83 @@
+#ifndef SNAPSHOT_HPP
+#define SNAPSHOT_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include "./creature_store.hpp"
+
+// Двоичный снимок мира:
+//   [SnapshotHeader][SnapshotCreature x N][таблица имен]
+// Записи фиксированной ширины читаются прямо из отображенного в память
+// файла без разбора; целостность проверяется контрольной суммой.
+namespace Snapshot {
+  constexpr char MAGIC[8] = {'B', 'A', 'L', 'S', 'N', 'A', 'P', '\0'};
+  constexpr uint32_t VERSION = 1;
+  
+  struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t headerSize;
+    uint64_t creatureCount;
+    uint64_t recordsOffset;
+    uint64_t namesOffset;
+    uint64_t namesSize;
+    uint64_t seed;
+    uint64_t tick;
+    uint64_t checksum;        // по записям и таблице имен
+  };
+  
+  struct Creature {
+    double x;
+    double y;
+    float moveDistance;
+    float attackRange;
+    uint32_t nameOffset;
+    uint32_t nameLength;
+    uint8_t type;
+    uint8_t alive;
+    uint8_t reserved[6];
+  };
+  
+  static_assert(sizeof(Header) == 72, "Формат заголовка снимка изменился");
+  static_assert(sizeof(Creature) == 40, "Формат записи снимка изменился");
+  
+  uint64_t checksum(const void* data, size_t size, uint64_t seed = 0);
+  bool looksLikeSnapshot(const std::string& fileName);
+  
+  // Снимок целиком в памяти (опорные кадры повторов)
+  std::string encode(const CreatureStore& store, uint64_t seed, uint64_t tick);
+  void write(const std::string& fileName, const CreatureStore& store,
+             uint64_t seed, uint64_t tick);
+  
+  // Снимок, отображенный в память только для чтения, или чужой буфер
+  class View {
+    private:
+      void* mapping_ = nullptr;
+      size_t size_ = 0;
+      const char* base_ = nullptr;
+      const Header* header_ = nullptr;
+      const Creature* creatures_ = nullptr;
+      const char* names_ = nullptr;
+      
+      void validate(const std::string& fileName) const;
+      void attach(const std::string& source);
+      
+    public:
+      explicit View(const std::string& fileName);
+      // Буфер не копируется и должен пережить View; source - для сообщений
+      View(const char* data, size_t size, const std::string& source);
+      ~View();
+      
+      View(const View&) = delete;
+      View& operator=(const View&) = delete;
+      
+      const Header& header() const { return *header_; }
+      size_t size() const { return header_->creatureCount; }
+      const Creature& creature(size_t index) const { return creatures_[index]; }
+      std::string_view name(size_t index) const;
+  };
+}
+
+#endif
@@ -0,0 +1,96 @@
+#ifndef SPATIAL_GRID_HPP
+#define SPATIAL_GRID_HPP
+
+#include <vector>
+#include <atomic>
+#include <cstddef>
+#include "./arena_settings.hpp"
+
+// Равномерная сетка для поиска соседей: размер ячейки не меньше
+// максимальной дальности атаки, поэтому любой возможный бой происходит
+// внутри ячейки или между соседними ячейками.
+// Синхронизация лежит на владельце (DungeonMaster::creatureMutex_);
+// тайлы (TileMap) меняют непересекающиеся ячейки параллельно, поэтому
+// счетчик существ атомарный.
+class SpatialGrid {
+  private:
+    static constexpr int NOT_INDEXED = -1;
+
+    double cellSize_;
+    double originX_;
+    double originY_;
+    int columns_;
+    int rows_;
+    std::vector<std::vector<size_t>> cells_;
+    std::vector<int> cellOf_;      // ячейка существа или NOT_INDEXED
+    std::vector<size_t> slotOf_;   // позиция существа внутри ячейки
+    std::atomic<size_t> indexed_{0};
+
+    void detach(size_t id);
+    void attach(size_t id, int cell);
+
+  public:
+    // Ячейка - наибольшая дальность атаки, мир - из настроек процесса
+    SpatialGrid();
+    explicit SpatialGrid(double cellSize, const WorldBounds& bounds = arenaSettings().world);
+
+    // Число ячеек вдоль стороны мира длиной extent (не меньше одной);
+    // сетка больше ArenaConfig::Sharding::MAX_GRID_CELLS - std::length_error
+    static int cellsAcross(double extent, double cellSize);
+    static size_t cellCount(const WorldBounds& bounds, double cellSize);
+
+    void insert(size_t id, double x, double y);
+    void relocate(size_t id, double x, double y);
+    void remove(size_t id);
+    void clear();
+
+    int cellIndex(double x, double y) const;
+    int cellOf(size_t id) const;
+    bool contains(size_t id) const;
+    size_t size() const { return indexed_.load(std::memory_order_relaxed); }
+    double getCellSize() const { return cellSize_; }
+    int getColumns() const { return columns_; }
+    int getRows() const { return rows_; }
+    const std::vector<size_t>& cell(int index) const { return cells_[index]; }
+
+    // Пары существ из одной или соседних ячеек блоками: для каждой непустой
+    // ячейки передает список "ячейка, затем соседние ячейки" и число своих
+    // существ в начале.
+    // Существо block[h] (h < homeCount) образует пары со всем хвостом block[h+1..]
+    template <typename BlockVisitor>
+    void forEachCellBlock(BlockVisitor&& visit) const;
+    // То же для ячеек строк [rowBegin, rowEnd); соседи могут быть ниже rowEnd
+    template <typename BlockVisitor>
+    void forEachCellBlock(int rowBegin, int rowEnd, BlockVisitor&& visit) const;
+};
+
+template <typename BlockVisitor>
+void SpatialGrid::forEachCellBlock(BlockVisitor&& visit) const {
+  forEachCellBlock(0, rows_, visit);
+}
+
+template <typename BlockVisitor>
+void SpatialGrid::forEachCellBlock(int rowBegin, int rowEnd, BlockVisitor&& visit) const {
+  static constexpr int forward[4][2] = {{1, 0}, {-1, 1}, {0, 1}, {1, 1}};
+  std::vector<size_t> block;
+
+  for (int row = rowBegin; row < rowEnd; ++row) {
+    for (int col = 0; col < columns_; ++col) {
+      const auto& cell = cells_[row * columns_ + col];
+      if (cell.empty()) continue;
+
+      block.assign(cell.begin(), cell.end());
+      for (const auto& offset : forward) {
+        const int nCol = col + offset[0];
+        const int nRow = row + offset[1];
+        if (nCol < 0 || nCol >= columns_ || nRow >= rows_) continue;
+
+        const auto& neighbour = cells_[nRow * columns_ + nCol];
+        block.insert(block.end(), neighbour.begin(), neighbour.end());
+      }
+      visit(block, cell.size());
+    }
+  }
+}
+
+#endif
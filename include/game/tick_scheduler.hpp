@@ -0,0 +1,92 @@
+#ifndef TICK_SCHEDULER_HPP
+#define TICK_SCHEDULER_HPP
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstddef>
+#include "./worker_pool.hpp"
+#include "./metrics.hpp"
+
+// Планировщик тиков с фиксированным шагом. Тик - граф фаз: фаза
+// запускается, когда завершены все фазы, от которых она зависит;
+// независимые фазы одного уровня идут параллельно в пуле потоков
+// (общем с фазами, если задан setWorkerPool). Время каждой фазы замеряется.
+class TickScheduler {
+  public:
+    using PhaseId = size_t;
+
+    struct PhaseTiming {
+      std::string name;
+      double lastSeconds;
+      double totalSeconds;
+      double maxSeconds;
+      size_t runs;
+    };
+
+  private:
+    struct Phase {
+      std::string name;
+      std::function<void()> body;
+      std::vector<PhaseId> after;
+      size_t level;
+      PhaseTiming timing;
+    };
+
+    std::vector<Phase> phases_;
+    std::vector<std::vector<PhaseId>> levels_;
+    std::shared_ptr<WorkerPool> pool_;
+
+    // Темп: 0 тиков/с - без пауз
+    double tickRate_ = 0;
+    std::chrono::steady_clock::duration period_{0};
+    std::chrono::steady_clock::time_point nextTick_;
+    bool paced_ = false;
+
+    size_t ticks_ = 0;
+    size_t overruns_ = 0;
+    double tickSeconds_ = 0;
+    LatencyHistogram* tickLatency_ = nullptr;
+
+    void runPhase(Phase& phase);
+    void runLevel(const std::vector<PhaseId>& level);
+
+  public:
+    explicit TickScheduler(double ticksPerSecond = 0);
+
+    TickScheduler(const TickScheduler&) = delete;
+    TickScheduler& operator=(const TickScheduler&) = delete;
+
+    // Зависимости - ранее добавленные фазы, поэтому граф всегда без циклов
+    PhaseId addPhase(const std::string& name, std::function<void()> body,
+                     const std::vector<PhaseId>& after = {});
+
+    // Фазы могут сами вызывать parallelFor того же пула
+    void setWorkerPool(std::shared_ptr<WorkerPool> pool);
+    
+    void setTickRate(double ticksPerSecond);
+    double getTickRate() const { return tickRate_; }
+
+    // Полная длительность каждого тика (nullptr - не писать)
+    void setTickLatency(LatencyHistogram* histogram) { tickLatency_ = histogram; }
+
+    // Один тик графа без ожидания
+    void runTick();
+
+    // Ждет начала следующего шага. Отставание больше шага не догоняется:
+    // расписание сдвигается, а тик считается просроченным
+    void waitForNextTick();
+
+    // Тики в заданном темпе, пока keepRunning() (проверяется перед тиком)
+    size_t run(size_t ticks, const std::function<bool()>& keepRunning = nullptr);
+
+    size_t getTickCount() const { return ticks_; }
+    size_t getOverruns() const { return overruns_; }
+    double getTotalTickSeconds() const { return tickSeconds_; }
+    size_t getMaxConcurrency() const;
+    std::vector<PhaseTiming> getTimings() const;
+};
+
+#endif
@@ -0,0 +1,128 @@
+#ifndef TILE_MAP_HPP
+#define TILE_MAP_HPP
+
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+#include "./creature_store.hpp"
+#include "./spatial_grid.hpp"
+#include "./range_kernel.hpp"
+#include "./combat_queue.hpp"
+#include "./combat_visitor.hpp"
+#include "./combat_components.hpp"
+#include "./worker_pool.hpp"
+
+// Разбиение мира на прямоугольные тайлы из ячеек SpatialGrid. Каждый тайл
+// обрабатывается одной задачей пула и меняет только свои ячейки и своих
+// существ, поэтому внутри фаз блокировок нет:
+//  - движение: существо, ушедшее в чужой тайл, снимается с сетки и
+//    кладется в почтовый ящик получателя (отдельный слот на отправителя);
+//  - доставка: получатель ставит мигрантов в свои ячейки;
+//  - поиск боев: соседние ячейки чужих тайлов (ячейка не меньше дальности
+//    атаки, так что это ровно ореол досягаемости) копируются в ореол тайла;
+//  - бои: пары внутри тайла разрешаются локально; пары с существом
+//    ореола и все бои, связанные с ними общими участниками, откладываются
+//    и разрешаются после всех тайлов в порядке пар.
+// Итог совпадает с последовательным разрешением всех пар по порядку при
+// любом разбиении и любом числе потоков.
+// Синхронизация между фазами лежит на владельце (DungeonMaster::creatureMutex_).
+class TileMap {
+  public:
+    struct Battle {
+      CombatPair pair;
+      BattleOutcome outcome;
+    };
+
+    struct Stats {
+      size_t tiles;
+      size_t migrants;         // переходы между тайлами за последнее движение
+      size_t haloCreatures;    // копии в ореолах при последнем поиске
+      size_t deferredCombats;  // пограничные бои последнего тика
+    };
+
+  private:
+    struct alignas(64) Tile {
+      int colBegin;
+      int colEnd;
+      int rowBegin;
+      int rowEnd;
+
+      // Мигранты и метки пограничных существ по номеру тайла-отправителя
+      std::vector<std::vector<size_t>> inbox;
+      std::vector<std::vector<size_t>> borderInbox;
+
+      // Ореол: ячейки чужих тайлов справа, снизу и слева-снизу
+      std::vector<int> haloSlotOf;   // локальная ячейка рамки -> слот или -1
+      std::vector<int> haloCells;    // слот -> ячейка сетки
+      std::vector<size_t> haloStart; // слот -> начало в halo/haloIds
+      CandidateBlock halo;
+      std::vector<size_t> haloIds;
+
+      // Пары боев: обе стороны свои / одна сторона из ореола
+      std::vector<CombatPair> pairs;
+      std::vector<CombatPair> crossPairs;
+      std::vector<CombatPair> deferred;
+      std::vector<Battle> battles;
+
+      // Рабочие буферы
+      std::vector<size_t> residents;
+      std::vector<size_t> block;
+      std::vector<uint8_t> remote;
+      std::vector<uint8_t> hits;
+      CandidateBlock packed;
+
+      size_t migrants = 0;
+      size_t pairTests = 0;
+    };
+
+    std::vector<std::unique_ptr<Tile>> tiles_;
+    std::vector<uint32_t> tileOfCell_;
+    size_t columns_ = 0;
+    size_t rows_ = 0;
+    int gridColumns_ = 0;
+
+    // По существам; каждую запись меняет только тайл-владелец
+    CombatComponents components_;
+
+    std::vector<CombatPair> deferred_;
+    std::vector<Battle> deferredBattles_;
+    Stats stats_{0, 0, 0, 0};
+
+    int haloSlot(const Tile& tile, int col, int row) const;
+    void moveTile(size_t index, CreatureStore& creatures, SpatialGrid& grid,
+                  uint64_t seed, uint64_t tick);
+    void deliverTile(Tile& tile, const CreatureStore& creatures, SpatialGrid& grid);
+    void exchangeHalo(Tile& tile, const CreatureStore& creatures, const SpatialGrid& grid);
+    void detectTile(Tile& tile, const CreatureStore& creatures, const SpatialGrid& grid);
+    void markBorder(size_t index, const SpatialGrid& grid);
+    void resolveTile(Tile& tile, CreatureStore& creatures, const CombatMediator& mediator);
+
+  public:
+    TileMap() = default;
+
+    TileMap(const TileMap&) = delete;
+    TileMap& operator=(const TileMap&) = delete;
+
+    // columns x rows тайлов на сетке grid; 0 - разбиение выключено
+    void configure(const SpatialGrid& grid, size_t columns, size_t rows);
+    bool enabled() const { return !tiles_.empty(); }
+    size_t getColumns() const { return columns_; }
+    size_t getRows() const { return rows_; }
+
+    // Движение всех живых существ сетки с отправкой мигрантов
+    void move(CreatureStore& creatures, SpatialGrid& grid, WorkerPool& pool,
+              uint64_t seed, uint64_t tick);
+    // Постановка мигрантов в ячейки получателей
+    void deliver(const CreatureStore& creatures, SpatialGrid& grid, WorkerPool& pool);
+    // Обмен ореолами и поиск пар; возвращает число проверенных пар
+    size_t detect(const CreatureStore& creatures, const SpatialGrid& grid, WorkerPool& pool);
+    // Разрешение найденных пар. battles - все бои тика в порядке пар;
+    // возвращает число отложенных пограничных боев
+    size_t resolve(CreatureStore& creatures, const SpatialGrid& grid, WorkerPool& pool,
+                   const CombatMediator& mediator, std::vector<Battle>& battles);
+
+    Stats getStats() const { return stats_; }
+};
+
+#endif
@@ -0,0 +1,125 @@
+#ifndef TRACE_HPP
+#define TRACE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+// Трасса для chrome://tracing и Perfetto (JSON Trace Event, события "X").
+// Каждый поток пишет в свой буфер без блокировок; буфер фиксированного
+// размера, события сверх него отбрасываются и считаются. Пишутся только
+// тики окна [firstTick, lastTick] (номера тиков TickScheduler с нуля).
+// Активный регистратор один на процесс; без него TraceScope - одно
+// чтение атомика
+class TraceRecorder {
+  public:
+    struct Event {
+      const char* name;       // литерал или intern()
+      const char* category;
+      uint64_t start;         // нс от создания регистратора
+      uint64_t duration;
+      uint64_t tick;
+    };
+
+  private:
+    struct ThreadBuffer {
+      std::unique_ptr<Event[]> events;
+      std::atomic<size_t> size{0};
+      std::atomic<size_t> dropped{0};
+      size_t threadId = 0;
+      std::string threadName;
+    };
+
+    static std::atomic<TraceRecorder*> active_;
+    static std::atomic<uint64_t> generations_;
+
+    std::string fileName_;
+    uint64_t firstTick_;
+    uint64_t lastTick_;
+    size_t capacity_;
+    uint64_t generation_;
+    std::chrono::steady_clock::time_point origin_;
+
+    std::atomic<bool> recording_;
+    std::atomic<uint64_t> tick_{0};
+
+    // Буферы и имена живут, пока жив регистратор (адреса стабильны)
+    mutable std::mutex buffersMutex_;
+    std::deque<ThreadBuffer> buffers_;
+    std::set<std::string> names_;
+    bool finished_ = false;
+
+    ThreadBuffer& threadBuffer();
+    size_t getDroppedEventsLocked() const;
+
+  public:
+    // Становится активным сразу; второй активный регистратор - ошибка.
+    // Должен пережить трассируемые потоки (пулы, задачи сессии)
+    TraceRecorder(const std::string& fileName, uint64_t firstTick, uint64_t lastTick,
+                  size_t eventsPerThread);
+    ~TraceRecorder();
+
+    TraceRecorder(const TraceRecorder&) = delete;
+    TraceRecorder& operator=(const TraceRecorder&) = delete;
+
+    static TraceRecorder* active() { return active_.load(std::memory_order_acquire); }
+    // Начало тика: запись включается только внутри окна
+    static void beginTick(uint64_t tick);
+    // Имя потока в трассе; задается до первого события потока
+    static void setThreadName(const std::string& name);
+    // Для дочернего процесса после fork(): копия регистратора не пишет
+    // ничего, файл остается за родителем
+    static void detachProcess() { active_.store(nullptr, std::memory_order_release); }
+
+    bool recording() const { return recording_.load(std::memory_order_relaxed); }
+    uint64_t now() const {
+      return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now() - origin_).count());
+    }
+    void record(const char* name, const char* category, uint64_t start, uint64_t finish);
+    // Постоянная копия имени для событий с именами времени выполнения
+    const char* intern(const std::string& name);
+
+    // Отключает запись и пишет файл (повторный вызов ничего не делает)
+    void finish();
+
+    size_t getEventCount() const;
+    size_t getDroppedEvents() const;
+    const std::string& getFileName() const { return fileName_; }
+};
+
+// Событие на время области. Запись решается при входе: область, начатая
+// вне окна тиков или без регистратора, ничего не пишет
+class TraceScope {
+  private:
+    TraceRecorder* recorder_;
+    const char* name_;
+    const char* category_;
+    uint64_t start_ = 0;
+
+  public:
+    TraceScope(const char* name, const char* category)
+        : recorder_(TraceRecorder::active()), name_(name), category_(category) {
+      if (recorder_ != nullptr && recorder_->recording()) {
+        start_ = recorder_->now();
+      } else {
+        recorder_ = nullptr;
+      }
+    }
+    ~TraceScope() {
+      if (recorder_ != nullptr) {
+        recorder_->record(name_, category_, start_, recorder_->now());
+      }
+    }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+};
+
+#endif
@@ -0,0 +1,186 @@
+#ifndef TRAJECTORY_HPP
+#define TRAJECTORY_HPP
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "./creature_store.hpp"
+
+// Запись траекторий по тикам:
+//   [Header][Chunk]...[IndexEntry x chunkCount][Footer]
+// Координаты квантуются шагом quantum от угла мира. Кусок (Chunk) - до
+// ticksPerChunk тиков, первый тик куска - опорный (абсолютные значения),
+// остальные - разности с предыдущим тиком. Внутри тика данные лежат
+// столбцами: смены флага жизни, все x, все y. Целые - zigzag varint.
+// Индекс в конце файла дает переход к любому тику без чтения предыдущих
+// кусков.
+namespace Trajectory {
+  constexpr char MAGIC[8] = {'B', 'A', 'L', 'T', 'R', 'A', 'J', '\0'};
+  constexpr char FOOTER_MAGIC[8] = {'B', 'A', 'L', 'T', 'I', 'D', 'X', '\0'};
+  constexpr uint32_t VERSION = 1;
+
+  struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t headerSize;
+    double originX;
+    double originY;
+    double quantum;
+    uint64_t seed;
+    uint64_t ticksPerChunk;
+  };
+
+  struct ChunkHeader {
+    uint64_t firstTick;
+    uint64_t lastTick;
+    uint32_t tickCount;
+    uint32_t reserved;
+    uint64_t payloadSize;
+    uint64_t checksum;        // по данным куска
+  };
+
+  struct IndexEntry {
+    uint64_t firstTick;
+    uint64_t lastTick;
+    uint64_t offset;          // начало ChunkHeader
+  };
+
+  struct Footer {
+    uint64_t indexOffset;
+    uint64_t chunkCount;
+    char magic[8];
+  };
+
+  static_assert(sizeof(Header) == 56, "Формат заголовка траекторий изменился");
+  static_assert(sizeof(ChunkHeader) == 40, "Формат куска траекторий изменился");
+  static_assert(sizeof(IndexEntry) == 24, "Формат индекса траекторий изменился");
+  static_assert(sizeof(Footer) == 24, "Формат конца траекторий изменился");
+
+  // Один тик в квантованных координатах
+  struct Frame {
+    uint64_t tick = 0;
+    std::vector<int64_t> x;
+    std::vector<int64_t> y;
+    std::vector<uint8_t> alive;
+
+    size_t size() const { return x.size(); }
+  };
+
+  struct WriterOptions {
+    double quantum;
+    size_t ticksPerChunk;
+    // Захваченных тиков в очереди к писателю; при переполнении capture() ждет
+    size_t bufferedTicks;
+  };
+
+  // Потоковая запись. capture() только квантует столбцы хранилища в
+  // свободный буфер; разности, кодирование и запись делает фоновый поток.
+  // Мертвые существа, не сменившие флаг, в тиках не пишутся - если такое
+  // все же сдвинулось, тик становится опорным
+  class Writer {
+    public:
+      struct Stats {
+        uint64_t ticks;
+        uint64_t chunks;
+        uint64_t bytes;           // записано в файл
+        uint64_t rawBytes;        // те же тики без сжатия (x, y - double, флаг - байт)
+        uint64_t stalls;          // capture() ждал свободный буфер
+      };
+
+    private:
+      std::ofstream out_;
+      Header header_;
+      WriterOptions options_;
+
+      // Буферы тиков: свободные -> очередь -> писатель -> свободные
+      std::vector<Frame> frames_;
+      std::vector<size_t> free_;
+      std::deque<size_t> ready_;
+      std::mutex queueMutex_;
+      std::condition_variable queueChanged_;
+      bool closing_ = false;
+      bool captured_ = false;
+      uint64_t lastTick_ = 0;
+      uint64_t stalls_ = 0;
+      std::exception_ptr failure_;
+      std::thread writer_;
+
+      // Состояние писателя (только фоновый поток)
+      Frame previous_;
+      bool hasPrevious_ = false;
+      std::string chunk_;
+      ChunkHeader chunkHeader_{};
+      std::vector<IndexEntry> index_;
+      Stats stats_{0, 0, 0, 0, 0};
+      bool closed_ = false;
+
+      void writerLoop();
+      // Разности с предыдущим тиком невозможны - тик пишется опорным
+      bool needsKeyframe(const Frame& frame) const;
+      void encode(const Frame& frame);
+      void flushChunk();
+
+    public:
+      Writer(const std::string& fileName, const WorldBounds& world, uint64_t seed,
+             const WriterOptions& options);
+      // Закрывает файл, если close() не вызывали (ошибки при этом теряются)
+      ~Writer();
+
+      Writer(const Writer&) = delete;
+      Writer& operator=(const Writer&) = delete;
+
+      // Тики идут по возрастанию; число существ может расти (появление)
+      void capture(const CreatureStore& creatures, uint64_t tick);
+      // Дописывает последний кусок, индекс и конец файла
+      void close();
+
+      // После close()
+      Stats getStats() const;
+  };
+
+  // Чтение с произвольным доступом: файл отображается в память, нужный
+  // кусок находится по индексу и раскодируется от опорного тика
+  class Reader {
+    private:
+      void* mapping_ = nullptr;
+      size_t size_ = 0;
+      const Header* header_ = nullptr;
+      const IndexEntry* index_ = nullptr;
+      size_t chunkCount_ = 0;
+
+      void validate(const std::string& fileName) const;
+      // Тики куска по порядку, пока visit возвращает true
+      void decodeChunk(size_t chunk, const std::function<bool(const Frame&)>& visit) const;
+
+    public:
+      explicit Reader(const std::string& fileName);
+      ~Reader();
+
+      Reader(const Reader&) = delete;
+      Reader& operator=(const Reader&) = delete;
+
+      const Header& header() const { return *header_; }
+      size_t chunkCount() const { return chunkCount_; }
+      bool empty() const { return chunkCount_ == 0; }
+      uint64_t firstTick() const;
+      uint64_t lastTick() const;
+
+      // Бросает out_of_range, если тика нет в записи
+      Frame frame(uint64_t tick) const;
+      // Все записанные тики из [first, last] по порядку
+      void scan(uint64_t first, uint64_t last, const std::function<void(const Frame&)>& visit) const;
+
+      double worldX(int64_t x) const { return header_->originX + static_cast<double>(x) * header_->quantum; }
+      double worldY(int64_t y) const { return header_->originY + static_cast<double>(y) * header_->quantum; }
+  };
+}
+
+#endif
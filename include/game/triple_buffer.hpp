@@ -0,0 +1,47 @@
+#ifndef TRIPLE_BUFFER_HPP
+#define TRIPLE_BUFFER_HPP
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+// Тройной буфер: писатель заполняет задний слот и публикует его обменом
+// с промежуточным, читатель забирает промежуточный обменом с передним.
+// Ни одна сторона не ждет другую; писатель и читатель - по одному.
+template <typename T>
+class TripleBuffer {
+  private:
+    static constexpr uint8_t INDEX_MASK = 0x3;
+    static constexpr uint8_t FRESH = 0x4;    // в промежуточном слоте новые данные
+
+    std::array<T, 3> slots_;
+    alignas(64) std::atomic<uint8_t> middle_{2};
+    alignas(64) uint8_t back_ = 0;           // принадлежит писателю
+    alignas(64) uint8_t front_ = 1;          // принадлежит читателю
+
+  public:
+    TripleBuffer() = default;
+
+    TripleBuffer(const TripleBuffer&) = delete;
+    TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+    // Сторона писателя
+    T& back() { return slots_[back_]; }
+
+    void publish() {
+      back_ = middle_.exchange(static_cast<uint8_t>(back_ | FRESH), std::memory_order_acq_rel) & INDEX_MASK;
+    }
+
+    // Сторона читателя: true, если передний слот сменился на свежий
+    bool update() {
+      if ((middle_.load(std::memory_order_relaxed) & FRESH) == 0) {
+        return false;
+      }
+      front_ = middle_.exchange(front_, std::memory_order_acq_rel) & INDEX_MASK;
+      return true;
+    }
+
+    const T& front() const { return slots_[front_]; }
+};
+
+#endif
@@ -0,0 +1,112 @@
+#ifndef WORKER_POOL_HPP
+#define WORKER_POOL_HPP
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <exception>
+#include <condition_variable>
+#include <chrono>
+#include <algorithm>
+#include <type_traits>
+#include <cstddef>
+
+// Пул потоков с перехватом работы. У каждого работника своя дека задач:
+// владелец берет с конца, свободные работники крадут с начала (самые
+// крупные куски). parallelFor кладет весь диапазон одной задачей, а
+// исполнитель делит ее пополам, пока кусок больше зерна, - неравномерная
+// нагрузка сама расходится по ядрам.
+//
+// Номер работника 0 - вызывающий поток вне пула, 1..size()-1 - потоки
+// пула; внутри одного parallelFor номера исполнителей не совпадают.
+// Ожидающий parallelFor помогает только своей работе, поэтому вызывать
+// его можно из задач пула и под блокировками.
+class WorkerPool {
+  private:
+    struct RangeJob {
+      void (*invoke)(void* body, size_t worker, size_t begin, size_t end);
+      void* body;
+      size_t grain;
+      std::atomic<size_t> remaining;
+      std::mutex failureMutex;
+      std::exception_ptr failure;
+    };
+
+    struct Task {
+      RangeJob* job;
+      size_t begin;
+      size_t end;
+    };
+
+    struct alignas(64) Slot {
+      std::mutex mutex;
+      std::deque<Task> tasks;
+    };
+
+    std::vector<std::unique_ptr<Slot>> slots_;
+    std::vector<std::thread> threads_;
+
+    // Засыпание свободных работников и ожидающих владельцев
+    std::mutex wakeMutex_;
+    std::condition_variable wakeUp_;
+    std::atomic<size_t> queuedTasks_{0};
+    bool stopping_ = false;
+
+    std::atomic<size_t> steals_{0};
+    
+    static constexpr std::chrono::microseconds OWNER_RECHECK{200};
+
+    void workerLoop(size_t worker);
+    size_t currentSlot() const;
+    void pushTask(size_t slot, const Task& task);
+    bool popOwn(size_t slot, RangeJob* job, Task& task);
+    bool steal(size_t thief, RangeJob* job, Task& task);
+    void execute(size_t slot, Task task);
+    void finish(RangeJob& job, size_t items);
+    void runJob(RangeJob& job, size_t count);
+
+  public:
+    // 0 - по числу ядер
+    explicit WorkerPool(size_t workers = 0);
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    static size_t hardwareWorkers();
+
+    size_t size() const { return threads_.size() + 1; }
+    size_t getSteals() const { return steals_.load(std::memory_order_relaxed); }
+
+    // body(worker, begin, end) для кусков [0, count); grain - наименьший
+    // кусок (0 - подбирается по числу работников). Исключение из тела
+    // передается вызывающему после завершения остальных кусков
+    template <typename RangeBody>
+    void parallelFor(size_t count, RangeBody&& body, size_t grain = 0);
+};
+
+template <typename RangeBody>
+void WorkerPool::parallelFor(size_t count, RangeBody&& body, size_t grain) {
+  if (count == 0) {
+    return;
+  }
+  if (threads_.empty()) {
+    body(0, 0, count);
+    return;
+  }
+
+  using Body = std::remove_reference_t<RangeBody>;
+  RangeJob job;
+  job.invoke = [](void* context, size_t worker, size_t begin, size_t end) {
+    (*static_cast<Body*>(context))(worker, begin, end);
+  };
+  job.body = const_cast<void*>(static_cast<const void*>(&body));
+  job.grain = grain > 0 ? grain : std::max<size_t>(1, count / (size() * 8));
+  job.remaining.store(count, std::memory_order_relaxed);
+  runJob(job, count);
+}
+
+#endif
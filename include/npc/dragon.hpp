@@ -8,6 +8,8 @@ class Dragon: public NPC {
     Dragon();
     Dragon(double x, double y, const std::string &name);
     Dragon(double x, double y);
+    // Представление строки общего хранилища (рои и арены)
+    Dragon(std::shared_ptr<CreatureStore> owner, size_t slot);
     
     // Специфичные для дракона методы
     std::string getColor() const;
@@ -8,6 +8,8 @@ class Elf: public NPC {
     Elf();
     Elf(double x, double y, const std::string &name);
     Elf(double x, double y);
+    // Представление строки общего хранилища (рои и арены)
+    Elf(std::shared_ptr<CreatureStore> owner, size_t slot);
     
     // Специфичные для эльфа методы
     std::string getClan() const;
@@ -8,6 +8,8 @@ class Knight: public NPC {
     Knight();
     Knight(double x, double y, const std::string &name);
     Knight(double x, double y);
+    // Представление строки общего хранилища (рои и арены)
+    Knight(std::shared_ptr<CreatureStore> owner, size_t slot);
     
     // Специфичные для рыцаря методы
     std::string getTitle() const;
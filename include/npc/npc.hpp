@@ -2,12 +2,17 @@
 #define NPC_HPP
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <memory>
 #include <iostream>
 #include <fstream>
-#include <shared_mutex>
-#include <mutex>
+#include <array>
+#include <cstdint>
+#include <cstddef>
+#include "../game/name_table.hpp"
+
+class CreatureStore;
 
 enum NPCType {
   UNKNOWN = 0,
@@ -23,25 +28,28 @@ enum MoveDirection {
   LEFT
 };
 
+// Легкое представление строки CreatureStore. Отдельно созданное существо
+// владеет собственным хранилищем из одной строки; существа DungeonMaster
+// живут в общем хранилище, синхронизацию обеспечивает его владелец.
 class NPC {
   protected:
-    NPCType type_;
-    double x_ = 0;
-    double y_ = 0;
-    std::string name_ = "";
-    bool alive_ = true;
-    double moveDistance_ = 1.0;
-    double attackRange_ = 1.0;
-    
-    // Синхронизация для многопоточности
-    mutable std::shared_mutex positionMutex_;
-    mutable std::mutex stateMutex_;
+    std::shared_ptr<CreatureStore> owner_;
+    CreatureStore* store_ = nullptr;
+    size_t slot_ = 0;
     
   public:
     NPC();
     NPC(NPCType type);
     NPC(NPCType type, double x, double y, const std::string &name, 
         double moveDistance, double attackRange);
+    NPC(CreatureStore &store, size_t slot);
+    NPC(std::shared_ptr<CreatureStore> owner, size_t slot);
+
+    // Объекты NPC и наследников выделяются из CreaturePool
+    static void *operator new(size_t size);
+    static void operator delete(void *pointer, size_t size);
+
+    size_t getSlot() const;
 
     NPCType getType() const;
     std::string getTypeString() const;
@@ -49,6 +57,9 @@ class NPC {
     double getY() const;
     std::pair<double, double> getPosition() const;
     std::string getName() const;
+    // Без копирования: id в таблице имен и текст из нее
+    NameId getNameId() const;
+    std::string_view getNameView() const;
     bool isAlive() const;
     double getMoveDistance() const;
     double getAttackRange() const;
@@ -76,8 +87,38 @@ class NPC {
 };
 
 NPCType convertTypeFromString(const std::string &type);
+std::string convertTypeToString(NPCType type);
 MoveDirection convertDirectionFromString(const std::string &direction);
 std::string convertDirectionToString(MoveDirection direction);
 std::string generateRandomName(NPCType type);
 
+// Матрица охоты: строка - битовая маска типов, которых может убить
+// нападающий. Новый тип - новая строка
+constexpr size_t NPC_TYPE_COUNT = NPCType::DRAGON + 1;
+
+constexpr uint8_t typeBit(NPCType type) {
+  return static_cast<uint8_t>(1u << type);
+}
+
+constexpr std::array<uint8_t, NPC_TYPE_COUNT> PREY_MASK = {
+  0,                                                              // UNKNOWN
+  typeBit(DRAGON),                                                // KNIGHT
+  typeBit(KNIGHT),                                                // ELF
+  typeBit(UNKNOWN) | typeBit(KNIGHT) | typeBit(ELF) | typeBit(DRAGON)  // DRAGON
+};
+
+constexpr bool canPrey(NPCType attacker, NPCType victim) {
+  return static_cast<size_t>(attacker) < NPC_TYPE_COUNT &&
+         static_cast<size_t>(victim) < NPC_TYPE_COUNT &&
+         ((PREY_MASK[attacker] >> victim) & 1u) != 0;
+}
+
+// Хотя бы один из пары может напасть на другого
+constexpr bool canInteract(NPCType first, NPCType second) {
+  return canPrey(first, second) || canPrey(second, first);
+}
+
+static_assert(!canInteract(ELF, ELF) && !canInteract(KNIGHT, KNIGHT),
+              "Однотипные рыцари и эльфы не сражаются");
+
 #endif
\ No newline at end of file
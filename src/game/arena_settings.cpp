@@ -0,0 +1,200 @@
+#include "../../include/game/arena_settings.hpp"
+#include "../../include/game/spatial_grid.hpp"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <fstream>
+#include <stdexcept>
+
+namespace {
+  // Префиксы ключей по типам существ
+  constexpr std::array<const char*, NPC_TYPE_COUNT> TYPE_KEYS = {"", "knight", "elf", "dragon"};
+
+  ArenaSettings& processSettings() {
+    static ArenaSettings settings;
+    return settings;
+  }
+
+  std::string trim(const std::string& text) {
+    const auto begin = text.find_first_not_of(" \t\r");
+    if (begin == std::string::npos) {
+      return "";
+    }
+    const auto end = text.find_last_not_of(" \t\r");
+    return text.substr(begin, end - begin + 1);
+  }
+
+  // Значение должно быть разобрано целиком: "10км" - ошибка, а не 10;
+  // inf и nan stod принимает, но ни границе, ни дальности они не подходят
+  double parseReal(const std::string& key, const std::string& text) {
+    size_t used = 0;
+    double value = 0;
+    try {
+      value = std::stod(text, &used);
+    } catch (const std::exception&) {
+      used = 0;
+    }
+    if (used == 0 || used != text.size() || !std::isfinite(value)) {
+      throw std::invalid_argument("Параметр " + key + ": ожидалось конечное число, получено '" + text + "'");
+    }
+    return value;
+  }
+
+  long long parseInteger(const std::string& key, const std::string& text) {
+    size_t used = 0;
+    long long value = 0;
+    try {
+      value = std::stoll(text, &used);
+    } catch (const std::exception&) {
+      used = 0;
+    }
+    if (used == 0 || used != text.size()) {
+      throw std::invalid_argument("Параметр " + key + ": ожидалось целое, получено '" + text + "'");
+    }
+    return value;
+  }
+
+  // Поля настроек - int: без проверки 3000000000 стал бы отрицательным
+  int parseInt(const std::string& key, const std::string& text) {
+    const long long value = parseInteger(key, text);
+    if (value < INT_MIN || value > INT_MAX) {
+      throw std::invalid_argument("Параметр " + key + " вне диапазона: " + text);
+    }
+    return static_cast<int>(value);
+  }
+
+  size_t parseCount(const std::string& key, const std::string& text) {
+    const long long value = parseInteger(key, text);
+    if (value < 0) {
+      throw std::invalid_argument("Параметр " + key + " не может быть отрицательным");
+    }
+    return static_cast<size_t>(value);
+  }
+}
+
+ArenaSettings::ArenaSettings() {
+  step[KNIGHT] = ArenaConfig::Mobility::KNIGHT_STEP;
+  step[ELF] = ArenaConfig::Mobility::ELF_STEP;
+  step[DRAGON] = ArenaConfig::Mobility::DRAGON_STEP;
+  range[KNIGHT] = ArenaConfig::Combat::KNIGHT_SWORD_REACH;
+  range[ELF] = ArenaConfig::Combat::ELF_BOW_RANGE;
+  range[DRAGON] = ArenaConfig::Combat::DRAGON_BREATH_RANGE;
+}
+
+void ArenaSettings::set(const std::string& key, const std::string& value) {
+  if (key == "world.min_x") {
+    world.minX = parseReal(key, value);
+  } else if (key == "world.max_x") {
+    world.maxX = parseReal(key, value);
+  } else if (key == "world.min_y") {
+    world.minY = parseReal(key, value);
+  } else if (key == "world.max_y") {
+    world.maxY = parseReal(key, value);
+  } else if (key == "population") {
+    population = parseInt(key, value);
+  } else if (key == "timing.tick_interval") {
+    tickInterval = parseInt(key, value);
+  } else if (key == "timing.display_interval") {
+    displayInterval = parseInt(key, value);
+  } else if (key == "timing.session_duration") {
+    sessionDuration = parseInt(key, value);
+  } else if (key == "timing.log_flush_interval") {
+    logFlushInterval = parseInt(key, value);
+  } else if (key == "threads") {
+    threads = parseCount(key, value);
+  } else if (key == "tiles") {
+    tiles = parseCount(key, value);
+  } else {
+    for (size_t type = KNIGHT; type < NPC_TYPE_COUNT; ++type) {
+      const std::string prefix = std::string(TYPE_KEYS[type]) + ".";
+      if (key == prefix + "step") {
+        step[type] = parseReal(key, value);
+        return;
+      }
+      if (key == prefix + "range") {
+        range[type] = parseReal(key, value);
+        return;
+      }
+    }
+    throw std::invalid_argument("Неизвестный параметр настроек: " + key);
+  }
+}
+
+void ArenaSettings::set(const std::string& assignment) {
+  const auto equals = assignment.find('=');
+  if (equals == std::string::npos) {
+    throw std::invalid_argument("Ожидалось ключ=значение, получено '" + assignment + "'");
+  }
+  set(trim(assignment.substr(0, equals)), trim(assignment.substr(equals + 1)));
+}
+
+void ArenaSettings::loadFile(const std::string& fileName) {
+  std::ifstream in(fileName);
+  if (!in.is_open()) {
+    throw std::invalid_argument("Не удалось открыть файл настроек '" + fileName + "'");
+  }
+
+  std::string line;
+  for (int number = 1; std::getline(in, line); ++number) {
+    line = trim(line.substr(0, line.find('#')));
+    if (line.empty()) continue;
+
+    try {
+      set(line);
+    } catch (const std::invalid_argument& e) {
+      throw std::invalid_argument(fileName + ":" + std::to_string(number) + ": " + e.what());
+    }
+  }
+}
+
+void ArenaSettings::validate() const {
+  if (!std::isfinite(world.minX) || !std::isfinite(world.maxX) ||
+      !std::isfinite(world.minY) || !std::isfinite(world.maxY)) {
+    throw std::invalid_argument("Границы мира должны быть конечными");
+  }
+  if (!(world.maxX > world.minX) || !(world.maxY > world.minY)) {
+    throw std::invalid_argument("Границы мира пусты");
+  }
+  if (population < 0) {
+    throw std::invalid_argument("Численность не может быть отрицательной");
+  }
+  for (size_t type = KNIGHT; type < NPC_TYPE_COUNT; ++type) {
+    if (!(step[type] >= 0) || !(range[type] > 0) || !std::isfinite(step[type]) || !std::isfinite(range[type])) {
+      throw std::invalid_argument(std::string("Шаг и дальность ") + TYPE_KEYS[type] +
+                                  " должны быть положительными");
+    }
+  }
+  if (tickInterval <= 0 || displayInterval <= 0 || sessionDuration <= 0 || logFlushInterval <= 0) {
+    throw std::invalid_argument("Интервалы должны быть положительными");
+  }
+  // Сетка боев плотная: ее размер ограничен ArenaConfig::Sharding::MAX_GRID_CELLS
+  try {
+    SpatialGrid::cellCount(world, maxAttackRange());
+  } catch (const std::length_error& e) {
+    throw std::invalid_argument(std::string(e.what()) + " (world.* / наибольшая *.range = " +
+                                std::to_string(maxAttackRange()) +
+                                "): уменьшите мир или увеличьте дальности");
+  }
+  // Тайл - не меньше ячейки сетки боев, а ячейка - наибольшая дальность
+  const int columns = SpatialGrid::cellsAcross(world.maxX - world.minX, maxAttackRange());
+  const int rows = SpatialGrid::cellsAcross(world.maxY - world.minY, maxAttackRange());
+  if (tiles > static_cast<size_t>(std::min(columns, rows))) {
+    throw std::invalid_argument("tiles = " + std::to_string(tiles) + " больше сетки боев " +
+                                std::to_string(columns) + " x " + std::to_string(rows) +
+                                " (world.* / наибольшая *.range = " + std::to_string(maxAttackRange()) +
+                                "): уменьшите tiles или дальности, либо увеличьте мир");
+  }
+}
+
+double ArenaSettings::maxAttackRange() const {
+  return *std::max_element(range.begin() + KNIGHT, range.end());
+}
+
+const ArenaSettings& arenaSettings() {
+  return processSettings();
+}
+
+void applyArenaSettings(const ArenaSettings& settings) {
+  settings.validate();
+  processSettings() = settings;
+}
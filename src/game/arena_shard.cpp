@@ -0,0 +1,272 @@
+#include "../../include/game/arena_shard.hpp"
+#include "../../include/game/combat_visitor.hpp"
+#include "../../include/game/random_stream.hpp"
+#include "../../include/game/range_kernel.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+ShardLayout::ShardLayout(const SpatialGrid& grid, size_t shards)
+    : columns(grid.getColumns()) {
+  const int rows = grid.getRows();
+  if (shards == 0 || shards > static_cast<size_t>(rows)) {
+    throw std::invalid_argument("Число шардов должно быть от 1 до числа строк сетки боев");
+  }
+
+  // Полосы почти равной высоты
+  for (size_t k = 0; k <= shards; ++k) {
+    rowBegin.push_back(static_cast<int>(k * rows / shards));
+  }
+  shardOfRow.resize(rows);
+  for (size_t k = 0; k < shards; ++k) {
+    for (int row = rowBegin[k]; row < rowBegin[k + 1]; ++row) {
+      shardOfRow[row] = static_cast<uint32_t>(k);
+    }
+  }
+}
+
+ArenaShard::ArenaShard(const CreatureStore& world, uint64_t seed, uint64_t tick,
+                       size_t shards, size_t index)
+    : layout_(SpatialGrid(), shards),
+      index_(index),
+      rowBegin_(layout_.rowBegin[index]),
+      rowEnd_(layout_.rowBegin[index + 1]),
+      seed_(seed),
+      tick_(tick) {
+  creatures_.copyFrom(world);
+  owned_.assign(creatures_.size(), 0);
+
+  // Погибшие остаются за шардом, в полосе которого лежат
+  for (size_t id = 0; id < creatures_.size(); ++id) {
+    const int cell = grid_.cellIndex(creatures_.x(id), creatures_.y(id));
+    if (layout_.shardOfCell(cell) != index_) continue;
+
+    owned_[id] = 1;
+    if (creatures_.isAlive(id)) {
+      grid_.insert(id, creatures_.x(id), creatures_.y(id));
+    }
+  }
+}
+
+ShardCreature ArenaShard::record(size_t id) const {
+  return ShardCreature{id, creatures_.x(id), creatures_.y(id),
+                       creatures_.isAlive(id) ? 1u : 0u, 0};
+}
+
+void ArenaShard::acceptRecord(const ShardCreature& creature) {
+  // Хранилище без сетки: сетку шард ведет сам
+  creatures_.setPosition(creature.id, creature.x, creature.y, false);
+  creatures_.setAlive(creature.id, creature.alive != 0);
+}
+
+void ArenaShard::moveResidents(MessageBuffer& request, MessageBuffer& reply) {
+  tick_ = request.get<uint64_t>();
+
+  // Сначала список: переезды внутри полосы меняют ячейки
+  residents_.clear();
+  for (int cell = rowBegin_ * layout_.columns; cell < rowEnd_ * layout_.columns; ++cell) {
+    residents_.insert(residents_.end(), grid_.cell(cell).begin(), grid_.cell(cell).end());
+  }
+
+  std::vector<std::vector<ShardCreature>> emigrants(layout_.shards());
+  for (size_t id : residents_) {
+    RandomStream stream(seed_, tick_, id, RandomPurpose::MOVEMENT);
+    MoveDirection direction = static_cast<MoveDirection>(stream.uniformInt(0, 3));
+    creatures_.move(id, direction, false);
+
+    const int cell = grid_.cellIndex(creatures_.x(id), creatures_.y(id));
+    if (cell == grid_.cellOf(id)) continue;
+
+    const uint32_t target = layout_.shardOfCell(cell);
+    if (target == index_) {
+      grid_.relocate(id, creatures_.x(id), creatures_.y(id));
+    } else {
+      grid_.remove(id);
+      owned_[id] = 0;
+      emigrants[target].push_back(record(id));
+    }
+  }
+
+  for (const auto& list : emigrants) {
+    reply.putVector(list);
+  }
+}
+
+void ArenaShard::acceptImmigrants(MessageBuffer& request, MessageBuffer& reply) {
+  std::vector<ShardCreature> arrivals;
+  request.getVector(arrivals);
+  for (const auto& creature : arrivals) {
+    acceptRecord(creature);
+    owned_[creature.id] = 1;
+    grid_.insert(creature.id, creature.x, creature.y);
+  }
+
+  // Первая строка полосы - ореол шарда выше
+  std::vector<ShardCreature> halo;
+  if (index_ > 0) {
+    for (int cell = rowBegin_ * layout_.columns; cell < (rowBegin_ + 1) * layout_.columns; ++cell) {
+      for (size_t id : grid_.cell(cell)) {
+        halo.push_back(record(id));
+      }
+    }
+  }
+  reply.putVector(halo);
+}
+
+void ArenaShard::detectCombats(MessageBuffer& request, MessageBuffer& reply) {
+  std::vector<ShardCreature> halo;
+  request.getVector(halo);
+  halo_.clear();
+  for (const auto& creature : halo) {
+    acceptRecord(creature);
+    grid_.insert(creature.id, creature.x, creature.y);
+    halo_.push_back(creature.id);
+  }
+
+  // Зонды только из своих строк, хвост блока может заходить в ореол
+  pairs_.clear();
+  crossPairs_.clear();
+  CandidateBlock packed;
+  std::vector<uint8_t> hits;
+  uint64_t pairTests = 0;
+  grid_.forEachCellBlock(rowBegin_, rowEnd_, [&](const std::vector<size_t>& block, size_t homeCount) {
+    packed.pack(creatures_, block);
+    pairTests += RangeKernel::forEachBlockHit(packed, block, homeCount, hits,
+        [&](size_t attacker, size_t defender, size_t k) {
+          (owned_[block[k]] ? pairs_ : crossPairs_).emplace_back(attacker, defender);
+        });
+  });
+
+  // Чужие участники пограничных пар - пограничные и у шарда ниже
+  std::vector<uint64_t> border;
+  for (const auto& combat : crossPairs_) {
+    for (size_t id : {combat.first, combat.second}) {
+      if (!owned_[id]) {
+        border.push_back(id);
+      }
+    }
+  }
+  reply.put(pairTests);
+  reply.putVector(border);
+}
+
+void ArenaShard::resolveCombats(MessageBuffer& request, MessageBuffer& reply) {
+  std::vector<uint64_t> border;
+  request.getVector(border);
+
+  components_.reset(creatures_.size());
+  for (uint64_t id : border) {
+    components_.markBorder(id);
+  }
+  for (const auto& combat : crossPairs_) {
+    for (size_t id : {combat.first, combat.second}) {
+      if (owned_[id]) {
+        components_.markBorder(id);
+      }
+    }
+  }
+  components_.build(pairs_);
+
+  // Свои компоненты без пограничных существ разрешаются здесь, как в TileMap
+  std::sort(pairs_.begin(), pairs_.end(), CombatPairOrder{});
+  std::sort(crossPairs_.begin(), crossPairs_.end(), CombatPairOrder{});
+  CombatMediator mediator(creatures_, nullptr, seed_, tick_);
+  std::vector<CombatPair> deferred;
+  std::vector<ShardBattle> battles;
+  for (const auto& combat : pairs_) {
+    if (components_.deferred(combat)) {
+      deferred.push_back(combat);
+      continue;
+    }
+    if (!creatures_.isAlive(combat.first) || !creatures_.isAlive(combat.second)) continue;
+
+    const BattleOutcome outcome = mediator.decide(NPC(creatures_, combat.first),
+                                                  NPC(creatures_, combat.second));
+    if (outcome == NO_CONTEST) continue;
+
+    const size_t loser = outcome == ATTACKER_VICTORY ? combat.second : combat.first;
+    creatures_.setAlive(loser, false);
+    grid_.remove(loser);
+    battles.push_back(ShardBattle{ShardPair{combat.first, combat.second},
+                                  static_cast<uint32_t>(outcome), 0});
+  }
+
+  const size_t local = deferred.size();
+  deferred.insert(deferred.end(), crossPairs_.begin(), crossPairs_.end());
+  std::inplace_merge(deferred.begin(), deferred.begin() + local, deferred.end(), CombatPairOrder{});
+
+  // Координатору нужны итоговые состояния всех участников
+  std::vector<ShardPair> deferredPairs;
+  std::vector<ShardCreature> participants;
+  for (const auto& battle : battles) {
+    participants.push_back(record(battle.pair.first));
+    participants.push_back(record(battle.pair.second));
+  }
+  for (const auto& combat : deferred) {
+    deferredPairs.push_back(ShardPair{combat.first, combat.second});
+    participants.push_back(record(combat.first));
+    participants.push_back(record(combat.second));
+  }
+  reply.putVector(battles);
+  reply.putVector(deferredPairs);
+  reply.putVector(participants);
+}
+
+void ArenaShard::applyDeaths(MessageBuffer& request, MessageBuffer& reply) {
+  std::vector<uint64_t> deaths;
+  request.getVector(deaths);
+  for (uint64_t id : deaths) {
+    creatures_.setAlive(id, false);
+    grid_.remove(id);
+  }
+
+  // Ореол устаревает к следующему тику
+  for (size_t id : halo_) {
+    grid_.remove(id);
+  }
+  halo_.clear();
+
+  // В сетке полосы только живые свои существа
+  ShardCounts counts{0, 0, 0, 0};
+  for (int cell = rowBegin_ * layout_.columns; cell < rowEnd_ * layout_.columns; ++cell) {
+    for (size_t id : grid_.cell(cell)) {
+      ++counts.alive;
+      switch (creatures_.type(id)) {
+        case NPCType::KNIGHT: ++counts.knights; break;
+        case NPCType::ELF: ++counts.elves; break;
+        case NPCType::DRAGON: ++counts.dragons; break;
+        default: break;
+      }
+    }
+  }
+  reply.put(counts);
+}
+
+void ArenaShard::collect(MessageBuffer& reply) const {
+  std::vector<ShardCreature> states;
+  for (size_t id = 0; id < creatures_.size(); ++id) {
+    if (owned_[id]) {
+      states.push_back(record(id));
+    }
+  }
+  reply.putVector(states);
+}
+
+void ArenaShard::serve(ShardChannel& channel) {
+  MessageBuffer request;
+  MessageBuffer reply;
+  while (true) {
+    const ShardMessage type = channel.receive(request);
+    reply.clear();
+    switch (type) {
+      case SHARD_TICK: moveResidents(request, reply); break;
+      case SHARD_IMMIGRANTS: acceptImmigrants(request, reply); break;
+      case SHARD_HALO: detectCombats(request, reply); break;
+      case SHARD_BORDER: resolveCombats(request, reply); break;
+      case SHARD_DEATHS: applyDeaths(request, reply); break;
+      case SHARD_COLLECT: collect(reply); break;
+      case SHARD_STOP: return;
+      default: throw std::runtime_error("Неизвестная команда шарду");
+    }
+    channel.send(type, reply);
+  }
+}
@@ -0,0 +1,35 @@
+#include "../../include/game/combat_components.hpp"
+
+void CombatComponents::reset(size_t creatures) {
+  border_.assign(creatures, 0);
+  parent_.resize(creatures);
+}
+
+uint32_t CombatComponents::find(uint32_t id) {
+  while (parent_[id] != id) {
+    parent_[id] = parent_[parent_[id]];
+    id = parent_[id];
+  }
+  return id;
+}
+
+void CombatComponents::build(const std::vector<CombatPair>& pairs) {
+  for (const auto& combat : pairs) {
+    parent_[combat.first] = static_cast<uint32_t>(combat.first);
+    parent_[combat.second] = static_cast<uint32_t>(combat.second);
+  }
+  for (const auto& combat : pairs) {
+    const uint32_t first = find(static_cast<uint32_t>(combat.first));
+    const uint32_t second = find(static_cast<uint32_t>(combat.second));
+    if (first != second) {
+      parent_[first] = second;
+    }
+  }
+  for (const auto& combat : pairs) {
+    for (size_t id : {combat.first, combat.second}) {
+      if (border_[id]) {
+        border_[find(static_cast<uint32_t>(id))] = 1;
+      }
+    }
+  }
+}
@@ -0,0 +1,80 @@
+#include "../../include/game/combat_queue.hpp"
+
+CombatQueue::CombatQueue(size_t capacity): ring_(capacity) {}
+
+void CombatQueue::updateHighWaterMark() {
+  const size_t occupancy = size();
+  size_t mark = highWaterMark_.load(std::memory_order_relaxed);
+  while (occupancy > mark &&
+         !highWaterMark_.compare_exchange_weak(mark, occupancy, std::memory_order_relaxed)) {
+  }
+}
+
+void CombatQueue::push(const CombatPair& combat) {
+  pushed_.fetch_add(1, std::memory_order_relaxed);
+  
+  if (!spilling_.load(std::memory_order_acquire) && ring_.tryPush(combat)) {
+    updateHighWaterMark();
+    return;
+  }
+  
+  // Кольцо заполнено или уже идет сброс в резерв: кладем туда же,
+  // чтобы не обогнать ранее отложенные пары
+  {
+    std::lock_guard lock(spillMutex_);
+    spill_.push_back(combat);
+    spilling_.store(true, std::memory_order_release);
+    spillPending_.fetch_add(1, std::memory_order_relaxed);
+  }
+  overflowed_.fetch_add(1, std::memory_order_relaxed);
+  updateHighWaterMark();
+}
+
+bool CombatQueue::tryPop(CombatPair& combat) {
+  if (ring_.tryPop(combat)) {
+    return true;
+  }
+  if (!spilling_.load(std::memory_order_acquire)) {
+    return false;
+  }
+  
+  std::lock_guard lock(spillMutex_);
+  if (spillHead_ == spill_.size()) {
+    return false;
+  }
+  
+  combat = spill_[spillHead_++];
+  spillPending_.fetch_sub(1, std::memory_order_relaxed);
+  if (spillHead_ == spill_.size()) {
+    spill_.clear();
+    spillHead_ = 0;
+    spilling_.store(false, std::memory_order_release);
+  }
+  return true;
+}
+
+void CombatQueue::clear() {
+  CombatPair combat;
+  while (tryPop(combat)) {
+  }
+}
+
+size_t CombatQueue::size() const {
+  return ring_.sizeApprox() + spillPending_.load(std::memory_order_relaxed);
+}
+
+CombatQueue::Stats CombatQueue::getStats() const {
+  return Stats{
+    capacity(),
+    size(),
+    highWaterMark_.load(std::memory_order_relaxed),
+    pushed_.load(std::memory_order_relaxed),
+    overflowed_.load(std::memory_order_relaxed)
+  };
+}
+
+void CombatQueue::resetStats() {
+  highWaterMark_.store(size(), std::memory_order_relaxed);
+  pushed_.store(0, std::memory_order_relaxed);
+  overflowed_.store(0, std::memory_order_relaxed);
+}
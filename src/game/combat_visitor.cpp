@@ -1,28 +1,35 @@
 #include "../../include/game/combat_visitor.hpp"
 #include "../../include/game/constants.hpp"
-#include <random>
 
-CombatMediator::CombatMediator(const std::vector<std::unique_ptr<NPC>>& participants, 
-                               const std::vector<Observer*>& watchers):
-  combatants_(participants), monitors_(watchers) {}
+CombatMediator::CombatMediator(const CreatureStore& participants, EventBus* events,
+                               uint64_t seed, uint64_t tick):
+  combatants_(participants), events_(events), seed_(seed), tick_(tick) {}
 
-void CombatMediator::rollDice(std::mt19937& generator, int& attackerRoll, int& defenderRoll) const {
-  std::uniform_int_distribution<int> dice(1, ArenaConfig::Combat::ATTACK_DICE_SIDES);
-  attackerRoll = dice(generator);
-  defenderRoll = dice(generator);
+void CombatMediator::rollDice(RandomStream& stream, int& attackerRoll, int& defenderRoll) const {
+  attackerRoll = stream.uniformInt(1, ArenaConfig::Combat::ATTACK_DICE_SIDES);
+  defenderRoll = stream.uniformInt(1, ArenaConfig::Combat::DEFENSE_DICE_SIDES);
+}
+
+RandomStream CombatMediator::combatStream(const NPC& attacker, const NPC& defender) const {
+  return RandomStream(seed_, tick_, attacker.getSlot(), RandomPurpose::COMBAT,
+                      defender.getSlot());
 }
 
 void CombatMediator::logBattleResult(NPC& victor, NPC& defeated) const {
-  std::lock_guard lock(combatLogMutex_);
-  for (auto monitor : monitors_) {
-    monitor->recordBattle(victor, defeated);
+  if (events_ == nullptr) {
+    return;
+  }
+  if (events_->wants(BATTLE_EVENT)) {
+    events_->publish(makeBattleEvent(tick_, victor, defeated));
+  }
+  if (events_->wants(DEATH_EVENT)) {
+    events_->publish(makeDeathEvent(tick_, defeated, victor));
   }
 }
 
 void CombatMediator::logMovement(NPC& creature, MoveDirection path) const {
-  std::lock_guard lock(combatLogMutex_);
-  for (auto monitor : monitors_) {
-    monitor->recordMovement(creature, path);
+  if (events_ != nullptr && events_->wants(MOVE_EVENT)) {
+    events_->publish(makeMoveEvent(tick_, creature, static_cast<uint8_t>(path)));
   }
 }
 
@@ -31,20 +38,21 @@ BattleOutcome CombatMediator::engage(NPC& attacker, NPC& defender) {
     return NO_CONTEST;
   }
   
-  std::random_device rd;
-  std::mt19937 gen(rd());
+  BattleOutcome outcome = decide(attacker, defender);
+  settle(attacker, defender, outcome);
+  return outcome;
+}
+
+BattleOutcome CombatMediator::decide(const NPC& attacker, const NPC& defender) const {
+  RandomStream stream = combatStream(attacker, defender);
   int attackerPower, defenderPower;
-  rollDice(gen, attackerPower, defenderPower);
+  rollDice(stream, attackerPower, defenderPower);
   
   if (attacker.canKill(defender) && attackerPower > defenderPower) {
-    defender.setAlive(false);
-    logBattleResult(attacker, defender);
     return ATTACKER_VICTORY;
   }
   
   if (defender.canKill(attacker) && defenderPower > attackerPower) {
-    attacker.setAlive(false);
-    logBattleResult(defender, attacker);
     return DEFENDER_VICTORY;
   }
   
@@ -52,6 +60,23 @@ BattleOutcome CombatMediator::engage(NPC& attacker, NPC& defender) {
   return NO_CONTEST;
 }
 
+void CombatMediator::settle(NPC& attacker, NPC& defender, BattleOutcome outcome) {
+  if (outcome == ATTACKER_VICTORY) {
+    defender.setAlive(false);
+  } else if (outcome == DEFENDER_VICTORY) {
+    attacker.setAlive(false);
+  }
+  report(attacker, defender, outcome);
+}
+
+void CombatMediator::report(NPC& attacker, NPC& defender, BattleOutcome outcome) const {
+  if (outcome == ATTACKER_VICTORY) {
+    logBattleResult(attacker, defender);
+  } else if (outcome == DEFENDER_VICTORY) {
+    logBattleResult(defender, attacker);
+  }
+}
+
 void CombatMediator::relocate(NPC& creature, MoveDirection direction) {
   if (creature.isAlive()) {
     creature.move(direction);
@@ -71,9 +96,8 @@ CombatMediator::CombatReport CombatMediator::simulateEngagement(NPC& attacker, N
     return report;
   }
   
-  std::random_device rd;
-  std::mt19937 gen(rd());
-  rollDice(gen, report.attackerRoll, report.defenderRoll);
+  RandomStream stream = combatStream(attacker, defender);
+  rollDice(stream, report.attackerRoll, report.defenderRoll);
   
   if (attacker.canKill(defender) && report.attackerRoll > report.defenderRoll) {
     report.combatOccurred = true;
@@ -0,0 +1,23 @@
+#include "../../include/game/creature_arena.hpp"
+
+CreatureArena::CreatureArena(size_t expected): store_(std::make_shared<CreatureStore>()) {
+  store_->reserve(expected);
+  creatures_.reserve(expected);
+}
+
+void* CreatureArena::allocateObject() {
+  if (used_ == OBJECTS_PER_CHUNK) {
+    chunks_.emplace_back(new unsigned char[sizeof(NPC) * OBJECTS_PER_CHUNK]);
+    used_ = 0;
+  }
+  return chunks_.back().get() + sizeof(NPC) * used_++;
+}
+
+void CreatureArena::release() {
+  // Деструкторы объектов не вызываются: их указатели на хранилище
+  // не владеющие, освобождать в них нечего
+  creatures_.clear();
+  chunks_.clear();
+  used_ = OBJECTS_PER_CHUNK;
+  store_ = std::make_shared<CreatureStore>();
+}
@@ -0,0 +1,99 @@
+#include "../../include/game/creature_pool.hpp"
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace {
+  union Slot {
+    Slot* next;
+    alignas(std::max_align_t) unsigned char storage[CreaturePool::SLOT_SIZE];
+  };
+  
+  struct ChunkRegistry {
+    std::mutex mutex;
+    std::vector<Slot*> chunks;
+    Slot* orphans = nullptr;   // свободные слоты завершившихся потоков
+  };
+  
+  // Намеренно не уничтожается: объекты могут освобождаться при выходе
+  ChunkRegistry& registry() {
+    static ChunkRegistry* instance = new ChunkRegistry();
+    return *instance;
+  }
+  
+  struct LocalCache {
+    Slot* freeList = nullptr;
+    Slot* bump = nullptr;
+    Slot* bumpEnd = nullptr;
+    
+    ~LocalCache() {
+      if (freeList == nullptr) return;
+      
+      Slot* tail = freeList;
+      while (tail->next != nullptr) tail = tail->next;
+      
+      ChunkRegistry& shared = registry();
+      std::lock_guard lock(shared.mutex);
+      tail->next = shared.orphans;
+      shared.orphans = freeList;
+    }
+  };
+  
+  thread_local LocalCache cache;
+  
+  void refill() {
+    ChunkRegistry& shared = registry();
+    {
+      std::lock_guard lock(shared.mutex);
+      if (shared.orphans != nullptr) {
+        cache.freeList = shared.orphans;
+        shared.orphans = nullptr;
+        return;
+      }
+    }
+    
+    Slot* chunk = static_cast<Slot*>(::operator new(sizeof(Slot) * CreaturePool::SLOTS_PER_CHUNK));
+    {
+      std::lock_guard lock(shared.mutex);
+      shared.chunks.push_back(chunk);
+    }
+    cache.bump = chunk;
+    cache.bumpEnd = chunk + CreaturePool::SLOTS_PER_CHUNK;
+  }
+}
+
+void* CreaturePool::allocate(size_t size) {
+  if (size > SLOT_SIZE) {
+    return ::operator new(size);
+  }
+  
+  if (cache.freeList == nullptr && cache.bump == cache.bumpEnd) {
+    refill();
+  }
+  if (cache.freeList != nullptr) {
+    Slot* slot = cache.freeList;
+    cache.freeList = slot->next;
+    return slot;
+  }
+  return cache.bump++;
+}
+
+void CreaturePool::deallocate(void* pointer, size_t size) {
+  if (pointer == nullptr) {
+    return;
+  }
+  if (size > SLOT_SIZE) {
+    ::operator delete(pointer);
+    return;
+  }
+  
+  Slot* slot = static_cast<Slot*>(pointer);
+  slot->next = cache.freeList;
+  cache.freeList = slot;
+}
+
+size_t CreaturePool::chunkCount() {
+  ChunkRegistry& shared = registry();
+  std::lock_guard lock(shared.mutex);
+  return shared.chunks.size();
+}
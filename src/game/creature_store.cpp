@@ -0,0 +1,164 @@
+#include "../../include/game/creature_store.hpp"
+#include "../../include/game/spatial_grid.hpp"
+#include "../../include/game/constants.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+  // Шаг с упором в границы мира: для DefaultWorld границы - константы
+  template <typename Bounds>
+  void stepWithin(const Bounds& bounds, MoveDirection direction, double step,
+                  double& x, double& y) {
+    switch (direction) {
+      case MoveDirection::TOP: 
+        y = std::clamp(y + step, bounds.minY, bounds.maxY); 
+        break;
+      case MoveDirection::RIGHT: 
+        x = std::clamp(x + step, bounds.minX, bounds.maxX); 
+        break;
+      case MoveDirection::BOTTOM: 
+        y = std::clamp(y - step, bounds.minY, bounds.maxY); 
+        break;
+      case MoveDirection::LEFT: 
+        x = std::clamp(x - step, bounds.minX, bounds.maxX); 
+        break;
+    }
+  }
+}
+
+size_t CreatureStore::add(NPCType type, double x, double y, NameId name,
+                          double moveDistance, double attackRange, bool alive) {
+  const size_t id = x_.size();
+  x_.push_back(x);
+  y_.push_back(y);
+  type_.push_back(static_cast<uint8_t>(type));
+  alive_.push_back(alive ? 1 : 0);
+  moveDistance_.push_back(static_cast<float>(moveDistance));
+  attackRange_.push_back(static_cast<float>(attackRange));
+  names_.push_back(name);
+  
+  if (grid_ != nullptr && alive) {
+    grid_->insert(id, x, y);
+  }
+  return id;
+}
+
+size_t CreatureStore::add(const NPC& creature) {
+  return add(creature.getType(), creature.getX(), creature.getY(), creature.getNameId(),
+             creature.getMoveDistance(), creature.getAttackRange(), creature.isAlive());
+}
+
+void CreatureStore::reserve(size_t count) {
+  x_.reserve(count);
+  y_.reserve(count);
+  type_.reserve(count);
+  alive_.reserve(count);
+  moveDistance_.reserve(count);
+  attackRange_.reserve(count);
+  names_.reserve(count);
+}
+
+void CreatureStore::clear() {
+  x_.clear();
+  y_.clear();
+  type_.clear();
+  alive_.clear();
+  moveDistance_.clear();
+  attackRange_.clear();
+  names_.clear();
+  
+  if (grid_ != nullptr) {
+    grid_->clear();
+  }
+}
+
+void CreatureStore::setPosition(size_t id, double x, double y, bool reindex) {
+  x_[id] = x;
+  y_[id] = y;
+  
+  if (reindex && grid_ != nullptr) {
+    grid_->relocate(id, x, y);
+  }
+}
+
+void CreatureStore::setAlive(size_t id, bool alive) {
+  if (grid_ != nullptr && isAlive(id) != alive) {
+    if (alive) {
+      grid_->insert(id, x_[id], y_[id]);
+    } else {
+      grid_->remove(id);
+    }
+  }
+  alive_[id] = alive ? 1 : 0;
+}
+
+void CreatureStore::move(size_t id, MoveDirection direction, bool reindex) {
+  double newX = x_[id];
+  double newY = y_[id];
+  const double step = moveDistance_[id];
+  
+  if (defaultWorld_) {
+    stepWithin(DefaultWorld{}, direction, step, newX, newY);
+  } else {
+    stepWithin(bounds_, direction, step, newX, newY);
+  }
+  
+  setPosition(id, newX, newY, reindex);
+}
+
+double CreatureStore::distance(size_t first, size_t second) const {
+  const double distanceX = x_[first] - x_[second];
+  const double distanceY = y_[first] - y_[second];
+  return std::sqrt(distanceX * distanceX + distanceY * distanceY);
+}
+
+bool CreatureStore::canKill(size_t attacker, size_t defender) const {
+  if (!canPrey(type(attacker), type(defender)) || !isAlive(attacker) || !isAlive(defender)) {
+    return false;
+  }
+  
+  const double range = attackRange(attacker);
+  return squaredDistance(attacker, defender) <= range * range;
+}
+
+namespace {
+  template <size_t... Index>
+  constexpr auto makePairKernels(std::index_sequence<Index...>) {
+    using Kernel = PairVerdict (CreatureStore::*)(size_t, size_t) const;
+    return std::array<Kernel, sizeof...(Index)>{
+      &CreatureStore::testPair<static_cast<NPCType>(Index / NPC_TYPE_COUNT),
+                               static_cast<NPCType>(Index % NPC_TYPE_COUNT)>...
+    };
+  }
+}
+
+const std::array<CreatureStore::PairKernel, NPC_TYPE_COUNT * NPC_TYPE_COUNT>
+CreatureStore::PAIR_KERNELS = makePairKernels(std::make_index_sequence<NPC_TYPE_COUNT * NPC_TYPE_COUNT>{});
+
+void CreatureStore::copyFrom(const CreatureStore& other) {
+  // Присваивание векторов переиспользует выделенную память кадра
+  x_ = other.x_;
+  y_ = other.y_;
+  type_ = other.type_;
+  alive_ = other.alive_;
+  moveDistance_ = other.moveDistance_;
+  attackRange_ = other.attackRange_;
+  names_ = other.names_;
+  bounds_ = other.bounds_;
+  defaultWorld_ = other.defaultWorld_;
+  grid_ = nullptr;
+}
+
+void CreatureStore::attachGrid(SpatialGrid* grid) {
+  grid_ = grid;
+  if (grid_ == nullptr) {
+    return;
+  }
+  
+  grid_->clear();
+  for (size_t id = 0; id < size(); ++id) {
+    if (isAlive(id)) {
+      grid_->insert(id, x_[id], y_[id]);
+    }
+  }
+}
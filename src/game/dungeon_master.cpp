@@ -1,66 +1,184 @@
 #include "../../include/game/dungeon_master.hpp"
 #include "../../include/game/constants.hpp"
+#include "../../include/game/snapshot.hpp"
+#include "../../include/game/range_kernel.hpp"
 #include <fstream>
 #include <string>
-#include <random>
 #include <algorithm>
+#include <cmath>
 #include <iomanip>
+#include <sstream>
 
-DungeonMaster::DungeonMaster() {
-  watchers_.push_back(new ConsoleDisplay());
-  watchers_.push_back(new FileRecorder());
+DungeonMaster::DungeonMaster(): DungeonMaster(true) {}
+
+DungeonMaster::DungeonMaster(bool withDefaultWatchers)
+    : combatQueue_(std::make_unique<CombatQueue>(ArenaConfig::Combat::QUEUE_CAPACITY)),
+      seed_(generateSeed()) {
+  // Мир, тайлы и потоки - из настроек процесса
+  const ArenaSettings& settings = arenaSettings();
+  creatures_.attachGrid(&grid_);
+  tiles_.configure(grid_, settings.tiles, settings.tiles);
+  setWorkerThreads(settings.threads);
+  if (withDefaultWatchers) {
+    watchers_.push_back(new ConsoleDisplay());
+    watchers_.push_back(new FileRecorder());
+  }
+  for (auto watcher : watchers_) {
+    events_.subscribe(watcher);
+  }
+  
+  std::unique_lock lock(creatureMutex_);
+  publishFrame();
 }
 
 DungeonMaster::~DungeonMaster() {
+  events_.flush();
   for (size_t i = 0; i != watchers_.size(); ++i) {
+    events_.unsubscribe(watchers_[i]);
     delete watchers_[i];
   }
 }
 
 bool DungeonMaster::validateCoordinates(double x, double y) const {
-  return (x >= ArenaConfig::WORLD_MIN_X && x <= ArenaConfig::WORLD_MAX_X &&
-          y >= ArenaConfig::WORLD_MIN_Y && y <= ArenaConfig::WORLD_MAX_Y);
+  return creatures_.bounds().contains(x, y);
 }
 
-void DungeonMaster::broadcastEvent(const std::string& event) const {
-  for (auto& watcher : watchers_) {
-    watcher->recordGameEvent(event);
+void DungeonMaster::checkAttackRange(double range) const {
+  // Иначе сетка пропустит часть боев; дальности хранятся во float
+  if (static_cast<float>(range) > static_cast<float>(grid_.getCellSize())) {
+    throw std::invalid_argument("Дальность атаки " + std::to_string(range) +
+                                " больше ячейки сетки боев: увеличьте дальности в настройках");
   }
 }
 
-void DungeonMaster::initializeCreatures(int count) {
-  std::unique_lock lock(creatureMutex_);
-  creatures_.reserve(count);
-
-  std::random_device rd;
-  std::mt19937 gen(rd());
-  std::uniform_real_distribution<double> x_dist(ArenaConfig::WORLD_MIN_X, 
-                                               ArenaConfig::WORLD_MAX_X);
-  std::uniform_real_distribution<double> y_dist(ArenaConfig::WORLD_MIN_Y, 
-                                               ArenaConfig::WORLD_MAX_Y);
-
-  for (int i = 0; i < count; ++i) {
-    NPCType type = static_cast<NPCType>(1 + (i % 3));
-    double x = x_dist(gen);
-    double y = y_dist(gen);
-    std::string name = "NPC_" + std::to_string(i + 1);
+NPC DungeonMaster::viewCreature(size_t index) const {
+  // Представление используется только для чтения под shared_lock
+  return viewCreature(creatures_, index);
+}
+
+NPC DungeonMaster::viewCreature(const CreatureStore& store, size_t index) {
+  return NPC(const_cast<CreatureStore&>(store), index);
+}
+
+namespace {
+  // Живые существа в [begin, end) добавляются к stats
+  void countCreatureRange(const CreatureStore& creatures, size_t begin, size_t end,
+                          DungeonMaster::GameStats& stats) {
+    const uint8_t* types = creatures.typeData();
+    const uint8_t* alive = creatures.aliveData();
     
-    spawnCreature(type, x, y, name);
+    for (size_t i = begin; i < end; ++i) {
+      if (alive[i]) {
+        stats.aliveCreatures++;
+        switch (static_cast<NPCType>(types[i])) {
+          case NPCType::KNIGHT: stats.knights++; break;
+          case NPCType::ELF: stats.elves++; break;
+          case NPCType::DRAGON: stats.dragons++; break;
+          default: break;
+        }
+      }
+    }
   }
   
-  broadcastEvent("Инициализировано " + std::to_string(count) + " существ");
+  DungeonMaster::GameStats countCreatures(const CreatureStore& creatures) {
+    DungeonMaster::GameStats stats{0, 0, 0, 0, 0};
+    stats.totalCreatures = creatures.size();
+    countCreatureRange(creatures, 0, creatures.size(), stats);
+    return stats;
+  }
 }
 
-void DungeonMaster::spawnCreature(NPCType type, double x, double y, 
-                                  const std::string& name) {
-  std::unique_lock lock(creatureMutex_);
+void DungeonMaster::publishFrame() const {
+  publishFrame(countCreatures(creatures_));
+}
+
+void DungeonMaster::publishFrame(const GameStats& stats) const {
+  // Вызывается под unique_lock или из publishStaleFrame: писатель кадров всегда один
+  ScopedLatency timer(metrics_.phases[PHASE_FRAME]);
+  TraceScope trace("publishFrame", "world");
+  frameStale_.store(false, std::memory_order_relaxed);
+  WorldFrame& frame = frames_.back();
+  frame.creatures.copyFrom(creatures_);
+  frame.stats = stats;
+  frame.seed = seed_;
+  frame.tick = tick_;
+  frame.version = ++frameVersion_;
+  frames_.publish();
+}
+
+void DungeonMaster::publishStaleFrame() const {
+  // shared_lock исключает писателей под unique_lock, а другие читатели
+  // ждут на frameReaderMutex_ - кадр по-прежнему пишет кто-то один
+  std::shared_lock lock(creatureMutex_);
+  if (frameStale_.load(std::memory_order_relaxed)) {
+    publishFrame();
+  }
+}
+
+void DungeonMaster::publishNotice(uint64_t tick, NoticeKind kind, uint64_t count,
+                                  const std::string& text) const {
+  if (events_.wants(NOTICE_EVENT)) {
+    events_.publish(makeNoticeEvent(tick, kind, count, text));
+  }
+}
+
+size_t DungeonMaster::flushEvents() const {
+  ScopedLatency timer(metrics_.phases[PHASE_EVENTS]);
+  TraceScope trace("flushEvents", "world");
+  const size_t delivered = events_.flush();
+  if (metrics_.events != nullptr) {
+    metrics_.events->add(delivered);
+  }
+  return delivered;
+}
+
+size_t DungeonMaster::placeCreature(NPCType type, double x, double y,
+                                    const std::string& name) {
   if (!validateCoordinates(x, y)) {
     throw std::invalid_argument("Координаты вне игрового мира");
   }
   
-  creatures_.push_back(CreatureFactory::createCreature(type, x, y, name));
-  broadcastEvent("Создано существо: " + name + " (" + 
-                 convertTypeFromString(std::to_string(static_cast<int>(type))) + ")");
+  size_t id = CreatureFactory::createCreature(creatures_, type, x, y, name);
+  if (events_.wants(SPAWN_EVENT)) {
+    events_.publish(makeSpawnEvent(tick_, NPC(creatures_, id)));
+  }
+  return id;
+}
+
+void DungeonMaster::initializeCreatures(int count) {
+  {
+    std::unique_lock lock(creatureMutex_);
+    creatures_.reserve(creatures_.size() + count);
+    
+    const size_t firstId = creatures_.size();
+    const WorldBounds& world = creatures_.bounds();
+    for (int i = 0; i < count; ++i) {
+      NPCType type = static_cast<NPCType>(1 + (i % 3));
+      RandomStream stream(seed_, tick_, firstId + i, RandomPurpose::PLACEMENT);
+      double x = stream.uniformReal(world.minX, world.maxX);
+      double y = stream.uniformReal(world.minY, world.maxY);
+      std::string name = "NPC_" + std::to_string(i + 1);
+      
+      placeCreature(type, x, y, name);
+    }
+    
+    publishNotice(tick_, WORLD_INITIALIZED, count);
+    publishFrame();
+  }
+  flushEvents();
+}
+
+void DungeonMaster::spawnCreature(NPCType type, double x, double y, 
+                                  const std::string& name) {
+  {
+    std::unique_lock lock(creatureMutex_);
+    placeCreature(type, x, y, name);
+    if (inputListener_ != nullptr) {
+      inputListener_->onSpawn(tick_, type, x, y, name);
+    }
+    frameStale_.store(true, std::memory_order_release);
+  }
+  flushEvents();
 }
 
 void DungeonMaster::spawnCreature(const std::string& type, double x, double y, 
@@ -70,13 +188,75 @@ void DungeonMaster::spawnCreature(const std::string& type, double x, double y,
 
 void DungeonMaster::relocateCreature(size_t index, MoveDirection direction) {
   std::unique_lock lock(creatureMutex_);
-  if (index < creatures_.size() && creatures_[index]->isAlive()) {
-    creatures_[index]->move(direction);
+  if (index < creatures_.size() && creatures_.isAlive(index)) {
+    creatures_.move(index, direction);
+    if (inputListener_ != nullptr) {
+      inputListener_->onRelocate(tick_, index, direction);
+    }
+    frameStale_.store(true, std::memory_order_release);
   }
 }
 
 void DungeonMaster::loadScenario(const std::string& fileName) {
-  std::unique_lock lock(creatureMutex_);
+  TraceScope trace("loadScenario", "io");
+  {
+    std::unique_lock lock(creatureMutex_);
+    ScopedLatency timer(metrics_.phases[PHASE_LOAD]);
+    loadScenarioLocked(fileName);
+    publishFrame();
+  }
+  flushEvents();
+}
+
+void DungeonMaster::loadSnapshot(const Snapshot::View& snapshot, const std::string& source) {
+  TraceScope trace("loadSnapshot", "io");
+  {
+    std::unique_lock lock(creatureMutex_);
+    ScopedLatency timer(metrics_.phases[PHASE_LOAD]);
+    loadSnapshotLocked(snapshot, source);
+    publishFrame();
+  }
+  flushEvents();
+}
+
+void DungeonMaster::loadSnapshotLocked(const Snapshot::View& snapshot, const std::string& source) {
+  // Зерно и тик переносятся только в пустой мир, иначе снимок дописывается
+  if (creatures_.empty()) {
+    seed_ = snapshot.header().seed;
+    tick_ = snapshot.header().tick;
+    CreatureFactory::setSeed(seed_);
+  }
+  
+  // Те же проверки, что у текстового сценария через CreatureFactory:
+  // контрольная сумма ловит только случайную порчу файла
+  for (size_t i = 0; i < snapshot.size(); ++i) {
+    const Snapshot::Creature& record = snapshot.creature(i);
+    if (record.type < KNIGHT || record.type > DRAGON || record.alive > 1 ||
+        !validateCoordinates(record.x, record.y) ||
+        !std::isfinite(record.moveDistance) || !(record.moveDistance > 0) ||
+        !std::isfinite(record.attackRange) || !(record.attackRange >= 0)) {
+      throw std::runtime_error("Файл снимка поврежден: " + source + " (существо " +
+                               std::to_string(i) + ")");
+    }
+    checkAttackRange(record.attackRange);
+  }
+  creatures_.reserve(creatures_.size() + snapshot.size());
+  for (size_t i = 0; i < snapshot.size(); ++i) {
+    const Snapshot::Creature& record = snapshot.creature(i);
+    creatures_.add(static_cast<NPCType>(record.type), record.x, record.y,
+                   snapshot.name(i), record.moveDistance,
+                   record.attackRange, record.alive != 0);
+  }
+  
+  publishNotice(tick_, SNAPSHOT_LOADED, snapshot.size(), source);
+}
+
+void DungeonMaster::loadScenarioLocked(const std::string& fileName) {
+  if (Snapshot::looksLikeSnapshot(fileName)) {
+    loadSnapshotLocked(Snapshot::View(fileName), fileName);
+    return;
+  }
+  
   std::ifstream in(fileName);
   
   if (!in.is_open()) {
@@ -85,87 +265,132 @@ void DungeonMaster::loadScenario(const std::string& fileName) {
   
   std::unique_ptr<NPC> creature;
   while ((creature = CreatureFactory::loadCreatureFromFile(in)) != nullptr) {
-    creatures_.push_back(std::move(creature));
+    checkAttackRange(creature->getAttackRange());
+    creatures_.add(*creature);
   }
   
   in.close();
-  broadcastEvent("Загружен сценарий из файла: " + fileName);
+  publishNotice(tick_, SCENARIO_LOADED, creatures_.size(), fileName);
 }
 
 void DungeonMaster::saveScenario(const std::string& fileName) const {
-  std::shared_lock lock(creatureMutex_);
+  const std::string& extension = ArenaConfig::Files::SNAPSHOT_EXTENSION;
+  bool binary = fileName.size() >= extension.size() &&
+                fileName.compare(fileName.size() - extension.size(), extension.size(), extension) == 0;
+  saveScenario(fileName, binary ? BINARY_SNAPSHOT : TEXT_SCENARIO);
+}
+
+void DungeonMaster::saveScenario(const std::string& fileName, ScenarioFormat format) const {
+  // Сохраняется последний кадр: симуляция продолжается во время записи
+  TraceScope trace("saveScenario", "io");
+  readFrame([&](const WorldFrame& frame) {
+    ScopedLatency timer(metrics_.phases[PHASE_SAVE]);
+    saveFrame(frame, fileName, format);
+  });
+  flushEvents();
+}
+
+void DungeonMaster::saveFrame(const WorldFrame& frame, const std::string& fileName,
+                              ScenarioFormat format) const {
+  const CreatureStore& creatures = frame.creatures;
+  
+  if (format == BINARY_SNAPSHOT) {
+    Snapshot::write(fileName, creatures, frame.seed, frame.tick);
+    publishNotice(frame.tick, SNAPSHOT_SAVED, creatures.size(), fileName);
+    return;
+  }
+  
   std::ofstream out(fileName);
   
   if (!out.is_open()) {
     throw std::invalid_argument("Не удалось открыть файл для записи");
   }
   
-  for (const auto& creature : creatures_) {
-    creature->save(out);
+  for (size_t i = 0; i < creatures.size(); ++i) {
+    viewCreature(creatures, i).save(out);
   }
   
   out.close();
-  broadcastEvent("Сценарий сохранен в файл: " + fileName);
+  publishNotice(frame.tick, SCENARIO_SAVED, creatures.size(), fileName);
 }
 
 void DungeonMaster::displayCreature(const std::string& name) const {
-  std::shared_lock lock(creatureMutex_);
-  for (const auto& creature : creatures_) {
-    if (creature->getName() == name) {
-      creature->display();
-      return;
-    }
+  // Сравниваем id: имя, которого нет в таблице, не носит ни одно существо
+  NameId id;
+  bool found = false;
+  if (NameTable::global().find(name, id)) {
+    readFrame([&](const WorldFrame& frame) {
+      const CreatureStore& creatures = frame.creatures;
+      for (size_t i = 0; i < creatures.size() && !found; ++i) {
+        if (creatures.nameId(i) == id) {
+          viewCreature(creatures, i).display();
+          found = true;
+        }
+      }
+    });
+  }
+  if (!found) {
+    std::cout << "Существо с именем " << name << " не найдено\n";
   }
-  std::cout << "Существо с именем " << name << " не найдено\n";
 }
 
 void DungeonMaster::displayAllCreatures() const {
-  std::shared_lock lock(creatureMutex_);
-  std::cout << "\n=== ВСЕ СУЩЕСТВА ===\n";
-  for (const auto& creature : creatures_) {
-    creature->display();
-  }
-  std::cout << "===================\n";
+  readFrame([](const WorldFrame& frame) {
+    std::cout << "\n=== ВСЕ СУЩЕСТВА ===\n";
+    for (size_t i = 0; i < frame.creatures.size(); ++i) {
+      viewCreature(frame.creatures, i).display();
+    }
+    std::cout << "===================\n";
+  });
 }
 
 void DungeonMaster::displayLivingCreatures() const {
-  std::shared_lock lock(creatureMutex_);
-  std::cout << "\n=== ВЫЖИВШИЕ СУЩЕСТВА ===\n";
-  for (const auto& creature : creatures_) {
-    if (creature->isAlive()) {
-      creature->display();
+  readFrame([](const WorldFrame& frame) {
+    std::cout << "\n=== ВЫЖИВШИЕ СУЩЕСТВА ===\n";
+    for (size_t i = 0; i < frame.creatures.size(); ++i) {
+      if (frame.creatures.isAlive(i)) {
+        viewCreature(frame.creatures, i).display();
+      }
     }
-  }
-  std::cout << "========================\n";
+    std::cout << "========================\n";
+  });
 }
 
 void DungeonMaster::renderMap() const {
-  std::shared_lock lock(creatureMutex_);
-  
+  ScopedLatency timer(metrics_.phases[PHASE_RENDER]);
+  TraceScope trace("renderMap", "io");
   const int width = 50;
   const int height = 20;
-  const double cellWidth = (ArenaConfig::WORLD_MAX_X - ArenaConfig::WORLD_MIN_X) / width;
-  const double cellHeight = (ArenaConfig::WORLD_MAX_Y - ArenaConfig::WORLD_MIN_Y) / height;
-  
   std::vector<std::vector<char>> map(height, std::vector<char>(width, '.'));
   
-  for (const auto& creature : creatures_) {
-    if (creature->isAlive()) {
-      int x = static_cast<int>((creature->getX() - ArenaConfig::WORLD_MIN_X) / cellWidth);
-      int y = static_cast<int>((creature->getY() - ArenaConfig::WORLD_MIN_Y) / cellHeight);
-      
-      if (x >= 0 && x < width && y >= 0 && y < height) {
-        char symbol = '.';
-        switch (creature->getType()) {
-          case NPCType::KNIGHT: symbol = 'K'; break;
-          case NPCType::ELF: symbol = 'E'; break;
-          case NPCType::DRAGON: symbol = 'D'; break;
-          default: symbol = '?';
+  readFrame([&](const WorldFrame& frame) {
+    const CreatureStore& creatures = frame.creatures;
+    const WorldBounds& world = creatures.bounds();
+    const double cellWidth = (world.maxX - world.minX) / width;
+    const double cellHeight = (world.maxY - world.minY) / height;
+    const double* xs = creatures.xData();
+    const double* ys = creatures.yData();
+    const uint8_t* types = creatures.typeData();
+    const uint8_t* alive = creatures.aliveData();
+    
+    for (size_t i = 0; i < creatures.size(); ++i) {
+      if (alive[i]) {
+        int x = static_cast<int>((xs[i] - world.minX) / cellWidth);
+        int y = static_cast<int>((ys[i] - world.minY) / cellHeight);
+        
+        if (x >= 0 && x < width && y >= 0 && y < height) {
+          char symbol = '.';
+          switch (static_cast<NPCType>(types[i])) {
+            case NPCType::KNIGHT: symbol = 'K'; break;
+            case NPCType::ELF: symbol = 'E'; break;
+            case NPCType::DRAGON: symbol = 'D'; break;
+            default: symbol = '?';
+          }
+          map[y][x] = symbol;
         }
-        map[y][x] = symbol;
       }
     }
-  }
+  });
   
   std::cout << "\nКарта арены:\n";
   std::cout << std::string(width + 2, '-') << "\n";
@@ -181,65 +406,525 @@ void DungeonMaster::renderMap() const {
 }
 
 void DungeonMaster::processMovementPhase() {
+  TraceScope trace("processMovementPhase", "world");
+  std::unique_lock lock(creatureMutex_);
+  moveCreaturesLocked();
+  updateSpatialIndexLocked();
+}
+
+void DungeonMaster::moveCreatures() {
+  std::unique_lock lock(creatureMutex_);
+  moveCreaturesLocked();
+}
+
+void DungeonMaster::updateSpatialIndex() {
   std::unique_lock lock(creatureMutex_);
-  std::random_device rd;
-  std::mt19937 gen(rd());
-  std::uniform_int_distribution<int> dirDist(0, 3);
-  
-  for (auto& creature : creatures_) {
-    if (creature->isAlive()) {
-      MoveDirection direction = static_cast<MoveDirection>(dirDist(gen));
-      creature->move(direction);
+  updateSpatialIndexLocked();
+}
+
+void DungeonMaster::moveCreaturesLocked() {
+  ScopedLatency timer(metrics_.phases[PHASE_MOVE]);
+  TraceScope trace("moveCreatures", "world");
+  ++tick_;
+  
+  if (tiles_.enabled()) {
+    tiles_.move(creatures_, grid_, *workers_, seed_, tick_);
+    return;
+  }
+  
+  // Кусков у работника может быть несколько: списки чистим заранее
+  for (auto& changed : cellChanges_) {
+    changed.clear();
+  }
+  
+  workers_->parallelFor(creatures_.size(), [this](size_t worker, size_t begin, size_t end) {
+    auto& changed = cellChanges_[worker];
+    
+    for (size_t i = begin; i < end; ++i) {
+      if (!creatures_.isAlive(i)) continue;
+      
+      RandomStream stream(seed_, tick_, i, RandomPurpose::MOVEMENT);
+      MoveDirection direction = static_cast<MoveDirection>(stream.uniformInt(0, 3));
+      creatures_.move(i, direction, false);
+      if (grid_.cellIndex(creatures_.x(i), creatures_.y(i)) != grid_.cellOf(i)) {
+        changed.push_back(i);
+      }
+    }
+  });
+}
+
+void DungeonMaster::updateSpatialIndexLocked() {
+  ScopedLatency timer(metrics_.phases[PHASE_INDEX]);
+  TraceScope trace("updateSpatialIndex", "world");
+  if (tiles_.enabled()) {
+    tiles_.deliver(creatures_, grid_, *workers_);
+  }
+  
+  // Сетку меняем после движения, в одном потоке
+  for (auto& changed : cellChanges_) {
+    for (size_t id : changed) {
+      grid_.relocate(id, creatures_.x(id), creatures_.y(id));
     }
+    changed.clear();
+  }
+}
+
+void DungeonMaster::testCombatPair(size_t first, size_t second) const {
+  switch (creatures_.testPair(first, second)) {
+    case FIRST_KILLS: combatQueue_->push(CombatPair(first, second)); break;
+    case SECOND_KILLS: combatQueue_->push(CombatPair(second, first)); break;
+    default: break;
   }
 }
 
 void DungeonMaster::detectPotentialCombats() {
-  std::unique_lock lock(creatureMutex_);
-  std::lock_guard queueLock(queueMutex_);
+  // Сетка и перебор только читают мир и идут рядом с читателями; тайлы
+  // пишут свои списки пар и tilePairsReady_, им нужен монопольный захват.
+  // Режим проверяется под тем захватом, в котором идет поиск
+  TraceScope trace("detectPotentialCombats", "world");
+  for (;;) {
+    {
+      std::shared_lock lock(creatureMutex_);
+      if (!detectsInTiles()) {
+        detectCombatsShared();
+        return;
+      }
+    }
+    
+    std::unique_lock lock(creatureMutex_);
+    if (detectsInTiles()) {
+      // Пары остаются в тайлах до фазы боев
+      ScopedLatency timer(metrics_.phases[PHASE_DETECT]);
+      lastPairTests_.store(tiles_.detect(creatures_, grid_, *workers_), std::memory_order_relaxed);
+      tilePairsReady_ = true;
+      return;
+    }
+  }
+}
+
+void DungeonMaster::detectCombatsShared() {
+  // Найденные бои сразу идут в очередь без блокировок, в том числе из
+  // нескольких работников; порядок восстанавливает фаза боев
+  ScopedLatency timer(metrics_.phases[PHASE_DETECT]);
+  size_t pairTests = 0;
   
-  for (size_t i = 0; i < creatures_.size(); ++i) {
-    if (!creatures_[i]->isAlive()) continue;
+  if (detectionMode_ == BRUTE_FORCE) {
+    // Перебор по группам типов: пары типов, которые не могут сражаться,
+    // пропускаются целиком
+    std::array<std::vector<size_t>, NPC_TYPE_COUNT> byType;
+    for (size_t i = 0; i < creatures_.size(); ++i) {
+      if (creatures_.isAlive(i) && creatures_.type(i) < NPC_TYPE_COUNT) {
+        byType[creatures_.type(i)].push_back(i);
+      }
+    }
     
-    for (size_t j = i + 1; j < creatures_.size(); ++j) {
-      if (!creatures_[j]->isAlive()) continue;
-      
-      if (creatures_[i]->canKill(*creatures_[j])) {
-        combatQueue_.push({i, j});
-      } else if (creatures_[j]->canKill(*creatures_[i])) {
-        combatQueue_.push({j, i});
+    for (size_t firstType = 0; firstType < NPC_TYPE_COUNT; ++firstType) {
+      for (size_t secondType = firstType; secondType < NPC_TYPE_COUNT; ++secondType) {
+        if (!canInteract(static_cast<NPCType>(firstType), static_cast<NPCType>(secondType))) {
+          continue;
+        }
+        
+        const auto& firstGroup = byType[firstType];
+        const auto& secondGroup = byType[secondType];
+        for (size_t i = 0; i < firstGroup.size(); ++i) {
+          const size_t j0 = firstType == secondType ? i + 1 : 0;
+          for (size_t j = j0; j < secondGroup.size(); ++j) {
+            ++pairTests;
+            testCombatPair(std::min(firstGroup[i], secondGroup[j]),
+                           std::max(firstGroup[i], secondGroup[j]));
+          }
+        }
       }
     }
+  } else {
+    // Строки сетки делятся между работниками; блок ячейки упаковывается
+    // подряд, и каждое существо проверяется против хвоста блока векторным ядром
+    std::vector<size_t> partialTests(workers_->size(), 0);
+    workers_->parallelFor(static_cast<size_t>(grid_.getRows()), [&](size_t worker, size_t begin, size_t end) {
+      CandidateBlock packed;
+      std::vector<uint8_t> hits;
+      grid_.forEachCellBlock(static_cast<int>(begin), static_cast<int>(end),
+          [&](const std::vector<size_t>& block, size_t homeCount) {
+        packed.pack(creatures_, block);
+        partialTests[worker] += RangeKernel::forEachBlockHit(packed, block, homeCount, hits,
+            [&](size_t attacker, size_t defender, size_t) {
+              combatQueue_->push(CombatPair(attacker, defender));
+            });
+      });
+    });
+    for (size_t tests : partialTests) {
+      pairTests += tests;
+    }
+  }
+  
+  lastPairTests_.store(pairTests, std::memory_order_relaxed);
+  if (metrics_.queueDepth != nullptr) {
+    metrics_.queueDepth->set(static_cast<int64_t>(combatQueue_->size()));
   }
 }
 
 void DungeonMaster::resolveCombatQueue() {
+  TraceScope trace("resolveCombatQueue", "world");
+  {
+    std::unique_lock lock(creatureMutex_);
+    resolveCombatsLocked();
+    collectTickStatsLocked();
+    
+    // Граница тика: читатели получают новый кадр
+    publishFrame(tickStats_);
+  }
+  
+  // Подписчики получают события тика без блокировки мира
+  flushEvents();
+}
+
+void DungeonMaster::resolveCombats() {
+  std::unique_lock lock(creatureMutex_);
+  resolveCombatsLocked();
+}
+
+void DungeonMaster::collectTickStats() {
+  std::unique_lock lock(creatureMutex_);
+  collectTickStatsLocked();
+}
+
+void DungeonMaster::publishTickFrame() {
   std::unique_lock lock(creatureMutex_);
-  std::lock_guard queueLock(queueMutex_);
+  publishFrame(tickStats_);
+}
+
+void DungeonMaster::registerTickPhases(TickScheduler& scheduler) {
+  scheduler.setWorkerPool(workers_);
   
-  CombatMediator mediator(creatures_, watchers_);
-  while (!combatQueue_.empty()) {
-    auto [attackerIdx, defenderIdx] = combatQueue_.front();
-    combatQueue_.pop();
-    
-    if (attackerIdx < creatures_.size() && defenderIdx < creatures_.size() &&
-        creatures_[attackerIdx]->isAlive() && creatures_[defenderIdx]->isAlive()) {
-      executeCombat(attackerIdx, defenderIdx);
+  // Кадр и рассылка событий не зависят друг от друга и идут параллельно
+  auto move = scheduler.addPhase("движение", [this]() { moveCreatures(); });
+  auto index = scheduler.addPhase("сетка", [this]() { updateSpatialIndex(); }, {move});
+  auto detect = scheduler.addPhase("поиск боев", [this]() { detectPotentialCombats(); }, {index});
+  auto resolve = scheduler.addPhase("бои", [this]() { resolveCombats(); }, {detect});
+  auto stats = scheduler.addPhase("статистика", [this]() { collectTickStats(); }, {resolve});
+  scheduler.addPhase("кадр", [this]() { publishTickFrame(); }, {stats});
+  scheduler.addPhase("события", [this]() { flushEvents(); }, {stats});
+}
+
+void DungeonMaster::resolveCombatsLocked() {
+  ScopedLatency timer(metrics_.phases[PHASE_RESOLVE]);
+  TraceScope trace("resolveCombats", "world");
+  if (tilePairsReady_) {
+    resolveTileCombats();
+    return;
+  }
+  
+  pendingCombats_.clear();
+  CombatPair combat;
+  while (combatQueue_->tryPop(combat)) {
+    if (combat.first < creatures_.size() && combat.second < creatures_.size()) {
+      pendingCombats_.push_back(combat);
     }
   }
+  // Работники поиска кладут бои вперемешку: бои идут в порядке
+  // возрастания пары, как при переборе по индексам
+  std::sort(pendingCombats_.begin(), pendingCombats_.end(), [](const auto& lhs, const auto& rhs) {
+    return std::minmax(lhs.first, lhs.second) < std::minmax(rhs.first, rhs.second);
+  });
+  
+  CombatMediator mediator(creatures_, &events_, seed_, tick_);
+  size_t battles = 0;
+  if (workers_->size() > 1 && pendingCombats_.size() >= ArenaConfig::Combat::PARALLEL_BATCH_MIN) {
+    lastCombatBatches_ = resolveCombatBatches(mediator, battles);
+  } else {
+    lastCombatBatches_ = pendingCombats_.size();
+    for (auto [attackerIdx, defenderIdx] : pendingCombats_) {
+      if (creatures_.isAlive(attackerIdx) && creatures_.isAlive(defenderIdx)) {
+        NPC attacker(creatures_, attackerIdx);
+        NPC defender(creatures_, defenderIdx);
+        if (mediator.engage(attacker, defender) != NO_CONTEST) {
+          ++battles;
+        }
+      }
+    }
+  }
+  lastBattles_ = battles;
+}
+
+void DungeonMaster::resolveTileCombats() {
+  tilePairsReady_ = false;
+  
+  // Тайлы меняют мир сами; журнал - после всех, в порядке пар
+  CombatMediator mediator(creatures_, &events_, seed_, tick_);
+  const size_t deferred = tiles_.resolve(creatures_, grid_, *workers_, mediator, tileBattles_);
+  for (const auto& battle : tileBattles_) {
+    NPC attacker(creatures_, battle.pair.first);
+    NPC defender(creatures_, battle.pair.second);
+    mediator.report(attacker, defender, battle.outcome);
+  }
+  
+  // Проход тайлов - одна пачка, каждый пограничный бой - своя
+  lastCombatBatches_ = 1 + deferred;
+  lastBattles_ = tileBattles_.size();
+}
+
+void DungeonMaster::collectTickStatsLocked() {
+  ScopedLatency timer(metrics_.phases[PHASE_STATS]);
+  TraceScope trace("collectTickStats", "world");
+  // Частичные счетчики по работникам складываются в конце
+  std::vector<GameStats> partial(workers_->size(), GameStats{0, 0, 0, 0, 0});
+  workers_->parallelFor(creatures_.size(), [&](size_t worker, size_t begin, size_t end) {
+    countCreatureRange(creatures_, begin, end, partial[worker]);
+  }, ArenaConfig::Combat::STATS_GRAIN);
+  
+  tickStats_ = GameStats{static_cast<int>(creatures_.size()), 0, 0, 0, 0};
+  for (const auto& stats : partial) {
+    tickStats_.aliveCreatures += stats.aliveCreatures;
+    tickStats_.knights += stats.knights;
+    tickStats_.elves += stats.elves;
+    tickStats_.dragons += stats.dragons;
+  }
+  if (events_.wants(TICK_EVENT)) {
+    events_.publish(makeTickEvent(tick_, static_cast<uint32_t>(tickStats_.aliveCreatures),
+                                  static_cast<uint32_t>(lastBattles_)));
+  }
+  if (metrics_.ticks != nullptr) {
+    metrics_.ticks->add();
+    metrics_.battles->add(lastBattles_);
+    metrics_.aliveCreatures->set(tickStats_.aliveCreatures);
+  }
+}
+
+size_t DungeonMaster::resolveCombatBatches(CombatMediator& mediator, size_t& battles) {
+  const size_t count = pendingCombats_.size();
+  
+  // Пара встает в пачку сразу за последними пачками своих участников:
+  // внутри пачки существа не повторяются, а бои одного существа
+  // идут в порядке очереди
+  auto& frontier = batchFrontier_;
+  auto& batchOf = batchOf_;
+  frontier.resize(creatures_.size(), 0);
+  batchOf.resize(count);
+  uint32_t batches = 0;
+  for (size_t k = 0; k < count; ++k) {
+    auto [attackerIdx, defenderIdx] = pendingCombats_[k];
+    const uint32_t batch = std::max(frontier[attackerIdx], frontier[defenderIdx]);
+    batchOf[k] = batch;
+    frontier[attackerIdx] = frontier[defenderIdx] = batch + 1;
+    batches = std::max(batches, batch + 1);
+  }
+  // Обнуляем только участников, а не весь массив
+  for (const auto& [attackerIdx, defenderIdx] : pendingCombats_) {
+    frontier[attackerIdx] = frontier[defenderIdx] = 0;
+  }
+  
+  // Раскладываем пары по пачкам подсчетом, сохраняя порядок очереди
+  auto& batchStart = batchStart_;
+  batchStart.assign(batches + 1, 0);
+  for (size_t k = 0; k < count; ++k) {
+    ++batchStart[batchOf[k] + 1];
+  }
+  for (uint32_t b = 0; b < batches; ++b) {
+    batchStart[b + 1] += batchStart[b];
+  }
+  auto& order = batchOrder_;
+  auto& fill = batchFill_;
+  order.resize(count);
+  fill.assign(batchStart.begin(), batchStart.end() - 1);
+  for (size_t k = 0; k < count; ++k) {
+    order[fill[batchOf[k]]++] = k;
+  }
+  
+  // Исходы считаются по копии живости, мир меняется только в конце
+  auto& alive = batchAlive_;
+  auto& outcomes = batchOutcomes_;
+  alive.assign(creatures_.aliveData(), creatures_.aliveData() + creatures_.size());
+  outcomes.assign(count, NO_CONTEST);
+  
+  auto resolveRange = [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      const size_t k = order[i];
+      auto [attackerIdx, defenderIdx] = pendingCombats_[k];
+      if (!alive[attackerIdx] || !alive[defenderIdx]) continue;
+      
+      outcomes[k] = mediator.decide(viewCreature(attackerIdx), viewCreature(defenderIdx));
+      if (outcomes[k] == ATTACKER_VICTORY) {
+        alive[defenderIdx] = 0;
+      } else if (outcomes[k] == DEFENDER_VICTORY) {
+        alive[attackerIdx] = 0;
+      }
+    }
+  };
+  
+  for (uint32_t b = 0; b < batches; ++b) {
+    const size_t begin = batchStart[b];
+    const size_t end = batchStart[b + 1];
+    if (end - begin < ArenaConfig::Combat::PARALLEL_BATCH_MIN) {
+      resolveRange(begin, end);
+      continue;
+    }
+    workers_->parallelFor(end - begin, [&](size_t, size_t from, size_t to) {
+      resolveRange(begin + from, begin + to);
+    });
+  }
+  
+  // Смерти и журнал - в порядке очереди, как при последовательном разрешении
+  for (size_t k = 0; k < count; ++k) {
+    if (outcomes[k] == NO_CONTEST) continue;
+    
+    ++battles;
+    NPC attacker(creatures_, pendingCombats_[k].first);
+    NPC defender(creatures_, pendingCombats_[k].second);
+    mediator.settle(attacker, defender, outcomes[k]);
+  }
+  return batches;
 }
 
 void DungeonMaster::executeCombat(size_t attackerIdx, size_t defenderIdx) {
-  if (attackerIdx >= creatures_.size() || defenderIdx >= creatures_.size()) {
-    return;
+  {
+    std::unique_lock lock(creatureMutex_);
+    if (attackerIdx >= creatures_.size() || defenderIdx >= creatures_.size()) {
+      return;
+    }
+    
+    CombatMediator mediator(creatures_, &events_, seed_, tick_);
+    NPC attacker(creatures_, attackerIdx);
+    NPC defender(creatures_, defenderIdx);
+    auto outcome = mediator.engage(attacker, defender);
+    
+    if (outcome == ATTACKER_VICTORY) {
+      creatures_.setAlive(defenderIdx, false);
+    }
+    publishFrame();
+  }
+  flushEvents();
+}
+
+void DungeonMaster::clearCombatQueue() {
+  combatQueue_->clear();
+}
+
+void DungeonMaster::setCombatQueueCapacity(size_t capacity) {
+  if (capacity == 0) {
+    throw std::invalid_argument("Емкость очереди боев должна быть положительной");
+  }
+  std::unique_lock lock(creatureMutex_);
+  combatQueue_ = std::make_unique<CombatQueue>(capacity);
+}
+
+CombatQueue::Stats DungeonMaster::getCombatQueueStats() const {
+  return combatQueue_->getStats();
+}
+
+size_t DungeonMaster::getLastCombatBatches() const {
+  std::shared_lock lock(creatureMutex_);
+  return lastCombatBatches_;
+}
+
+void DungeonMaster::setCombatDetection(CombatDetection mode) {
+  std::unique_lock lock(creatureMutex_);
+  detectionMode_ = mode;
+}
+
+CombatDetection DungeonMaster::getCombatDetection() const {
+  std::shared_lock lock(creatureMutex_);
+  return detectionMode_;
+}
+
+size_t DungeonMaster::getLastPairTests() const {
+  return lastPairTests_.load(std::memory_order_relaxed);
+}
+
+double DungeonMaster::getCombatCellSize() const {
+  // Сетка строится в конструкторе и дальше не меняет размер ячейки
+  return grid_.getCellSize();
+}
+
+void DungeonMaster::setWorkerThreads(size_t threads) {
+  std::unique_lock lock(creatureMutex_);
+  workers_ = std::make_shared<WorkerPool>(threads);
+  cellChanges_.assign(workers_->size(), {});
+}
+
+std::shared_ptr<WorkerPool> DungeonMaster::getWorkerPool() const {
+  std::shared_lock lock(creatureMutex_);
+  return workers_;
+}
+
+void DungeonMaster::setWorldTiles(size_t columns, size_t rows) {
+  std::unique_lock lock(creatureMutex_);
+  // Мигранты старого разбиения встают в сетку до перестройки
+  if (tiles_.enabled()) {
+    tiles_.deliver(creatures_, grid_, *workers_);
   }
+  tiles_.configure(grid_, columns, rows);
+  tilePairsReady_ = false;
+}
+
+void DungeonMaster::enableMetrics(MetricsRegistry& registry) {
+  static constexpr const char* PHASE_NAMES[WORLD_PHASE_COUNT] = {
+    "move", "index", "detect", "resolve", "stats", "frame", "events", "render", "save", "load"
+  };
   
-  CombatMediator mediator(creatures_, watchers_);
-  auto outcome = mediator.engage(*creatures_[attackerIdx], *creatures_[defenderIdx]);
+  std::unique_lock lock(creatureMutex_);
+  for (size_t phase = 0; phase < WORLD_PHASE_COUNT; ++phase) {
+    metrics_.phases[phase] = &registry.histogram("arena_phase_seconds", "Длительность фаз и операций мира",
+                                                 "phase", PHASE_NAMES[phase]);
+  }
+  metrics_.queueDepth = &registry.gauge("arena_combat_queue_depth", "Пар в очереди боев после поиска");
+  metrics_.aliveCreatures = &registry.gauge("arena_creatures_alive", "Живых существ на конце тика");
+  metrics_.events = &registry.counter("arena_events_total", "Событий роздано подписчикам");
+  metrics_.battles = &registry.counter("arena_battles_total", "Состоявшихся боев");
+  metrics_.ticks = &registry.counter("arena_ticks_total", "Тиков мира");
   
-  if (outcome == ATTACKER_VICTORY) {
-    creatures_[defenderIdx]->setAlive(false);
+  // Захват при включении уже сделан - ожидание считается со следующего
+  LatencyHistogram& exclusiveWait =
+      registry.histogram("arena_lock_wait_seconds", "Ожидание creatureMutex_", "mode", "exclusive");
+  LatencyHistogram& sharedWait =
+      registry.histogram("arena_lock_wait_seconds", "Ожидание creatureMutex_", "mode", "shared");
+  creatureMutex_.attach(&exclusiveWait, &sharedWait);
+}
+
+void DungeonMaster::setInputListener(WorldInputListener* listener) {
+  std::unique_lock lock(creatureMutex_);
+  inputListener_ = listener;
+}
+
+TileMap::Stats DungeonMaster::getTileStats() const {
+  std::shared_lock lock(creatureMutex_);
+  return tiles_.getStats();
+}
+
+void DungeonMaster::setSeed(uint64_t seed) {
+  std::unique_lock lock(creatureMutex_);
+  seed_ = seed;
+  tick_ = 0;
+  CreatureFactory::setSeed(seed);
+  publishFrame();
+}
+
+uint64_t DungeonMaster::getSeed() const {
+  std::shared_lock lock(creatureMutex_);
+  return seed_;
+}
+
+uint64_t DungeonMaster::getTick() const {
+  std::shared_lock lock(creatureMutex_);
+  return tick_;
+}
+
+void DungeonMaster::restoreCreatures(const std::vector<CreatureState>& states, uint64_t tick) {
+  std::unique_lock lock(creatureMutex_);
+  for (const auto& state : states) {
+    if (state.index >= creatures_.size()) {
+      throw std::out_of_range("Неверный индекс существа");
+    }
+    // Сетка обновляется вместе с позицией и живостью
+    creatures_.setPosition(state.index, state.x, state.y);
+    creatures_.setAlive(state.index, state.alive);
   }
+  tick_ = tick;
+  publishFrame();
+}
+
+size_t DungeonMaster::getWorkerThreads() const {
+  std::shared_lock lock(creatureMutex_);
+  return workers_->size();
 }
 
 size_t DungeonMaster::getCreatureCount() const {
@@ -250,7 +935,7 @@ size_t DungeonMaster::getCreatureCount() const {
 bool DungeonMaster::isCreatureAlive(size_t index) const {
   std::shared_lock lock(creatureMutex_);
   if (index < creatures_.size()) {
-    return creatures_[index]->isAlive();
+    return creatures_.isAlive(index);
   }
   return false;
 }
@@ -259,28 +944,15 @@ std::string DungeonMaster::getCreatureInfo(size_t index) const {
   std::shared_lock lock(creatureMutex_);
   if (index < creatures_.size()) {
     std::stringstream ss;
-    ss << *creatures_[index];
+    ss << viewCreature(index);
     return ss.str();
   }
   return "Неверный индекс";
 }
 
 DungeonMaster::GameStats DungeonMaster::getCurrentStats() const {
-  std::shared_lock lock(creatureMutex_);
+  // Счетчики посчитаны при публикации кадра
   GameStats stats{0, 0, 0, 0, 0};
-  stats.totalCreatures = creatures_.size();
-  
-  for (const auto& creature : creatures_) {
-    if (creature->isAlive()) {
-      stats.aliveCreatures++;
-      switch (creature->getType()) {
-        case NPCType::KNIGHT: stats.knights++; break;
-        case NPCType::ELF: stats.elves++; break;
-        case NPCType::DRAGON: stats.dragons++; break;
-        default: break;
-      }
-    }
-  }
-  
+  readFrame([&](const WorldFrame& frame) { stats = frame.stats; });
   return stats;
 }
\ No newline at end of file
@@ -0,0 +1,235 @@
+#include "../../include/game/event_bus.hpp"
+#include "../../include/npc/npc.hpp"
+#include <algorithm>
+
+namespace {
+  std::atomic<uint64_t> nextBusId{1};
+
+  // Кэш буфера потока: хватает одной записи, шина обычно одна
+  struct LocalBufferCache {
+    uint64_t busId = 0;
+    void* buffer = nullptr;
+  };
+
+  thread_local LocalBufferCache localCache;
+}
+
+GameEvent makeBattleEvent(uint64_t tick, const NPC& victor, const NPC& defeated) {
+  GameEvent event{};
+  event.type = BATTLE_EVENT;
+  event.tick = tick;
+  event.battle.victor = static_cast<uint32_t>(victor.getSlot());
+  event.battle.defeated = static_cast<uint32_t>(defeated.getSlot());
+  event.battle.victorName = victor.getNameId();
+  event.battle.defeatedName = defeated.getNameId();
+  event.battle.victorType = static_cast<uint8_t>(victor.getType());
+  event.battle.defeatedType = static_cast<uint8_t>(defeated.getType());
+  return event;
+}
+
+GameEvent makeDeathEvent(uint64_t tick, const NPC& creature, const NPC& killer) {
+  GameEvent event{};
+  event.type = DEATH_EVENT;
+  event.tick = tick;
+  event.death.creature = static_cast<uint32_t>(creature.getSlot());
+  event.death.killer = static_cast<uint32_t>(killer.getSlot());
+  event.death.name = creature.getNameId();
+  event.death.type = static_cast<uint8_t>(creature.getType());
+  return event;
+}
+
+GameEvent makeMoveEvent(uint64_t tick, const NPC& creature, uint8_t direction) {
+  GameEvent event{};
+  event.type = MOVE_EVENT;
+  event.tick = tick;
+  event.move.creature = static_cast<uint32_t>(creature.getSlot());
+  event.move.name = creature.getNameId();
+  event.move.direction = direction;
+  event.move.x = creature.getX();
+  event.move.y = creature.getY();
+  return event;
+}
+
+GameEvent makeSpawnEvent(uint64_t tick, const NPC& creature) {
+  GameEvent event{};
+  event.type = SPAWN_EVENT;
+  event.tick = tick;
+  event.spawn.creature = static_cast<uint32_t>(creature.getSlot());
+  event.spawn.name = creature.getNameId();
+  event.spawn.type = static_cast<uint8_t>(creature.getType());
+  event.spawn.x = creature.getX();
+  event.spawn.y = creature.getY();
+  return event;
+}
+
+GameEvent makeTickEvent(uint64_t tick, uint32_t alive, uint32_t battles) {
+  GameEvent event{};
+  event.type = TICK_EVENT;
+  event.tick = tick;
+  event.tickEnd.alive = alive;
+  event.tickEnd.battles = battles;
+  return event;
+}
+
+GameEvent makeNoticeEvent(uint64_t tick, NoticeKind kind, uint64_t count,
+                          const std::string& text) {
+  GameEvent event{};
+  event.type = NOTICE_EVENT;
+  event.tick = tick;
+  event.notice.kind = kind;
+  event.notice.count = count;
+  event.notice.text = internName(text);
+  return event;
+}
+
+void appendEventText(std::string& out, const GameEvent& event) {
+  switch (event.type) {
+    case BATTLE_EVENT:
+      out.append(nameText(event.battle.victorName)).append(" победил ")
+         .append(nameText(event.battle.defeatedName));
+      break;
+    case MOVE_EVENT:
+      out.append(nameText(event.move.name)).append(" переместился ")
+         .append(convertDirectionToString(static_cast<MoveDirection>(event.move.direction)));
+      break;
+    case SPAWN_EVENT:
+      out.append("Создано существо: ").append(nameText(event.spawn.name))
+         .append(" (").append(convertTypeToString(static_cast<NPCType>(event.spawn.type)))
+         .append(")");
+      break;
+    case DEATH_EVENT:
+      out.append("Погибло существо: ").append(nameText(event.death.name))
+         .append(" (").append(convertTypeToString(static_cast<NPCType>(event.death.type)))
+         .append(")");
+      break;
+    case TICK_EVENT:
+      out.append("Тик ").append(std::to_string(event.tick))
+         .append(": живых ").append(std::to_string(event.tickEnd.alive))
+         .append(", боев ").append(std::to_string(event.tickEnd.battles));
+      break;
+    case NOTICE_EVENT:
+      switch (event.notice.kind) {
+        case WORLD_INITIALIZED:
+          out.append("Инициализировано ").append(std::to_string(event.notice.count))
+             .append(" существ");
+          break;
+        case SCENARIO_LOADED:
+          out.append("Загружен сценарий из файла: ").append(nameText(event.notice.text));
+          break;
+        case SNAPSHOT_LOADED:
+          out.append("Загружен снимок из файла: ").append(nameText(event.notice.text));
+          break;
+        case SCENARIO_SAVED:
+          out.append("Сценарий сохранен в файл: ").append(nameText(event.notice.text));
+          break;
+        case SNAPSHOT_SAVED:
+          out.append("Снимок сохранен в файл: ").append(nameText(event.notice.text));
+          break;
+      }
+      break;
+    default:
+      break;
+  }
+}
+
+EventBus::EventBus(): busId_(nextBusId.fetch_add(1, std::memory_order_relaxed)) {}
+
+void EventBus::subscribe(EventSubscriber* subscriber) {
+  std::lock_guard lock(registryMutex_);
+  if (std::find(subscribers_.begin(), subscribers_.end(), subscriber) == subscribers_.end()) {
+    subscribers_.push_back(subscriber);
+  }
+  updateInterest();
+}
+
+void EventBus::unsubscribe(EventSubscriber* subscriber) {
+  std::lock_guard lock(registryMutex_);
+  subscribers_.erase(std::remove(subscribers_.begin(), subscribers_.end(), subscriber),
+                     subscribers_.end());
+  updateInterest();
+}
+
+void EventBus::updateInterest() {
+  EventMask mask = 0;
+  for (auto subscriber : subscribers_) {
+    mask |= subscriber->interests();
+  }
+  interest_.store(mask, std::memory_order_relaxed);
+}
+
+EventBus::ThreadBuffer& EventBus::localBuffer() {
+  if (localCache.busId == busId_) {
+    return *static_cast<ThreadBuffer*>(localCache.buffer);
+  }
+
+  std::lock_guard lock(registryMutex_);
+  const std::thread::id self = std::this_thread::get_id();
+  ThreadBuffer* buffer = nullptr;
+  for (auto& candidate : buffers_) {
+    if (candidate->owner == self) {
+      buffer = candidate.get();
+      break;
+    }
+  }
+  if (buffer == nullptr) {
+    buffers_.push_back(std::make_unique<ThreadBuffer>());
+    buffer = buffers_.back().get();
+    buffer->owner = self;
+  }
+
+  localCache.busId = busId_;
+  localCache.buffer = buffer;
+  return *buffer;
+}
+
+void EventBus::publish(const GameEvent& event) {
+  if (!wants(event.type)) {
+    return;
+  }
+
+  ThreadBuffer& buffer = localBuffer();
+  std::lock_guard lock(buffer.mutex);
+  buffer.events.push_back(event);
+  published_.fetch_add(1, std::memory_order_relaxed);
+}
+
+size_t EventBus::flush() {
+  std::lock_guard delivery(deliveryMutex_);
+
+  std::vector<EventSubscriber*> subscribers;
+  batch_.clear();
+  {
+    std::lock_guard lock(registryMutex_);
+    subscribers = subscribers_;
+    for (auto& buffer : buffers_) {
+      std::lock_guard bufferLock(buffer->mutex);
+      batch_.insert(batch_.end(), buffer->events.begin(), buffer->events.end());
+      buffer->events.clear();
+    }
+  }
+
+  if (batch_.empty()) {
+    return 0;
+  }
+
+  for (auto subscriber : subscribers) {
+    const EventMask mask = subscriber->interests();
+    if ((mask & ALL_EVENTS) == ALL_EVENTS) {
+      subscriber->deliver(batch_.data(), batch_.size());
+      continue;
+    }
+
+    filtered_.clear();
+    for (const auto& event : batch_) {
+      if ((mask & eventBit(event.type)) != 0) {
+        filtered_.push_back(event);
+      }
+    }
+    if (!filtered_.empty()) {
+      subscriber->deliver(filtered_.data(), filtered_.size());
+    }
+  }
+
+  delivered_.fetch_add(batch_.size(), std::memory_order_relaxed);
+  return batch_.size();
+}
@@ -2,26 +2,59 @@
 #include "../../include/npc/knight.hpp"
 #include "../../include/npc/elf.hpp"
 #include "../../include/npc/dragon.hpp"
-#include "../../include/game/constants.hpp"
+#include "../../include/game/arena_settings.hpp"
+#include "../../include/game/random_stream.hpp"
 #include <stdexcept>
-#include <random>
 #include <sstream>
 
+namespace {
+  // Раскладка роя одного типа: строки добавляются в store, onCreated получает слот
+  template <typename OnCreated>
+  void fillSwarm(CreatureStore& store, NPCType type, int count, OnCreated&& onCreated) {
+    RandomStream stream = nextSharedStream(RandomPurpose::PLACEMENT);
+    const WorldBounds& world = arenaSettings().world;
+    
+    for (int i = 0; i < count; ++i) {
+      double x = stream.uniformReal(world.minX, world.maxX);
+      double y = stream.uniformReal(world.minY, world.maxY);
+      onCreated(CreatureFactory::createCreature(store, type, x, y,
+                CreatureFactory::generateCreatureName(type) + "_" + std::to_string(i+1)));
+    }
+  }
+  
+  // Те же случайные величины и в том же порядке, что и createRandomCreature
+  template <typename OnCreated>
+  void fillRandomSwarm(CreatureStore& store, int count, OnCreated&& onCreated) {
+    const WorldBounds& world = arenaSettings().world;
+    for (int i = 0; i < count; ++i) {
+      RandomStream stream = nextSharedStream(RandomPurpose::PLACEMENT);
+      
+      NPCType type = static_cast<NPCType>(stream.uniformInt(1, 3));
+      double x = stream.uniformReal(world.minX, world.maxX);
+      double y = stream.uniformReal(world.minY, world.maxY);
+      onCreated(CreatureFactory::createCreature(store, type, x, y,
+                CreatureFactory::generateCreatureName(type)));
+    }
+  }
+  
+  std::string positionError(double x, double y) {
+    const WorldBounds& world = arenaSettings().world;
+    return "Координаты (" + std::to_string(x) + ", " + std::to_string(y) + ") вне мира [" +
+           std::to_string(world.minX) + ", " + std::to_string(world.maxX) + "] x [" +
+           std::to_string(world.minY) + ", " + std::to_string(world.maxY) + "]";
+  }
+}
+
 std::unique_ptr<NPC> CreatureFactory::createCreature(NPCType type) {
-  return createCreature(type, 
-                       (ArenaConfig::WORLD_MAX_X - ArenaConfig::WORLD_MIN_X) / 2,
-                       (ArenaConfig::WORLD_MAX_Y - ArenaConfig::WORLD_MIN_Y) / 2,
-                       generateCreatureName(type));
+  const WorldBounds& world = arenaSettings().world;
+  return createCreature(type, (world.minX + world.maxX) / 2, (world.minY + world.maxY) / 2,
+                        generateCreatureName(type));
 }
 
 std::unique_ptr<NPC> CreatureFactory::createCreature(NPCType type, double x, double y, 
                                                      const std::string& name) {
   if (!validatePosition(x, y)) {
-    std::string error = "Координаты (" + std::to_string(x) + ", " + 
-                       std::to_string(y) + ") вне диапазона [" +
-                       std::to_string(ArenaConfig::WORLD_MIN_X) + ", " +
-                       std::to_string(ArenaConfig::WORLD_MAX_X) + "]";
-    throw std::invalid_argument(error);
+    throw std::invalid_argument(positionError(x, y));
   }
 
   switch (type) {
@@ -36,45 +69,59 @@ std::unique_ptr<NPC> CreatureFactory::createCreature(NPCType type, double x, dou
   }
 }
 
+size_t CreatureFactory::createCreature(CreatureStore& store, NPCType type, double x, double y,
+                                       const std::string& name) {
+  if (!validatePosition(x, y)) {
+    throw std::invalid_argument(positionError(x, y));
+  }
+
+  // Параметры совпадают с конструкторами Knight, Elf и Dragon
+  const std::string& creatureName = name.empty() ? generateCreatureName(type) : name;
+  const ArenaSettings& settings = arenaSettings();
+  switch (type) {
+    case NPCType::KNIGHT: 
+    case NPCType::ELF: 
+    case NPCType::DRAGON: 
+      return store.add(type, x, y, creatureName, settings.step[type], settings.range[type]);
+    default: 
+      throw std::invalid_argument("Неизвестный тип существа");
+  }
+}
+
 std::unique_ptr<NPC> CreatureFactory::createRandomCreature() {
-  static std::random_device rd;
-  static std::mt19937 gen(rd());
-  std::uniform_int_distribution<int> typeDist(1, 3);
-  std::uniform_real_distribution<double> xDist(ArenaConfig::WORLD_MIN_X, 
-                                              ArenaConfig::WORLD_MAX_X);
-  std::uniform_real_distribution<double> yDist(ArenaConfig::WORLD_MIN_Y, 
-                                              ArenaConfig::WORLD_MAX_Y);
+  RandomStream stream = nextSharedStream(RandomPurpose::PLACEMENT);
   
-  NPCType type = static_cast<NPCType>(typeDist(gen));
-  return createCreature(type, xDist(gen), yDist(gen), generateCreatureName(type));
+  const WorldBounds& world = arenaSettings().world;
+  NPCType type = static_cast<NPCType>(stream.uniformInt(1, 3));
+  double x = stream.uniformReal(world.minX, world.maxX);
+  double y = stream.uniformReal(world.minY, world.maxY);
+  return createCreature(type, x, y, generateCreatureName(type));
 }
 
 std::unique_ptr<NPC> CreatureFactory::createCreatureAtEdge(NPCType type, 
                                                            const std::string& name) {
-  static std::random_device rd;
-  static std::mt19937 gen(rd());
-  std::uniform_real_distribution<double> coordDist(0, 
-      std::max(ArenaConfig::WORLD_MAX_X, ArenaConfig::WORLD_MAX_Y));
+  RandomStream stream = nextSharedStream(RandomPurpose::PLACEMENT);
+  const WorldBounds& world = arenaSettings().world;
   
-  double x, y;
-  int edge = std::uniform_int_distribution<int>(0, 3)(gen);
+  double x = 0, y = 0;
+  int edge = stream.uniformInt(0, 3);
   
   switch (edge) {
     case 0: // Верхний край
-      x = coordDist(gen);
-      y = ArenaConfig::WORLD_MAX_Y;
+      x = stream.uniformReal(world.minX, world.maxX);
+      y = world.maxY;
       break;
     case 1: // Правый край
-      x = ArenaConfig::WORLD_MAX_X;
-      y = coordDist(gen);
+      x = world.maxX;
+      y = stream.uniformReal(world.minY, world.maxY);
       break;
     case 2: // Нижний край
-      x = coordDist(gen);
-      y = ArenaConfig::WORLD_MIN_Y;
+      x = stream.uniformReal(world.minX, world.maxX);
+      y = world.minY;
       break;
     case 3: // Левый край
-      x = ArenaConfig::WORLD_MIN_X;
-      y = coordDist(gen);
+      x = world.minX;
+      y = stream.uniformReal(world.minY, world.maxY);
       break;
   }
   
@@ -83,53 +130,93 @@ std::unique_ptr<NPC> CreatureFactory::createCreatureAtEdge(NPCType type,
 
 std::unique_ptr<NPC> CreatureFactory::createCreatureAtCenter(NPCType type,
                                                              const std::string& name) {
-  double centerX = (ArenaConfig::WORLD_MAX_X - ArenaConfig::WORLD_MIN_X) / 2;
-  double centerY = (ArenaConfig::WORLD_MAX_Y - ArenaConfig::WORLD_MIN_Y) / 2;
+  const WorldBounds& world = arenaSettings().world;
+  double centerX = (world.minX + world.maxX) / 2;
+  double centerY = (world.minY + world.maxY) / 2;
   
   return createCreature(type, centerX, centerY, name.empty() ? generateCreatureName(type) : name);
 }
 
 std::unique_ptr<NPC> CreatureFactory::loadCreatureFromFile(std::ifstream& file) {
-  std::string typeStr;
-  std::string name;
-  double x, y;
+  std::string line;
   
-  if (file >> typeStr >> x >> y >> name) {
-    NPCType type = convertTypeFromString(typeStr);
-    return createCreature(type, x, y, name);
+  while (std::getline(file, line)) {
+    if (auto creature = parseCreatureData(line)) {
+      return creature;
+    }
   }
   return nullptr;
 }
 
 std::unique_ptr<NPC> CreatureFactory::parseCreatureData(const std::string& data) {
   std::stringstream ss(data);
-  std::string typeStr, name;
-  double x, y;
+  std::vector<std::string> tokens;
+  std::string token;
+  while (ss >> token) {
+    tokens.push_back(token);
+  }
   
-  if (ss >> typeStr >> x >> y >> name) {
-    NPCType type = convertTypeFromString(typeStr);
-    return createCreature(type, x, y, name);
+  // Формат NPC::save: "<тип из нескольких слов> имя x y жив|мертв",
+  // старый формат: "тип x y имя"
+  std::string typeStr, name, xStr, yStr;
+  bool alive = true;
+  size_t count = tokens.size();
+  
+  if (count >= 5 && (tokens[count - 1] == "жив" || tokens[count - 1] == "мертв")) {
+    alive = tokens[count - 1] == "жив";
+    yStr = tokens[count - 2];
+    xStr = tokens[count - 3];
+    name = tokens[count - 4];
+    for (size_t i = 0; i + 4 < count; ++i) {
+      if (i > 0) {
+        typeStr += ' ';
+      }
+      typeStr += tokens[i];
+    }
+  } else if (count == 4) {
+    typeStr = tokens[0];
+    xStr = tokens[1];
+    yStr = tokens[2];
+    name = tokens[3];
+  } else {
+    return nullptr;
   }
   
-  return nullptr;
+  double x, y;
+  try {
+    x = std::stod(xStr);
+    y = std::stod(yStr);
+  } catch (const std::exception&) {
+    return nullptr;
+  }
+  
+  auto creature = createCreature(convertTypeFromString(typeStr), x, y, name);
+  creature->setAlive(alive);
+  return creature;
+}
+
+std::unique_ptr<NPC> CreatureFactory::wrapCreature(const std::shared_ptr<CreatureStore>& owner,
+                                                   size_t slot) {
+  switch (owner->type(slot)) {
+    case NPCType::KNIGHT: return std::make_unique<Knight>(owner, slot);
+    case NPCType::ELF: return std::make_unique<Elf>(owner, slot);
+    case NPCType::DRAGON: return std::make_unique<Dragon>(owner, slot);
+    default: throw std::invalid_argument("Неизвестный тип существа");
+  }
 }
 
+// Рой делит одно хранилище: вместо отдельного хранилища на каждое
+// существо - один объект из пула и имя
 std::vector<std::unique_ptr<NPC>> CreatureFactory::createCreatureSwarm(NPCType type, 
                                                                        int count) {
   std::vector<std::unique_ptr<NPC>> swarm;
   swarm.reserve(count);
   
-  std::random_device rd;
-  std::mt19937 gen(rd());
-  std::uniform_real_distribution<double> xDist(ArenaConfig::WORLD_MIN_X, 
-                                              ArenaConfig::WORLD_MAX_X);
-  std::uniform_real_distribution<double> yDist(ArenaConfig::WORLD_MIN_Y, 
-                                              ArenaConfig::WORLD_MAX_Y);
-  
-  for (int i = 0; i < count; ++i) {
-    swarm.push_back(createCreature(type, xDist(gen), yDist(gen), 
-                                  generateCreatureName(type) + "_" + std::to_string(i+1)));
-  }
+  auto store = std::make_shared<CreatureStore>();
+  store->reserve(count);
+  fillSwarm(*store, type, count, [&](size_t slot) {
+    swarm.push_back(wrapCreature(store, slot));
+  });
   
   return swarm;
 }
@@ -138,18 +225,39 @@ std::vector<std::unique_ptr<NPC>> CreatureFactory::createRandomSwarm(int count)
   std::vector<std::unique_ptr<NPC>> swarm;
   swarm.reserve(count);
   
-  for (int i = 0; i < count; ++i) {
-    swarm.push_back(createRandomCreature());
-  }
+  auto store = std::make_shared<CreatureStore>();
+  store->reserve(count);
+  fillRandomSwarm(*store, count, [&](size_t slot) {
+    swarm.push_back(wrapCreature(store, slot));
+  });
   
   return swarm;
 }
 
+NPC& CreatureFactory::placeInArena(CreatureArena& arena, size_t slot) {
+  switch (arena.store().type(slot)) {
+    case NPCType::KNIGHT: return arena.emplace<Knight>(slot);
+    case NPCType::ELF: return arena.emplace<Elf>(slot);
+    default: return arena.emplace<Dragon>(slot);
+  }
+}
+
+NPC& CreatureFactory::createCreature(CreatureArena& arena, NPCType type, double x, double y,
+                                     const std::string& name) {
+  return placeInArena(arena, createCreature(arena.store(), type, x, y, name));
+}
+
+void CreatureFactory::createCreatureSwarm(CreatureArena& arena, NPCType type, int count) {
+  arena.store().reserve(arena.store().size() + count);
+  fillSwarm(arena.store(), type, count, [&](size_t slot) { placeInArena(arena, slot); });
+}
+
+void CreatureFactory::createRandomSwarm(CreatureArena& arena, int count) {
+  arena.store().reserve(arena.store().size() + count);
+  fillRandomSwarm(arena.store(), count, [&](size_t slot) { placeInArena(arena, slot); });
+}
+
 std::string CreatureFactory::generateCreatureName(NPCType type) {
-  static std::random_device rd;
-  static std::mt19937 gen(rd());
-  static std::uniform_int_distribution<int> idDist(1000, 9999);
-  
   std::string base;
   switch (type) {
     case NPCType::KNIGHT: base = "Рыцарь_"; break;
@@ -158,40 +266,38 @@ std::string CreatureFactory::generateCreatureName(NPCType type) {
     default: base = "Существо_";
   }
   
-  return base + std::to_string(idDist(gen));
+  return base + std::to_string(nextSharedStream(RandomPurpose::NAMING).uniformInt(1000, 9999));
+}
+
+void CreatureFactory::setSeed(uint64_t seed) {
+  seedSharedRandom(seed);
 }
 
 bool CreatureFactory::validatePosition(double x, double y) {
-  return (x >= ArenaConfig::WORLD_MIN_X && x <= ArenaConfig::WORLD_MAX_X &&
-          y >= ArenaConfig::WORLD_MIN_Y && y <= ArenaConfig::WORLD_MAX_Y);
+  return arenaSettings().world.contains(x, y);
 }
 
-std::mt19937& CreatureFactory::getRandomEngine() {
-  static std::random_device rd;
-  static std::mt19937 gen(rd());
-  return gen;
+int CreatureFactory::pickIndex(size_t count) {
+  return nextSharedStream(RandomPurpose::NAMING).uniformInt(0, static_cast<int>(count) - 1);
 }
 
 std::string CreatureFactory::getRandomKnightName() {
   static const std::vector<std::string> names = {
     "Артур", "Ланселот", "Гавейн", "Тристан", "Персиваль", "Галахад", "Борс"
   };
-  static std::uniform_int_distribution<int> dist(0, names.size() - 1);
-  return names[dist(getRandomEngine())];
+  return names[pickIndex(names.size())];
 }
 
 std::string CreatureFactory::getRandomElfName() {
   static const std::vector<std::string> names = {
     "Леголас", "Элронд", "Галадриэль", "Арвен", "Трандуил", "Хальдир", "Эрестор"
   };
-  static std::uniform_int_distribution<int> dist(0, names.size() - 1);
-  return names[dist(getRandomEngine())];
+  return names[pickIndex(names.size())];
 }
 
 std::string CreatureFactory::getRandomDragonName() {
   static const std::vector<std::string> names = {
     "Смауг", "Дрого", "Визерион", "Рейгаль", "Балион", "Анкалагон", "Глаурунг"
   };
-  static std::uniform_int_distribution<int> dist(0, names.size() - 1);
-  return names[dist(getRandomEngine())];
+  return names[pickIndex(names.size())];
 }
\ No newline at end of file
@@ -0,0 +1,307 @@
+#include "../../include/game/metrics.hpp"
+#include <algorithm>
+#include <bit>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+  // Квантили сводок
+  constexpr double QUANTILES[] = {0.5, 0.9, 0.99, 0.999};
+  constexpr const char* QUANTILE_KEYS[] = {"p50", "p90", "p99", "p999"};
+
+  double seconds(uint64_t nanos) {
+    return static_cast<double>(nanos) * 1e-9;
+  }
+
+  // arena_events_total -> arena_events_per_second
+  std::string rateName(const std::string& counterName) {
+    const std::string suffix = "_total";
+    std::string base = counterName;
+    if (base.size() > suffix.size() &&
+        base.compare(base.size() - suffix.size(), suffix.size(), suffix) == 0) {
+      base.resize(base.size() - suffix.size());
+    }
+    return base + "_per_second";
+  }
+
+  std::string promLabels(const std::string& key, const std::string& value,
+                         const std::string& extra = "") {
+    std::string labels;
+    if (!key.empty()) {
+      labels = key + "=\"" + value + "\"";
+    }
+    if (!extra.empty()) {
+      labels += (labels.empty() ? "" : ",") + extra;
+    }
+    return labels.empty() ? "" : "{" + labels + "}";
+  }
+}
+
+size_t LatencyHistogram::bucketOf(uint64_t nanos) {
+  if (nanos < SUB_BUCKETS) {
+    return static_cast<size_t>(nanos);
+  }
+  const int exponent = std::bit_width(nanos) - 1;
+  if (exponent > MAX_EXPONENT) {
+    return BUCKETS - 1;
+  }
+  // Старшие SUB_BITS + 1 бит: мантисса в [SUB_BUCKETS, 2 * SUB_BUCKETS)
+  const uint64_t mantissa = nanos >> (exponent - SUB_BITS);
+  return static_cast<size_t>((exponent - SUB_BITS + 1) * SUB_BUCKETS + (mantissa - SUB_BUCKETS));
+}
+
+uint64_t LatencyHistogram::bucketUpperBound(size_t bucket) {
+  if (bucket < SUB_BUCKETS) {
+    return bucket;
+  }
+  const int exponent = static_cast<int>(bucket / SUB_BUCKETS) + SUB_BITS - 1;
+  const uint64_t mantissa = bucket % SUB_BUCKETS + SUB_BUCKETS;
+  return ((mantissa + 1) << (exponent - SUB_BITS)) - 1;
+}
+
+void LatencyHistogram::record(uint64_t nanos) {
+  counts_[bucketOf(nanos)].fetch_add(1, std::memory_order_relaxed);
+  count_.fetch_add(1, std::memory_order_relaxed);
+  sum_.fetch_add(nanos, std::memory_order_relaxed);
+
+  uint64_t seen = max_.load(std::memory_order_relaxed);
+  while (nanos > seen && !max_.compare_exchange_weak(seen, nanos, std::memory_order_relaxed)) {
+  }
+}
+
+LatencyHistogram::Snapshot LatencyHistogram::snapshot() const {
+  // Счетчик берем по корзинам: запись между чтениями не ломает квантили
+  Snapshot copy;
+  copy.counts.resize(BUCKETS);
+  for (size_t bucket = 0; bucket < BUCKETS; ++bucket) {
+    copy.counts[bucket] = counts_[bucket].load(std::memory_order_relaxed);
+    copy.count += copy.counts[bucket];
+  }
+  copy.sum = sum_.load(std::memory_order_relaxed);
+  copy.max = max_.load(std::memory_order_relaxed);
+  return copy;
+}
+
+uint64_t LatencyHistogram::Snapshot::percentile(double q) const {
+  if (count == 0) {
+    return 0;
+  }
+  const auto rank = static_cast<uint64_t>(std::max(1.0, q * static_cast<double>(count) + 0.5));
+  uint64_t seen = 0;
+  for (size_t bucket = 0; bucket < counts.size(); ++bucket) {
+    seen += counts[bucket];
+    if (seen >= rank) {
+      return std::min(bucketUpperBound(bucket), max);
+    }
+  }
+  return max;
+}
+
+const MetricsRegistry::Entry* MetricsRegistry::find(Kind kind, const std::string& name,
+                                                    const std::string& labelValue) const {
+  for (const auto& entry : entries_) {
+    if (entry.kind == kind && entry.name == name && entry.labelValue == labelValue) {
+      return &entry;
+    }
+  }
+  return nullptr;
+}
+
+LatencyHistogram& MetricsRegistry::histogram(const std::string& name, const std::string& help,
+                                             const std::string& labelKey,
+                                             const std::string& labelValue) {
+  std::lock_guard lock(registryMutex_);
+  if (const Entry* entry = find(HISTOGRAM, name, labelValue)) {
+    return histograms_[entry->index];
+  }
+  entries_.push_back(Entry{HISTOGRAM, name, labelKey, labelValue, help, histograms_.size()});
+  return histograms_.emplace_back();
+}
+
+MetricCounter& MetricsRegistry::counter(const std::string& name, const std::string& help) {
+  std::lock_guard lock(registryMutex_);
+  if (const Entry* entry = find(COUNTER, name, "")) {
+    return counters_[entry->index];
+  }
+  entries_.push_back(Entry{COUNTER, name, "", "", help, counters_.size()});
+  return counters_.emplace_back();
+}
+
+MetricGauge& MetricsRegistry::gauge(const std::string& name, const std::string& help) {
+  std::lock_guard lock(registryMutex_);
+  if (const Entry* entry = find(GAUGE, name, "")) {
+    return gauges_[entry->index];
+  }
+  entries_.push_back(Entry{GAUGE, name, "", "", help, gauges_.size()});
+  return gauges_.emplace_back();
+}
+
+std::vector<double> MetricsRegistry::counterRates() const {
+  const auto now = std::chrono::steady_clock::now();
+  const double elapsed = exported_ ? std::chrono::duration<double>(now - lastExport_).count() : 0;
+
+  std::vector<double> rates(counters_.size(), 0.0);
+  lastCounterValues_.resize(counters_.size(), 0);
+  for (size_t k = 0; k < counters_.size(); ++k) {
+    const uint64_t value = counters_[k].value();
+    if (elapsed > 0) {
+      rates[k] = static_cast<double>(value - lastCounterValues_[k]) / elapsed;
+    }
+    lastCounterValues_[k] = value;
+  }
+  lastExport_ = now;
+  exported_ = true;
+  return rates;
+}
+
+void MetricsRegistry::write(std::ostream& out, MetricsFormat format) const {
+  std::lock_guard lock(registryMutex_);
+  const std::vector<double> rates = counterRates();
+  out << std::setprecision(9);
+
+  if (format == JSON_METRICS) {
+    const auto stamp = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    out << "{\n  \"timestamp_ms\": " << stamp << ",\n  \"metrics\": [";
+
+    const char* separator = "\n";
+    for (const auto& entry : entries_) {
+      out << separator << "    {\"name\": \"" << entry.name << "\"";
+      if (!entry.labelKey.empty()) {
+        out << ", \"" << entry.labelKey << "\": \"" << entry.labelValue << "\"";
+      }
+      switch (entry.kind) {
+        case HISTOGRAM: {
+          const auto snapshot = histograms_[entry.index].snapshot();
+          out << ", \"type\": \"histogram\", \"count\": " << snapshot.count
+              << ", \"sum\": " << seconds(snapshot.sum) << ", \"max\": " << seconds(snapshot.max);
+          for (size_t q = 0; q < std::size(QUANTILES); ++q) {
+            out << ", \"" << QUANTILE_KEYS[q] << "\": " << seconds(snapshot.percentile(QUANTILES[q]));
+          }
+          break;
+        }
+        case COUNTER:
+          out << ", \"type\": \"counter\", \"value\": " << counters_[entry.index].value()
+              << ", \"per_second\": " << rates[entry.index];
+          break;
+        case GAUGE:
+          out << ", \"type\": \"gauge\", \"value\": " << gauges_[entry.index].value();
+          break;
+      }
+      out << "}";
+      separator = ",\n";
+    }
+    out << "\n  ]\n}\n";
+    return;
+  }
+
+  // Prometheus: HELP и TYPE - один раз на имя, серии с метками подряд
+  std::vector<std::string> written;
+  for (const auto& first : entries_) {
+    if (std::find(written.begin(), written.end(), first.name) != written.end()) continue;
+    written.push_back(first.name);
+
+    const char* type = first.kind == HISTOGRAM ? "summary" : first.kind == COUNTER ? "counter" : "gauge";
+    out << "# HELP " << first.name << " " << first.help << "\n";
+    out << "# TYPE " << first.name << " " << type << "\n";
+    for (const auto& entry : entries_) {
+      if (entry.name != first.name || entry.kind != first.kind) continue;
+
+      switch (entry.kind) {
+        case HISTOGRAM: {
+          const auto snapshot = histograms_[entry.index].snapshot();
+          for (double q : QUANTILES) {
+            std::ostringstream quantile;
+            quantile << "quantile=\"" << q << "\"";
+            out << entry.name << promLabels(entry.labelKey, entry.labelValue, quantile.str())
+                << " " << seconds(snapshot.percentile(q)) << "\n";
+          }
+          out << entry.name << "_sum" << promLabels(entry.labelKey, entry.labelValue)
+              << " " << seconds(snapshot.sum) << "\n";
+          out << entry.name << "_count" << promLabels(entry.labelKey, entry.labelValue)
+              << " " << snapshot.count << "\n";
+          break;
+        }
+        case COUNTER:
+          out << entry.name << " " << counters_[entry.index].value() << "\n";
+          break;
+        case GAUGE:
+          out << entry.name << " " << gauges_[entry.index].value() << "\n";
+          break;
+      }
+    }
+
+    if (first.kind == COUNTER) {
+      const std::string rate = rateName(first.name);
+      out << "# HELP " << rate << " " << first.help << " (в секунду с прошлой выгрузки)\n";
+      out << "# TYPE " << rate << " gauge\n";
+      out << rate << " " << rates[first.index] << "\n";
+    }
+  }
+}
+
+void MetricsRegistry::writeFile(const std::string& fileName, MetricsFormat format) const {
+  const std::string staging = fileName + ".tmp";
+  {
+    std::ofstream out(staging, std::ios::trunc);
+    if (!out.is_open()) {
+      throw std::runtime_error("Не удалось открыть файл метрик '" + staging + "'");
+    }
+    write(out, format);
+    if (!out) {
+      throw std::runtime_error("Не удалось записать метрики в '" + staging + "'");
+    }
+  }
+  if (std::rename(staging.c_str(), fileName.c_str()) != 0) {
+    throw std::runtime_error("Не удалось заменить файл метрик '" + fileName + "'");
+  }
+}
+
+MetricsFormat MetricsExporter::formatFor(const std::string& fileName) {
+  const std::string extension = ".json";
+  const bool json = fileName.size() >= extension.size() &&
+                    fileName.compare(fileName.size() - extension.size(), extension.size(), extension) == 0;
+  return json ? JSON_METRICS : PROMETHEUS_TEXT;
+}
+
+MetricsExporter::MetricsExporter(const MetricsRegistry& registry, const std::string& fileName,
+                                 std::chrono::milliseconds interval)
+    : registry_(registry),
+      fileName_(fileName),
+      format_(formatFor(fileName)),
+      interval_(interval) {
+  if (interval_.count() <= 0) {
+    throw std::invalid_argument("Интервал выгрузки метрик должен быть положительным");
+  }
+  // Ошибка открытия видна сразу, а не в фоновом потоке
+  registry_.writeFile(fileName_, format_);
+  writer_ = std::thread(&MetricsExporter::writerLoop, this);
+}
+
+MetricsExporter::~MetricsExporter() {
+  {
+    std::lock_guard lock(wakeMutex_);
+    stopping_ = true;
+  }
+  wakeUp_.notify_one();
+  if (writer_.joinable()) {
+    writer_.join();
+  }
+}
+
+void MetricsExporter::writerLoop() {
+  std::unique_lock lock(wakeMutex_);
+  bool running = true;
+  while (running) {
+    running = !wakeUp_.wait_for(lock, interval_, [this]() { return stopping_; });
+    try {
+      registry_.writeFile(fileName_, format_);
+      exports_.fetch_add(1, std::memory_order_relaxed);
+    } catch (const std::exception&) {
+      // Файл могли временно убрать - попробуем на следующем шаге
+    }
+  }
+}
@@ -0,0 +1,80 @@
+#include "../../include/game/name_table.hpp"
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+
+NameTable::NameTable() {
+  intern("");
+}
+
+NameTable& NameTable::global() {
+  // Намеренно не уничтожается: имена могут читаться при завершении программы
+  static NameTable* table = new NameTable();
+  return *table;
+}
+
+const char* NameTable::storeText(std::string_view text) {
+  if (text.empty()) {
+    return "";
+  }
+  if (text.size() > TEXT_BLOCK) {
+    textBlocks_.emplace_back(new char[text.size()]);
+    std::memcpy(textBlocks_.back().get(), text.data(), text.size());
+    // Следующее имя начнет новый обычный блок
+    textUsed_ = TEXT_BLOCK;
+    return textBlocks_.back().get();
+  }
+  
+  if (textUsed_ + text.size() > TEXT_BLOCK) {
+    textBlocks_.emplace_back(new char[TEXT_BLOCK]);
+    textUsed_ = 0;
+  }
+  char* destination = textBlocks_.back().get() + textUsed_;
+  std::memcpy(destination, text.data(), text.size());
+  textUsed_ += text.size();
+  return destination;
+}
+
+NameId NameTable::intern(std::string_view text) {
+  {
+    std::shared_lock lock(indexMutex_);
+    auto found = index_.find(text);
+    if (found != index_.end()) {
+      return found->second;
+    }
+  }
+  
+  std::unique_lock lock(indexMutex_);
+  auto found = index_.find(text);
+  if (found != index_.end()) {
+    return found->second;
+  }
+  
+  const uint32_t id = size_.load(std::memory_order_relaxed);
+  const size_t chunk = id >> CHUNK_BITS;
+  if (chunk >= MAX_CHUNKS) {
+    throw std::length_error("Переполнена таблица имен");
+  }
+  if (chunks_[chunk].load(std::memory_order_relaxed) == nullptr) {
+    ownedChunks_.emplace_back(new Entry[CHUNK_SIZE]);
+    chunks_[chunk].store(ownedChunks_.back().get(), std::memory_order_release);
+  }
+  
+  const char* stored = storeText(text);
+  Entry* entries = chunks_[chunk].load(std::memory_order_relaxed);
+  entries[id & (CHUNK_SIZE - 1)] = Entry{stored, static_cast<uint32_t>(text.size())};
+  
+  index_.emplace(std::string_view(stored, text.size()), id);
+  size_.store(id + 1, std::memory_order_release);
+  return id;
+}
+
+bool NameTable::find(std::string_view text, NameId& id) const {
+  std::shared_lock lock(indexMutex_);
+  auto found = index_.find(text);
+  if (found == index_.end()) {
+    return false;
+  }
+  id = found->second;
+  return true;
+}
@@ -1,7 +1,10 @@
 #include "../../include/game/observer.hpp"
+#include "../../include/game/constants.hpp"
 #include <iostream>
 #include <iomanip>
 #include <ctime>
+#include <cstring>
+#include <algorithm>
 
 std::string ConsoleDisplay::formatCoordinates(double x, double y) const {
   return "(" + std::to_string(static_cast<int>(x)) + ", " + 
@@ -17,19 +20,47 @@ std::string ConsoleDisplay::formatCreatureType(NPCType type) const {
   }
 }
 
-void ConsoleDisplay::recordBattle(const NPC& victor, const NPC& defeated) {
-  std::lock_guard lock(displayMutex_);
-  std::cout << "[БОЙ] " << formatCreatureType(victor.getType()) 
-            << " " << victor.getName()
-            << " победил " << formatCreatureType(defeated.getType())
-            << " " << defeated.getName() << "\n";
+void GameEventLogger::recordBattle(const NPC& victor, const NPC& defeated) {
+  const GameEvent event = makeBattleEvent(0, victor, defeated);
+  deliver(&event, 1);
+}
+
+void GameEventLogger::recordMovement(const NPC& creature, MoveDirection direction) {
+  const GameEvent event = makeMoveEvent(0, creature, static_cast<uint8_t>(direction));
+  deliver(&event, 1);
+}
+
+void ConsoleDisplay::appendEvent(std::string& out, const GameEvent& event) const {
+  switch (event.type) {
+    case BATTLE_EVENT:
+      out.append("[БОЙ] ").append(formatCreatureType(static_cast<NPCType>(event.battle.victorType)))
+         .append(" ").append(nameText(event.battle.victorName))
+         .append(" победил ").append(formatCreatureType(static_cast<NPCType>(event.battle.defeatedType)))
+         .append(" ").append(nameText(event.battle.defeatedName)).append("\n");
+      break;
+    case MOVE_EVENT:
+      out.append("[ДВИЖ] ").append(nameText(event.move.name))
+         .append(" переместился ")
+         .append(convertDirectionToString(static_cast<MoveDirection>(event.move.direction)))
+         .append(" в ").append(formatCoordinates(event.move.x, event.move.y)).append("\n");
+      break;
+    default:
+      out.append("[СОБЫТИЕ] ");
+      appendEventText(out, event);
+      out.append("\n");
+      break;
+  }
 }
 
-void ConsoleDisplay::recordMovement(const NPC& creature, MoveDirection direction) {
+void ConsoleDisplay::deliver(const GameEvent* events, size_t count) {
+  // Пачка собирается целиком и выводится одной записью
+  std::string text;
+  for (size_t i = 0; i < count; ++i) {
+    appendEvent(text, events[i]);
+  }
+  
   std::lock_guard lock(displayMutex_);
-  std::cout << "[ДВИЖ] " << creature.getName() 
-            << " переместился " << convertDirectionToString(direction)
-            << " в " << formatCoordinates(creature.getX(), creature.getY()) << "\n";
+  std::cout << text;
 }
 
 void ConsoleDisplay::recordGameEvent(const std::string& event) {
@@ -43,48 +74,196 @@ void ConsoleDisplay::displayWorldState(const std::vector<const NPC*>& creatures)
   for (const auto& creature : creatures) {
     if (creature->isAlive()) {
       std::cout << formatCreatureType(creature->getType()) << " "
-                << creature->getName() << " "
+                << creature->getNameView() << " "
                 << formatCoordinates(creature->getX(), creature->getY()) << "\n";
     }
   }
   std::cout << "===============================\n";
 }
 
-FileRecorder::FileRecorder() {
+namespace {
+  // Копирует строку с обрезкой по границе символа UTF-8
+  size_t copyText(char* destination, size_t capacity, const std::string& text) {
+    size_t length = std::min(text.size(), capacity - 1);
+    while (length > 0 && length < text.size() &&
+           (static_cast<unsigned char>(text[length]) & 0xC0) == 0x80) {
+      --length;
+    }
+    std::memcpy(destination, text.data(), length);
+    destination[length] = '\0';
+    return length;
+  }
+}
+
+FileRecorder::FileRecorder(): FileRecorder(RecorderOptions{}) {}
+
+FileRecorder::FileRecorder(const RecorderOptions& options): options_(options) {
   battleLog_.open(ArenaConfig::Files::COMBAT_LOG_FILE, std::ios::app);
   movementLog_.open(ArenaConfig::Files::MOVEMENT_LOG_FILE, std::ios::app);
   eventLog_.open(ArenaConfig::Files::EVENT_LOG_FILE, std::ios::app);
+  
+  if (options_.async) {
+    queue_ = std::make_unique<LockFreeRing<LogRecord>>(options_.queueCapacity);
+    writer_ = std::thread(&FileRecorder::writerLoop, this);
+  }
+}
+
+const char* FileRecorder::timestamp(std::time_t now) {
+  if (now != cachedSecond_) {
+    std::tm timeinfo;
+    localtime_r(&now, &timeinfo);
+    std::strftime(cachedStamp_, sizeof(cachedStamp_), "[%Y-%m-%d %H:%M:%S] ", &timeinfo);
+    cachedSecond_ = now;
+  }
+  return cachedStamp_;
 }
 
 void FileRecorder::writeToLog(std::ofstream& stream, const std::string& message) {
   if (stream.is_open()) {
-    std::time_t now = std::time(nullptr);
-    std::tm* timeinfo = std::localtime(&now);
-    char buffer[80];
-    std::strftime(buffer, sizeof(buffer), "[%Y-%m-%d %H:%M:%S] ", timeinfo);
-    
-    stream << buffer << message << std::endl;
+    stream << timestamp(std::time(nullptr)) << message << std::endl;
   }
 }
 
-void FileRecorder::recordBattle(const NPC& victor, const NPC& defeated) {
-  std::lock_guard lock(fileMutex_);
-  std::string message = victor.getName() + " (" + victor.getTypeString() + 
-                       ") победил " + defeated.getName() + " (" + 
-                       defeated.getTypeString() + ")";
-  writeToLog(battleLog_, message);
+void FileRecorder::enqueue(const LogRecord& record) {
+  if (!queue_->tryPush(record)) {
+    droppedRecords_.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  
+  // Будим писателя заранее, пока очередь не переполнилась
+  if (queue_->sizeApprox() > queue_->capacity() / 2) {
+    wakeUp_.notify_one();
+  }
 }
 
-void FileRecorder::recordMovement(const NPC& creature, MoveDirection direction) {
+void FileRecorder::appendRecord(const LogRecord& record, std::string& battles,
+                                std::string& movements, std::string& events) {
+  const char* stamp = timestamp(record.time);
+  
+  if (record.kind == LogRecord::TEXT) {
+    events.append(stamp).append(record.text).append("\n");
+    return;
+  }
+  
+  const GameEvent& event = record.event;
+  switch (event.type) {
+    case BATTLE_EVENT:
+      battles.append(stamp).append(nameText(event.battle.victorName))
+             .append(" (").append(convertTypeToString(static_cast<NPCType>(event.battle.victorType)))
+             .append(") победил ").append(nameText(event.battle.defeatedName))
+             .append(" (").append(convertTypeToString(static_cast<NPCType>(event.battle.defeatedType)))
+             .append(")\n");
+      break;
+    case MOVE_EVENT:
+      movements.append(stamp).append(nameText(event.move.name))
+               .append(" переместился ")
+               .append(convertDirectionToString(static_cast<MoveDirection>(event.move.direction)))
+               .append(" в (").append(std::to_string(event.move.x))
+               .append(", ").append(std::to_string(event.move.y)).append(")\n");
+      break;
+    default:
+      events.append(stamp);
+      appendEventText(events, event);
+      events.append("\n");
+      break;
+  }
+}
+
+void FileRecorder::writerLoop() {
+  std::string battles, movements, events;
+  auto lastFlush = std::chrono::steady_clock::now();
+  
+  auto flush = [&]() {
+    if (!battles.empty() && battleLog_.is_open()) battleLog_.write(battles.data(), battles.size());
+    if (!movements.empty() && movementLog_.is_open()) movementLog_.write(movements.data(), movements.size());
+    if (!events.empty() && eventLog_.is_open()) eventLog_.write(events.data(), events.size());
+    battleLog_.flush();
+    movementLog_.flush();
+    eventLog_.flush();
+    battles.clear();
+    movements.clear();
+    events.clear();
+    lastFlush = std::chrono::steady_clock::now();
+  };
+  
+  while (true) {
+    const bool stopping = stopping_.load();
+    
+    LogRecord record;
+    size_t drained = 0;
+    while (queue_->tryPop(record)) {
+      appendRecord(record, battles, movements, events);
+      ++drained;
+    }
+    writtenRecords_.fetch_add(drained, std::memory_order_relaxed);
+    
+    const size_t pending = battles.size() + movements.size() + events.size();
+    const bool intervalPassed =
+        std::chrono::steady_clock::now() - lastFlush >= options_.flushInterval;
+    if (pending >= ArenaConfig::Logging::BATCH_BYTES || (pending > 0 && intervalPassed)) {
+      flush();
+    }
+    
+    if (stopping) {
+      break;
+    }
+    if (drained == 0) {
+      // Не меньше миллисекунды: при log_flush_interval < 4 целое деление
+      // дало бы 0 и простаивающий писатель крутился бы вхолостую
+      std::unique_lock lock(wakeMutex_);
+      wakeUp_.wait_for(lock, std::max(options_.flushInterval / 4, std::chrono::milliseconds(1)));
+    }
+  }
+  
+  const size_t dropped = droppedRecords_.load();
+  if (dropped > 0) {
+    events.append(timestamp(std::time(nullptr)))
+          .append("Асинхронный журнал: потеряно записей при переполнении: ")
+          .append(std::to_string(dropped)).append("\n");
+  }
+  flush();
+}
+
+void FileRecorder::deliver(const GameEvent* events, size_t count) {
+  const std::time_t now = std::time(nullptr);
+  
+  if (isAsync()) {
+    LogRecord record;
+    record.kind = LogRecord::GAME_EVENT;
+    record.time = now;
+    for (size_t i = 0; i < count; ++i) {
+      record.event = events[i];
+      enqueue(record);
+    }
+    return;
+  }
+  
+  // Синхронный режим: вся пачка форматируется и пишется за один захват
   std::lock_guard lock(fileMutex_);
-  std::string message = creature.getName() + " переместился " + 
-                       convertDirectionToString(direction) + " в (" + 
-                       std::to_string(creature.getX()) + ", " + 
-                       std::to_string(creature.getY()) + ")";
-  writeToLog(movementLog_, message);
+  std::string battles, movements, other;
+  LogRecord record;
+  record.kind = LogRecord::GAME_EVENT;
+  record.time = now;
+  for (size_t i = 0; i < count; ++i) {
+    record.event = events[i];
+    appendRecord(record, battles, movements, other);
+  }
+  
+  if (!battles.empty() && battleLog_.is_open()) battleLog_.write(battles.data(), battles.size()).flush();
+  if (!movements.empty() && movementLog_.is_open()) movementLog_.write(movements.data(), movements.size()).flush();
+  if (!other.empty() && eventLog_.is_open()) eventLog_.write(other.data(), other.size()).flush();
 }
 
 void FileRecorder::recordGameEvent(const std::string& event) {
+  if (isAsync()) {
+    LogRecord record;
+    record.kind = LogRecord::TEXT;
+    record.time = std::time(nullptr);
+    copyText(record.text, LogRecord::TEXT_CAPACITY, event);
+    enqueue(record);
+    return;
+  }
+  
   std::lock_guard lock(fileMutex_);
   writeToLog(eventLog_, event);
 }
@@ -94,6 +273,12 @@ void FileRecorder::displayWorldState(const std::vector<const NPC*>& creatures) {
 }
 
 FileRecorder::~FileRecorder() {
+  if (writer_.joinable()) {
+    stopping_ = true;
+    wakeUp_.notify_one();
+    writer_.join();
+  }
+  
   if (battleLog_.is_open()) battleLog_.close();
   if (movementLog_.is_open()) movementLog_.close();
   if (eventLog_.is_open()) eventLog_.close();
@@ -0,0 +1,57 @@
+#include "../../include/game/random_stream.hpp"
+#include <atomic>
+#include <random>
+
+namespace {
+  constexpr uint64_t GOLDEN_GAMMA = 0x9E3779B97F4A7C15ULL;
+
+  std::atomic<uint64_t> sharedSeed{generateSeed()};
+  std::atomic<uint64_t> sharedCounter{0};
+}
+
+uint64_t RandomStream::mix(uint64_t value) {
+  // Финализатор SplitMix64
+  value += GOLDEN_GAMMA;
+  value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+  return value ^ (value >> 31);
+}
+
+RandomStream::RandomStream(uint64_t seed, uint64_t tick, uint64_t id,
+                           RandomPurpose purpose, uint64_t subkey) {
+  key_ = mix(seed ^ purpose);
+  key_ = mix(key_ ^ tick);
+  key_ = mix(key_ ^ id);
+  key_ = mix(key_ ^ subkey);
+}
+
+uint64_t RandomStream::next() {
+  return mix(key_ + ++counter_ * GOLDEN_GAMMA);
+}
+
+int RandomStream::uniformInt(int low, int high) {
+  // Умножение со сдвигом: одинаковый результат на любой стандартной библиотеке
+  const uint64_t range = static_cast<uint64_t>(static_cast<int64_t>(high) - low) + 1;
+  const uint64_t offset = static_cast<uint64_t>(
+      (static_cast<unsigned __int128>(next()) * range) >> 64);
+  return static_cast<int>(low + static_cast<int64_t>(offset));
+}
+
+double RandomStream::uniformReal(double low, double high) {
+  const double unit = static_cast<double>(next() >> 11) * 0x1.0p-53;
+  return low + unit * (high - low);
+}
+
+void seedSharedRandom(uint64_t seed) {
+  sharedSeed = seed;
+  sharedCounter = 0;
+}
+
+RandomStream nextSharedStream(RandomPurpose purpose) {
+  return RandomStream(sharedSeed.load(), 0, sharedCounter.fetch_add(1), purpose);
+}
+
+uint64_t generateSeed() {
+  std::random_device rd;
+  return (static_cast<uint64_t>(rd()) << 32) ^ rd();
+}
@@ -0,0 +1,172 @@
+#include "../../include/game/range_kernel.hpp"
+#include <array>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define RANGE_KERNEL_X86 1
+#endif
+
+void CandidateBlock::pack(const CreatureStore& store, const std::vector<size_t>& ids) {
+  const size_t count = ids.size();
+  x.resize(count);
+  y.resize(count);
+  rangeSquared.resize(count);
+  preyMask.resize(count);
+  typeBit.resize(count);
+  
+  for (size_t k = 0; k < count; ++k) {
+    const size_t id = ids[k];
+    const NPCType type = store.type(id);
+    const double range = store.attackRange(id);
+    x[k] = store.x(id);
+    y[k] = store.y(id);
+    rangeSquared[k] = range * range;
+    preyMask[k] = type < NPC_TYPE_COUNT ? PREY_MASK[type] : 0;
+    typeBit[k] = type < NPC_TYPE_COUNT ? ::typeBit(type) : 0;
+  }
+}
+
+void CandidateBlock::clear() {
+  x.clear();
+  y.clear();
+  rangeSquared.clear();
+  preyMask.clear();
+  typeBit.clear();
+}
+
+void CandidateBlock::append(const CreatureStore& store, size_t id) {
+  const NPCType type = store.type(id);
+  const double range = store.attackRange(id);
+  x.push_back(store.x(id));
+  y.push_back(store.y(id));
+  rangeSquared.push_back(range * range);
+  preyMask.push_back(type < NPC_TYPE_COUNT ? PREY_MASK[type] : 0);
+  typeBit.push_back(type < NPC_TYPE_COUNT ? ::typeBit(type) : 0);
+}
+
+void CandidateBlock::append(const CandidateBlock& other, size_t begin, size_t end) {
+  x.insert(x.end(), other.x.begin() + begin, other.x.begin() + end);
+  y.insert(y.end(), other.y.begin() + begin, other.y.begin() + end);
+  rangeSquared.insert(rangeSquared.end(), other.rangeSquared.begin() + begin,
+                      other.rangeSquared.begin() + end);
+  preyMask.insert(preyMask.end(), other.preyMask.begin() + begin, other.preyMask.begin() + end);
+  typeBit.insert(typeBit.end(), other.typeBit.begin() + begin, other.typeBit.begin() + end);
+}
+
+RangeProbe RangeProbe::fromBlock(const CandidateBlock& block, size_t index) {
+  return RangeProbe{block.x[index], block.y[index], block.rangeSquared[index],
+                    block.preyMask[index], block.typeBit[index]};
+}
+
+void RangeKernel::testBlockScalar(const RangeProbe& probe, const CandidateBlock& block,
+                                  size_t begin, size_t end, uint8_t* hits) {
+  for (size_t k = begin; k < end; ++k) {
+    const double distanceX = probe.x - block.x[k];
+    const double distanceY = probe.y - block.y[k];
+    const double squared = distanceX * distanceX + distanceY * distanceY;
+    
+    uint8_t hit = 0;
+    if ((probe.preyMask & block.typeBit[k]) && squared <= probe.rangeSquared) {
+      hit |= PROBE_KILLS;
+    }
+    if ((block.preyMask[k] & probe.typeBit) && squared <= block.rangeSquared[k]) {
+      hit |= CANDIDATE_KILLS;
+    }
+    hits[k] = hit;
+  }
+}
+
+#ifdef RANGE_KERNEL_X86
+
+namespace {
+  // Раскладка двух 4-битных масок (зонд | кандидат << 4) в четыре байта RangeHit
+  constexpr std::array<uint32_t, 256> makeHitTable() {
+    std::array<uint32_t, 256> table{};
+    for (uint32_t masks = 0; masks < 256; ++masks) {
+      uint32_t packed = 0;
+      for (uint32_t lane = 0; lane < 4; ++lane) {
+        const uint32_t hit = ((masks >> lane) & 1u) | (((masks >> (lane + 4)) & 1u) << 1);
+        packed |= hit << (8 * lane);
+      }
+      table[masks] = packed;
+    }
+    return table;
+  }
+  
+  constexpr std::array<uint32_t, 256> HIT_TABLE = makeHitTable();
+}
+
+// Четыре кандидата за итерацию; FMA не включаем, чтобы квадраты
+// расстояний совпадали со скалярной версией бит в бит
+__attribute__((target("avx2")))
+void RangeKernel::testBlockAvx2(const RangeProbe& probe, const CandidateBlock& block,
+                                size_t begin, size_t end, uint8_t* hits) {
+  const __m256d probeX = _mm256_set1_pd(probe.x);
+  const __m256d probeY = _mm256_set1_pd(probe.y);
+  const __m256d probeRange = _mm256_set1_pd(probe.rangeSquared);
+  const __m256i probePrey = _mm256_set1_epi64x(probe.preyMask);
+  const __m256i probeBit = _mm256_set1_epi64x(probe.typeBit);
+  const __m256i zero = _mm256_setzero_si256();
+  
+  size_t k = begin;
+  for (; k + 4 <= end; k += 4) {
+    const __m256d distanceX = _mm256_sub_pd(probeX, _mm256_loadu_pd(&block.x[k]));
+    const __m256d distanceY = _mm256_sub_pd(probeY, _mm256_loadu_pd(&block.y[k]));
+    const __m256d squared = _mm256_add_pd(_mm256_mul_pd(distanceX, distanceX),
+                                          _mm256_mul_pd(distanceY, distanceY));
+    
+    int32_t packedBits;
+    int32_t packedPrey;
+    __builtin_memcpy(&packedBits, &block.typeBit[k], sizeof(packedBits));
+    __builtin_memcpy(&packedPrey, &block.preyMask[k], sizeof(packedPrey));
+    const __m256i candidateBit = _mm256_cvtepu8_epi64(_mm_cvtsi32_si128(packedBits));
+    const __m256i candidatePrey = _mm256_cvtepu8_epi64(_mm_cvtsi32_si128(packedPrey));
+    
+    const __m256d probeHunts = _mm256_castsi256_pd(_mm256_xor_si256(
+        _mm256_cmpeq_epi64(_mm256_and_si256(probePrey, candidateBit), zero),
+        _mm256_set1_epi64x(-1)));
+    const __m256d candidateHunts = _mm256_castsi256_pd(_mm256_xor_si256(
+        _mm256_cmpeq_epi64(_mm256_and_si256(candidatePrey, probeBit), zero),
+        _mm256_set1_epi64x(-1)));
+    
+    const __m256d probeReach = _mm256_cmp_pd(squared, probeRange, _CMP_LE_OQ);
+    const __m256d candidateReach = _mm256_cmp_pd(squared, _mm256_loadu_pd(&block.rangeSquared[k]),
+                                                 _CMP_LE_OQ);
+    
+    const int probeKills = _mm256_movemask_pd(_mm256_and_pd(probeHunts, probeReach));
+    const int candidateKills = _mm256_movemask_pd(_mm256_and_pd(candidateHunts, candidateReach));
+    const uint32_t packedHits = HIT_TABLE[probeKills | (candidateKills << 4)];
+    __builtin_memcpy(&hits[k], &packedHits, sizeof(packedHits));
+  }
+  
+  // Без этого хвостовой вызов скалярной версии платит за переход AVX -> SSE
+  _mm256_zeroupper();
+  testBlockScalar(probe, block, k, end, hits);
+}
+
+bool RangeKernel::avx2Supported() {
+  static const bool supported = __builtin_cpu_supports("avx2");
+  return supported;
+}
+
+#else
+
+void RangeKernel::testBlockAvx2(const RangeProbe& probe, const CandidateBlock& block,
+                                size_t begin, size_t end, uint8_t* hits) {
+  testBlockScalar(probe, block, begin, end, hits);
+}
+
+bool RangeKernel::avx2Supported() {
+  return false;
+}
+
+#endif
+
+RangeKernel::BlockTest RangeKernel::selected() {
+  static const BlockTest kernel = avx2Supported() ? testBlockAvx2 : testBlockScalar;
+  return kernel;
+}
+
+const char* RangeKernel::selectedName() {
+  return avx2Supported() ? "avx2" : "scalar";
+}
@@ -0,0 +1,332 @@
+#include "../../include/game/replay.hpp"
+#include "../../include/game/snapshot.hpp"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+  constexpr size_t ALIGNMENT = 8;
+
+  size_t padded(size_t size) {
+    return (size + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+  }
+
+  // Снимок хранит шаг и дальность во float: иначе мир из кадра разойдется
+  void checkKeyframeExact(const CreatureStore& creatures) {
+    for (size_t i = 0; i < creatures.size(); ++i) {
+      const double step = creatures.moveDistance(i);
+      const double range = creatures.attackRange(i);
+      if (static_cast<double>(static_cast<float>(step)) != step ||
+          static_cast<double>(static_cast<float>(range)) != range) {
+        throw std::invalid_argument("Шаг или дальность существа " + std::to_string(i) +
+                                    " не представимы в снимке точно - повтор разойдется");
+      }
+    }
+  }
+}
+
+uint64_t Replay::stateChecksum(const CreatureStore& creatures) {
+  const size_t count = creatures.size();
+  uint64_t hash = Snapshot::checksum(creatures.xData(), count * sizeof(double));
+  hash = Snapshot::checksum(creatures.yData(), count * sizeof(double), hash);
+  return Snapshot::checksum(creatures.aliveData(), count, hash);
+}
+
+Replay::Recorder::Recorder(const std::string& fileName, DungeonMaster& world, uint64_t keyframeInterval)
+    : world_(world) {
+  if (keyframeInterval == 0) {
+    throw std::invalid_argument("Интервал опорных кадров должен быть положительным");
+  }
+
+  out_.open(fileName, std::ios::binary | std::ios::trunc);
+  if (!out_.is_open()) {
+    throw std::invalid_argument("Не удалось открыть файл повтора для записи");
+  }
+
+  std::memset(&header_, 0, sizeof(header_));
+  std::memcpy(header_.magic, MAGIC, sizeof(MAGIC));
+  header_.version = VERSION;
+  header_.headerSize = sizeof(Header);
+  header_.seed = world_.getSeed();
+  header_.startTick = world_.getTick();
+  header_.keyframeInterval = keyframeInterval;
+  const ArenaSettings& settings = arenaSettings();
+  header_.world = settings.world;
+  for (size_t type = 0; type < NPC_TYPE_COUNT; ++type) {
+    header_.step[type] = settings.step[type];
+    header_.range[type] = settings.range[type];
+  }
+  out_.write(reinterpret_cast<const char*>(&header_), sizeof(header_));
+  stats_.bytes = sizeof(header_);
+
+  writeKeyframe();
+  world_.setInputListener(this);
+}
+
+Replay::Recorder::~Recorder() {
+  try {
+    close();
+  } catch (const std::exception&) {
+    // Деструктор не бросает; ошибку увидит явный close()
+  }
+}
+
+void Replay::Recorder::writeRecord(uint64_t tick, RecordKind kind, const void* data, size_t size,
+                                   const std::string& tail) {
+  static const char ZEROS[ALIGNMENT] = {};
+
+  RecordHeader record;
+  std::memset(&record, 0, sizeof(record));
+  record.tick = tick;
+  record.kind = kind;
+  record.size = size + tail.size();
+
+  out_.write(reinterpret_cast<const char*>(&record), sizeof(record));
+  out_.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+  out_.write(tail.data(), static_cast<std::streamsize>(tail.size()));
+  out_.write(ZEROS, static_cast<std::streamsize>(padded(record.size) - record.size));
+  if (!out_) {
+    throw std::runtime_error("Ошибка записи повтора");
+  }
+  stats_.bytes += sizeof(record) + padded(record.size);
+}
+
+void Replay::Recorder::writeKeyframe() {
+  std::string bytes;
+  uint64_t tick = 0;
+  world_.readFrame([&](const DungeonMaster::WorldFrame& frame) {
+    checkKeyframeExact(frame.creatures);
+    bytes = Snapshot::encode(frame.creatures, frame.seed, frame.tick);
+    tick = frame.tick;
+  });
+
+  std::lock_guard lock(writeMutex_);
+  writeRecord(tick, KEYFRAME, bytes.data(), bytes.size());
+  lastKeyframe_ = tick;
+  ++stats_.keyframes;
+}
+
+void Replay::Recorder::onSpawn(uint64_t tick, NPCType type, double x, double y,
+                               const std::string& name) {
+  SpawnInput input;
+  std::memset(&input, 0, sizeof(input));
+  input.x = x;
+  input.y = y;
+  input.type = static_cast<uint8_t>(type);
+  input.nameLength = static_cast<uint32_t>(name.size());
+
+  std::lock_guard lock(writeMutex_);
+  writeRecord(tick, SPAWN, &input, sizeof(input), name);
+  ++stats_.inputs;
+}
+
+void Replay::Recorder::onRelocate(uint64_t tick, size_t index, MoveDirection direction) {
+  RelocateInput input;
+  std::memset(&input, 0, sizeof(input));
+  input.index = index;
+  input.direction = static_cast<uint8_t>(direction);
+
+  std::lock_guard lock(writeMutex_);
+  writeRecord(tick, RELOCATE, &input, sizeof(input));
+  ++stats_.inputs;
+}
+
+void Replay::Recorder::afterTick() {
+  ++stats_.ticks;
+  if (world_.getTick() - lastKeyframe_ >= header_.keyframeInterval) {
+    writeKeyframe();
+  }
+}
+
+void Replay::Recorder::close() {
+  if (closed_) return;
+  closed_ = true;
+  world_.setInputListener(nullptr);
+
+  Footer footer;
+  std::memset(&footer, 0, sizeof(footer));
+  world_.readFrame([&](const DungeonMaster::WorldFrame& frame) {
+    footer.endTick = frame.tick;
+    footer.finalChecksum = stateChecksum(frame.creatures);
+  });
+  std::memcpy(footer.magic, FOOTER_MAGIC, sizeof(FOOTER_MAGIC));
+
+  out_.write(reinterpret_cast<const char*>(&footer), sizeof(footer));
+  out_.close();
+  if (!out_) {
+    throw std::runtime_error("Ошибка записи повтора");
+  }
+  stats_.bytes += sizeof(footer);
+}
+
+Replay::Player::Player(const std::string& fileName) : fileName_(fileName) {
+  int fd = ::open(fileName.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw std::invalid_argument("Не удалось открыть файл повтора для чтения");
+  }
+
+  struct stat info;
+  if (::fstat(fd, &info) != 0 ||
+      static_cast<size_t>(info.st_size) < sizeof(Header) + sizeof(Footer)) {
+    ::close(fd);
+    throw std::runtime_error("Файл повтора поврежден: " + fileName);
+  }
+
+  size_ = static_cast<size_t>(info.st_size);
+  mapping_ = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (mapping_ == MAP_FAILED) {
+    mapping_ = nullptr;
+    throw std::runtime_error("Не удалось отобразить повтор в память: " + fileName);
+  }
+
+  try {
+    parse();
+  } catch (...) {
+    ::munmap(mapping_, size_);
+    throw;
+  }
+}
+
+Replay::Player::~Player() {
+  if (mapping_ != nullptr) {
+    ::munmap(mapping_, size_);
+  }
+}
+
+void Replay::Player::parse() {
+  const auto* base = static_cast<const char*>(mapping_);
+  header_ = reinterpret_cast<const Header*>(base);
+  footer_ = reinterpret_cast<const Footer*>(base + size_ - sizeof(Footer));
+
+  if (std::memcmp(header_->magic, MAGIC, sizeof(MAGIC)) != 0) {
+    throw std::runtime_error("Файл не является повтором арены: " + fileName_);
+  }
+  if (header_->version != VERSION || header_->headerSize != sizeof(Header)) {
+    throw std::runtime_error("Неподдерживаемая версия повтора: " + fileName_);
+  }
+  // Без конца файла запись не закрыта (процесс прервали)
+  if (std::memcmp(footer_->magic, FOOTER_MAGIC, sizeof(FOOTER_MAGIC)) != 0) {
+    throw std::runtime_error("Запись повтора не закрыта: " + fileName_);
+  }
+
+  const auto corrupted = [this]() {
+    return std::runtime_error("Файл повтора поврежден: " + fileName_);
+  };
+
+  const size_t end = size_ - sizeof(Footer);
+  size_t offset = sizeof(Header);
+  while (offset < end) {
+    if (end - offset < sizeof(RecordHeader)) throw corrupted();
+    const auto* record = reinterpret_cast<const RecordHeader*>(base + offset);
+    const size_t data = offset + sizeof(RecordHeader);
+    if (record->size > end - data || padded(record->size) > end - data) throw corrupted();
+
+    switch (record->kind) {
+      case KEYFRAME:
+        if (!keyframes_.empty() && record->tick < keyframes_.back().tick) throw corrupted();
+        keyframes_.push_back(Keyframe{record->tick, data, record->size, inputs_.size()});
+        break;
+      case SPAWN: {
+        if (record->size < sizeof(SpawnInput)) throw corrupted();
+        const auto* input = reinterpret_cast<const SpawnInput*>(base + data);
+        if (input->nameLength != record->size - sizeof(SpawnInput) ||
+            input->type < KNIGHT || input->type > DRAGON) {
+          throw corrupted();
+        }
+        inputs_.push_back(Input{record->tick, SPAWN, static_cast<NPCType>(input->type),
+                                input->x, input->y,
+                                std::string(base + data + sizeof(SpawnInput), input->nameLength),
+                                0, TOP});
+        break;
+      }
+      case RELOCATE: {
+        if (record->size != sizeof(RelocateInput)) throw corrupted();
+        const auto* input = reinterpret_cast<const RelocateInput*>(base + data);
+        if (input->direction > LEFT) throw corrupted();
+        inputs_.push_back(Input{record->tick, RELOCATE, UNKNOWN, 0, 0, "",
+                                static_cast<size_t>(input->index),
+                                static_cast<MoveDirection>(input->direction)});
+        break;
+      }
+      default:
+        throw corrupted();
+    }
+    offset = data + padded(record->size);
+  }
+
+  if (keyframes_.empty() || keyframes_.front().tick != header_->startTick ||
+      footer_->endTick < keyframes_.back().tick) {
+    throw corrupted();
+  }
+}
+
+void Replay::Player::applySettings(ArenaSettings& settings) const {
+  settings.world = header_->world;
+  for (size_t type = 0; type < NPC_TYPE_COUNT; ++type) {
+    settings.step[type] = header_->step[type];
+    settings.range[type] = header_->range[type];
+  }
+}
+
+uint64_t Replay::Player::restore(DungeonMaster& world, uint64_t target) {
+  // Иначе повторенные появления получат другие шаг и дальность
+  ArenaSettings recorded = arenaSettings();
+  applySettings(recorded);
+  if (!(recorded.world == arenaSettings().world) || recorded.step != arenaSettings().step ||
+      recorded.range != arenaSettings().range) {
+    throw std::logic_error("Мир, шаги или дальности процесса не совпадают с записью повтора");
+  }
+  if (target < startTick() || target > endTick()) {
+    throw std::out_of_range("Тик " + std::to_string(target) + " вне записи повтора (" +
+                            std::to_string(startTick()) + ".." + std::to_string(endTick()) + ")");
+  }
+  if (world.getCreatureCount() != 0) {
+    throw std::logic_error("Повтор восстанавливается только в пустой мир");
+  }
+
+  auto keyframe = std::upper_bound(keyframes_.begin(), keyframes_.end(), target,
+      [](uint64_t tick, const Keyframe& frame) { return tick < frame.tick; });
+  --keyframe;
+
+  const auto* base = static_cast<const char*>(mapping_);
+  Snapshot::View snapshot(base + keyframe->offset, keyframe->size, fileName_);
+  world.loadSnapshot(snapshot, fileName_);
+  nextInput_ = keyframe->firstInput;
+  return keyframe->tick;
+}
+
+size_t Replay::Player::applyInputs(DungeonMaster& world) {
+  const uint64_t tick = world.getTick();
+  size_t applied = 0;
+  for (; nextInput_ < inputs_.size() && inputs_[nextInput_].tick <= tick; ++nextInput_) {
+    const Input& input = inputs_[nextInput_];
+    if (input.tick < tick) {
+      throw std::logic_error("Воздействие тика " + std::to_string(input.tick) + " пропущено");
+    }
+    if (input.kind == SPAWN) {
+      world.spawnCreature(input.type, input.x, input.y, input.name);
+    } else {
+      world.relocateCreature(input.index, input.direction);
+    }
+    ++applied;
+  }
+  return applied;
+}
+
+bool Replay::Player::finish(DungeonMaster& world) {
+  if (world.getTick() != endTick()) {
+    throw std::logic_error("Повтор не дошел до конца записи");
+  }
+  applyInputs(world);
+
+  uint64_t actual = 0;
+  world.readFrame([&](const DungeonMaster::WorldFrame& frame) {
+    actual = stateChecksum(frame.creatures);
+  });
+  return actual == footer_->finalChecksum;
+}
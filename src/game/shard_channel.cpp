@@ -0,0 +1,98 @@
+#include "../../include/game/shard_channel.hpp"
+#include <cerrno>
+#include <string>
+#include <utility>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+  struct MessageHeader {
+    uint32_t type;
+    uint32_t reserved;
+    uint64_t size;
+  };
+
+  std::runtime_error channelError(const std::string& what) {
+    return std::runtime_error("Обмен с шардом: " + what + " (errno " + std::to_string(errno) + ")");
+  }
+}
+
+ShardChannel::~ShardChannel() {
+  close();
+}
+
+ShardChannel::ShardChannel(ShardChannel&& other) noexcept
+    : fd_(std::exchange(other.fd_, -1)),
+      bytesSent_(other.bytesSent_),
+      bytesReceived_(other.bytesReceived_) {}
+
+ShardChannel& ShardChannel::operator=(ShardChannel&& other) noexcept {
+  if (this != &other) {
+    close();
+    fd_ = std::exchange(other.fd_, -1);
+    bytesSent_ = other.bytesSent_;
+    bytesReceived_ = other.bytesReceived_;
+  }
+  return *this;
+}
+
+void ShardChannel::makePair(ShardChannel& coordinator, ShardChannel& shard) {
+  int fds[2];
+  if (::socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+    throw channelError("не удалось создать сокет");
+  }
+  coordinator = ShardChannel(fds[0]);
+  shard = ShardChannel(fds[1]);
+}
+
+void ShardChannel::close() {
+  if (fd_ >= 0) {
+    ::close(fd_);
+    fd_ = -1;
+  }
+}
+
+void ShardChannel::writeAll(const void* data, size_t size) {
+  const auto* bytes = static_cast<const uint8_t*>(data);
+  while (size > 0) {
+    const ssize_t written = ::send(fd_, bytes, size, MSG_NOSIGNAL);
+    if (written < 0) {
+      if (errno == EINTR) continue;
+      throw channelError("ошибка записи");
+    }
+    bytes += written;
+    size -= static_cast<size_t>(written);
+    bytesSent_ += static_cast<size_t>(written);
+  }
+}
+
+void ShardChannel::readAll(void* data, size_t size) {
+  auto* bytes = static_cast<uint8_t*>(data);
+  while (size > 0) {
+    const ssize_t got = ::recv(fd_, bytes, size, 0);
+    if (got < 0) {
+      if (errno == EINTR) continue;
+      throw channelError("ошибка чтения");
+    }
+    if (got == 0) {
+      throw channelError("соединение закрыто");
+    }
+    bytes += got;
+    size -= static_cast<size_t>(got);
+    bytesReceived_ += static_cast<size_t>(got);
+  }
+}
+
+void ShardChannel::send(ShardMessage type, const MessageBuffer& body) {
+  const MessageHeader header{type, 0, body.size()};
+  writeAll(&header, sizeof(header));
+  writeAll(body.data(), body.size());
+}
+
+ShardMessage ShardChannel::receive(MessageBuffer& body) {
+  MessageHeader header;
+  readAll(&header, sizeof(header));
+  body.assign(header.size);
+  readAll(body.writable(), header.size);
+  return static_cast<ShardMessage>(header.type);
+}
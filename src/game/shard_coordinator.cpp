@@ -0,0 +1,269 @@
+#include "../../include/game/shard_coordinator.hpp"
+#include "../../include/game/combat_components.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+  bool shardPairOrder(const ShardPair& lhs, const ShardPair& rhs) {
+    return std::minmax(lhs.first, lhs.second) < std::minmax(rhs.first, rhs.second);
+  }
+
+  bool shardBattleOrder(const ShardBattle& lhs, const ShardBattle& rhs) {
+    return shardPairOrder(lhs.pair, rhs.pair);
+  }
+}
+
+ShardCoordinator::ShardCoordinator(DungeonMaster& world, size_t shards)
+    : world_(world),
+      layout_(SpatialGrid(), shards) {
+  if (shards < 2) {
+    throw std::invalid_argument("Распределенной арене нужно хотя бы два шарда");
+  }
+  // Потомок fork() наследует только вызвавший поток: мьютексы и состояние
+  // аллокатора, захваченные другими потоками, остались бы занятыми навсегда
+  if (world_.getWorkerThreads() > 1) {
+    throw std::logic_error("Шарды запускаются из мира без рабочих потоков");
+  }
+
+  world_.readFrame([&](const DungeonMaster::WorldFrame& frame) {
+    creatures_.copyFrom(frame.creatures);
+    seed_ = frame.seed;
+    tick_ = frame.tick;
+    stats_ = frame.stats;
+  });
+  shardStats_.shards = shards;
+  requests_.resize(shards);
+  replies_.resize(shards);
+
+  for (size_t k = 0; k < shards; ++k) {
+    ShardChannel coordinatorEnd;
+    ShardChannel shardEnd;
+    ShardChannel::makePair(coordinatorEnd, shardEnd);
+
+    const pid_t process = ::fork();
+    if (process < 0) {
+      stop();
+      throw std::runtime_error("Не удалось запустить процесс шарда");
+    }
+    if (process == 0) {
+      // Процесс шарда не трогает мир и его пул и выходит без деструкторов
+      TraceRecorder::detachProcess();
+      coordinatorEnd.close();
+      for (auto& channel : channels_) {
+        channel.close();
+      }
+      int status = 0;
+      try {
+        ArenaShard shard(creatures_, seed_, tick_, shards, k);
+        shard.serve(shardEnd);
+      } catch (const std::exception& e) {
+        std::cerr << "Шард " << k << ": " << e.what() << std::endl;
+        status = 1;
+      }
+      std::_Exit(status);
+    }
+
+    channels_.push_back(std::move(coordinatorEnd));
+    processes_.push_back(process);
+  }
+}
+
+ShardCoordinator::~ShardCoordinator() {
+  stop();
+}
+
+void ShardCoordinator::stop() {
+  const MessageBuffer empty;
+  for (auto& channel : channels_) {
+    try {
+      channel.send(SHARD_STOP, empty);
+    } catch (const std::exception&) {
+      // Шард уже завершился - ждем его ниже
+    }
+    channel.close();
+  }
+  for (pid_t process : processes_) {
+    int status = 0;
+    ::waitpid(process, &status, 0);
+  }
+  channels_.clear();
+  processes_.clear();
+}
+
+void ShardCoordinator::clearRequests() {
+  for (auto& request : requests_) {
+    request.clear();
+  }
+}
+
+void ShardCoordinator::exchange(ShardMessage type) {
+  // Шард читает запрос целиком до ответа, поэтому запись всем подряд
+  // не блокирует чтение ответов
+  for (size_t k = 0; k < channels_.size(); ++k) {
+    channels_[k].send(type, requests_[k]);
+  }
+  for (size_t k = 0; k < channels_.size(); ++k) {
+    if (channels_[k].receive(replies_[k]) != type) {
+      throw std::runtime_error("Шард ответил не на ту команду");
+    }
+  }
+}
+
+void ShardCoordinator::runTick() {
+  const size_t shards = channels_.size();
+  ++tick_;
+  shardStats_.migrants = 0;
+  shardStats_.haloCreatures = 0;
+  shardStats_.pairTests = 0;
+
+  // Движение: эмигранты раскладываются по получателям
+  clearRequests();
+  for (auto& request : requests_) {
+    request.put(tick_);
+  }
+  exchange(SHARD_TICK);
+  std::vector<std::vector<ShardCreature>> arrivals(shards);
+  std::vector<ShardCreature> received;
+  for (size_t k = 0; k < shards; ++k) {
+    for (size_t target = 0; target < shards; ++target) {
+      replies_[k].getVector(received);
+      arrivals[target].insert(arrivals[target].end(), received.begin(), received.end());
+      shardStats_.migrants += received.size();
+    }
+  }
+
+  // Мигранты; в ответ - ореол для шарда выше
+  clearRequests();
+  for (size_t k = 0; k < shards; ++k) {
+    requests_[k].putVector(arrivals[k]);
+  }
+  exchange(SHARD_IMMIGRANTS);
+  std::vector<std::vector<ShardCreature>> halos(shards);
+  for (size_t k = 0; k < shards; ++k) {
+    replies_[k].getVector(halos[k]);
+    shardStats_.haloCreatures += halos[k].size();
+  }
+
+  // Поиск боев; пограничные существа шарда ниже уходят ему
+  clearRequests();
+  for (size_t k = 0; k < shards; ++k) {
+    requests_[k].putVector(k + 1 < shards ? halos[k + 1] : std::vector<ShardCreature>());
+  }
+  exchange(SHARD_HALO);
+  std::vector<std::vector<uint64_t>> borders(shards);
+  for (size_t k = 0; k < shards; ++k) {
+    shardStats_.pairTests += replies_[k].get<uint64_t>();
+    replies_[k].getVector(borders[k]);
+  }
+
+  // Локальные бои в шардах
+  clearRequests();
+  for (size_t k = 0; k < shards; ++k) {
+    requests_[k].putVector(k > 0 ? borders[k - 1] : std::vector<uint64_t>());
+  }
+  exchange(SHARD_BORDER);
+  std::vector<std::vector<ShardBattle>> battleLists(shards + 1);
+  std::vector<std::vector<ShardPair>> deferredLists(shards);
+  std::vector<ShardCreature> participants;
+  for (size_t k = 0; k < shards; ++k) {
+    replies_[k].getVector(battleLists[k]);
+    replies_[k].getVector(deferredLists[k]);
+    replies_[k].getVector(participants);
+    for (const auto& creature : participants) {
+      creatures_.setPosition(creature.id, creature.x, creature.y, false);
+      creatures_.setAlive(creature.id, creature.alive != 0);
+    }
+  }
+
+  // Пограничные бои - здесь, в общем порядке пар
+  std::vector<const std::vector<ShardPair>*> deferredPtrs;
+  for (const auto& list : deferredLists) {
+    deferredPtrs.push_back(&list);
+  }
+  std::vector<ShardPair> deferred;
+  mergeSorted(deferredPtrs, deferred, shardPairOrder);
+  shardStats_.deferredCombats = deferred.size();
+
+  CombatMediator mediator(creatures_, &world_.getEventBus(), seed_, tick_);
+  std::vector<std::vector<uint64_t>> deaths(shards);
+  auto& deferredBattles = battleLists[shards];
+  for (const auto& combat : deferred) {
+    if (!creatures_.isAlive(combat.first) || !creatures_.isAlive(combat.second)) continue;
+
+    const BattleOutcome outcome = mediator.decide(NPC(creatures_, combat.first),
+                                                  NPC(creatures_, combat.second));
+    if (outcome == NO_CONTEST) continue;
+
+    const size_t loser = outcome == ATTACKER_VICTORY ? combat.second : combat.first;
+    creatures_.setAlive(loser, false);
+    const int cell = grid_.cellIndex(creatures_.x(loser), creatures_.y(loser));
+    deaths[layout_.shardOfCell(cell)].push_back(loser);
+    deferredBattles.push_back(ShardBattle{combat, static_cast<uint32_t>(outcome), 0});
+  }
+
+  // Журнал боев тика - в порядке пар, как у одного процесса
+  std::vector<const std::vector<ShardBattle>*> battlePtrs;
+  for (const auto& list : battleLists) {
+    battlePtrs.push_back(&list);
+  }
+  std::vector<ShardBattle> battles;
+  mergeSorted(battlePtrs, battles, shardBattleOrder);
+  for (const auto& battle : battles) {
+    NPC attacker(creatures_, battle.pair.first);
+    NPC defender(creatures_, battle.pair.second);
+    mediator.report(attacker, defender, static_cast<BattleOutcome>(battle.outcome));
+  }
+
+  // Смерти владельцам; счетчики шардов складываются
+  clearRequests();
+  for (size_t k = 0; k < shards; ++k) {
+    requests_[k].putVector(deaths[k]);
+  }
+  exchange(SHARD_DEATHS);
+  stats_ = DungeonMaster::GameStats{static_cast<int>(creatures_.size()), 0, 0, 0, 0};
+  for (auto& reply : replies_) {
+    const auto counts = reply.get<ShardCounts>();
+    stats_.aliveCreatures += static_cast<int>(counts.alive);
+    stats_.knights += static_cast<int>(counts.knights);
+    stats_.elves += static_cast<int>(counts.elves);
+    stats_.dragons += static_cast<int>(counts.dragons);
+  }
+
+  auto& events = world_.getEventBus();
+  if (events.wants(TICK_EVENT)) {
+    events.publish(makeTickEvent(tick_, static_cast<uint32_t>(stats_.aliveCreatures),
+                                 static_cast<uint32_t>(battles.size())));
+  }
+  world_.flushEvents();
+}
+
+void ShardCoordinator::collect() {
+  clearRequests();
+  exchange(SHARD_COLLECT);
+
+  std::vector<DungeonMaster::CreatureState> states;
+  std::vector<ShardCreature> owned;
+  for (auto& reply : replies_) {
+    reply.getVector(owned);
+    for (const auto& creature : owned) {
+      states.push_back(DungeonMaster::CreatureState{creature.id, creature.x, creature.y,
+                                                    creature.alive != 0});
+    }
+  }
+  world_.restoreCreatures(states, tick_);
+}
+
+ShardCoordinator::Stats ShardCoordinator::getShardStats() const {
+  Stats stats = shardStats_;
+  stats.bytesSent = 0;
+  stats.bytesReceived = 0;
+  for (const auto& channel : channels_) {
+    stats.bytesSent += channel.getBytesSent();
+    stats.bytesReceived += channel.getBytesReceived();
+  }
+  return stats;
+}
@@ -0,0 +1,205 @@
+#include "../../include/game/snapshot.hpp"
+#include <fstream>
+#include <stdexcept>
+#include <cstring>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+  constexpr uint64_t PRIME_1 = 0x9E3779B185EBCA87ULL;
+  constexpr uint64_t PRIME_2 = 0xC2B2AE3D27D4EB4FULL;
+  constexpr uint64_t PRIME_3 = 0x165667B19E3779F9ULL;
+  
+  uint64_t rotateLeft(uint64_t value, int bits) {
+    return (value << bits) | (value >> (64 - bits));
+  }
+  
+  uint64_t round(uint64_t accumulator, uint64_t word) {
+    return rotateLeft(accumulator + word * PRIME_2, 31) * PRIME_1;
+  }
+}
+
+uint64_t Snapshot::checksum(const void* data, size_t size, uint64_t seed) {
+  // Четыре независимые полосы по 8 байт (по мотивам xxHash64)
+  const auto* bytes = static_cast<const unsigned char*>(data);
+  uint64_t lanes[4] = {seed + PRIME_1, seed + PRIME_2, seed, seed - PRIME_1};
+  
+  size_t offset = 0;
+  for (; offset + 32 <= size; offset += 32) {
+    for (int lane = 0; lane < 4; ++lane) {
+      uint64_t word;
+      std::memcpy(&word, bytes + offset + lane * 8, sizeof(word));
+      lanes[lane] = round(lanes[lane], word);
+    }
+  }
+  
+  uint64_t hash = rotateLeft(lanes[0], 1) + rotateLeft(lanes[1], 7) +
+                  rotateLeft(lanes[2], 12) + rotateLeft(lanes[3], 18);
+  for (; offset < size; ++offset) {
+    hash = rotateLeft(hash ^ (bytes[offset] * PRIME_3), 11) * PRIME_1;
+  }
+  
+  hash ^= size;
+  hash ^= hash >> 33;
+  hash *= PRIME_2;
+  hash ^= hash >> 29;
+  return hash;
+}
+
+bool Snapshot::looksLikeSnapshot(const std::string& fileName) {
+  std::ifstream in(fileName, std::ios::binary);
+  char magic[sizeof(MAGIC)] = {};
+  return in.read(magic, sizeof(magic)) && std::memcmp(magic, MAGIC, sizeof(MAGIC)) == 0;
+}
+
+std::string Snapshot::encode(const CreatureStore& store, uint64_t seed, uint64_t tick) {
+  std::vector<Creature> records(store.size());
+  std::string names;
+  
+  for (size_t i = 0; i < store.size(); ++i) {
+    const std::string_view name = store.name(i);
+    Creature& record = records[i];
+    std::memset(&record, 0, sizeof(record));
+    record.x = store.x(i);
+    record.y = store.y(i);
+    record.moveDistance = static_cast<float>(store.moveDistance(i));
+    record.attackRange = static_cast<float>(store.attackRange(i));
+    record.nameOffset = static_cast<uint32_t>(names.size());
+    record.nameLength = static_cast<uint32_t>(name.size());
+    record.type = static_cast<uint8_t>(store.type(i));
+    record.alive = store.isAlive(i) ? 1 : 0;
+    names += name;
+  }
+  
+  Header header;
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+  header.version = VERSION;
+  header.headerSize = sizeof(Header);
+  header.creatureCount = records.size();
+  header.recordsOffset = sizeof(Header);
+  header.namesOffset = header.recordsOffset + records.size() * sizeof(Creature);
+  header.namesSize = names.size();
+  header.seed = seed;
+  header.tick = tick;
+  header.checksum = checksum(names.data(), names.size(),
+                             checksum(records.data(), records.size() * sizeof(Creature)));
+  
+  std::string bytes;
+  bytes.reserve(sizeof(header) + records.size() * sizeof(Creature) + names.size());
+  bytes.append(reinterpret_cast<const char*>(&header), sizeof(header));
+  bytes.append(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(Creature));
+  bytes.append(names);
+  return bytes;
+}
+
+void Snapshot::write(const std::string& fileName, const CreatureStore& store,
+                     uint64_t seed, uint64_t tick) {
+  const std::string bytes = encode(store, seed, tick);
+  
+  std::ofstream out(fileName, std::ios::binary | std::ios::trunc);
+  if (!out.is_open()) {
+    throw std::invalid_argument("Не удалось открыть файл для записи");
+  }
+  
+  out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+  if (!out) {
+    throw std::runtime_error("Ошибка записи снимка: " + fileName);
+  }
+}
+
+Snapshot::View::View(const std::string& fileName) {
+  int fd = ::open(fileName.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw std::invalid_argument("Не удалось открыть файл для чтения");
+  }
+  
+  struct stat info;
+  if (::fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(Header)) {
+    ::close(fd);
+    throw std::runtime_error("Файл снимка поврежден: " + fileName);
+  }
+  
+  size_ = static_cast<size_t>(info.st_size);
+  mapping_ = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (mapping_ == MAP_FAILED) {
+    mapping_ = nullptr;
+    throw std::runtime_error("Не удалось отобразить снимок в память: " + fileName);
+  }
+  
+  try {
+    attach(fileName);
+  } catch (...) {
+    ::munmap(mapping_, size_);
+    throw;
+  }
+}
+
+Snapshot::View::View(const char* data, size_t size, const std::string& source) : size_(size) {
+  if (size_ < sizeof(Header)) {
+    throw std::runtime_error("Файл снимка поврежден: " + source);
+  }
+  base_ = data;
+  attach(source);
+}
+
+void Snapshot::View::attach(const std::string& source) {
+  if (mapping_ != nullptr) {
+    base_ = static_cast<const char*>(mapping_);
+  }
+  // Записи читаются прямо из буфера: он должен быть выровнен под Header
+  if (reinterpret_cast<uintptr_t>(base_) % alignof(Header) != 0) {
+    throw std::runtime_error("Снимок не выровнен в памяти: " + source);
+  }
+  header_ = reinterpret_cast<const Header*>(base_);
+  validate(source);
+  
+  creatures_ = reinterpret_cast<const Creature*>(base_ + header_->recordsOffset);
+  names_ = base_ + header_->namesOffset;
+}
+
+void Snapshot::View::validate(const std::string& fileName) const {
+  const Header& header = *header_;
+  if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0) {
+    throw std::runtime_error("Файл не является снимком арены: " + fileName);
+  }
+  if (header.version != VERSION || header.headerSize != sizeof(Header)) {
+    throw std::runtime_error("Неподдерживаемая версия снимка: " + fileName);
+  }
+  
+  const uint64_t recordsSize = header.creatureCount * sizeof(Creature);
+  if (header.recordsOffset != sizeof(Header) ||
+      header.creatureCount > size_ / sizeof(Creature) ||
+      header.namesOffset != header.recordsOffset + recordsSize ||
+      header.namesOffset + header.namesSize != size_) {
+    throw std::runtime_error("Файл снимка поврежден: " + fileName);
+  }
+  
+  const uint64_t actual = checksum(base_ + header.namesOffset, header.namesSize,
+                                   checksum(base_ + header.recordsOffset, recordsSize));
+  if (actual != header.checksum) {
+    throw std::runtime_error("Контрольная сумма снимка не совпадает: " + fileName);
+  }
+  
+  const auto* records = reinterpret_cast<const Creature*>(base_ + header.recordsOffset);
+  for (uint64_t i = 0; i < header.creatureCount; ++i) {
+    if (static_cast<uint64_t>(records[i].nameOffset) + records[i].nameLength > header.namesSize) {
+      throw std::runtime_error("Файл снимка поврежден: " + fileName);
+    }
+  }
+}
+
+Snapshot::View::~View() {
+  if (mapping_ != nullptr) {
+    ::munmap(mapping_, size_);
+  }
+}
+
+std::string_view Snapshot::View::name(size_t index) const {
+  const Creature& record = creatures_[index];
+  return std::string_view(names_ + record.nameOffset, record.nameLength);
+}
@@ -0,0 +1,116 @@
+#include "../../include/game/spatial_grid.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+SpatialGrid::SpatialGrid(): SpatialGrid(arenaSettings().maxAttackRange()) {}
+
+SpatialGrid::SpatialGrid(double cellSize, const WorldBounds& bounds)
+    : cellSize_(cellSize), originX_(bounds.minX), originY_(bounds.minY) {
+  cells_.resize(cellCount(bounds, cellSize_));
+  columns_ = cellsAcross(bounds.maxX - bounds.minX, cellSize_);
+  rows_ = cellsAcross(bounds.maxY - bounds.minY, cellSize_);
+}
+
+int SpatialGrid::cellsAcross(double extent, double cellSize) {
+  // Считаем в double: приведение бесконечности или 1e12 к int - UB
+  const double cells = std::ceil(extent / cellSize);
+  if (!(cells <= static_cast<double>(ArenaConfig::Sharding::MAX_GRID_CELLS))) {
+    throw std::length_error("Сетка боев больше " + std::to_string(ArenaConfig::Sharding::MAX_GRID_CELLS) +
+                            " ячеек: сторона " + std::to_string(extent) + " при ячейке " +
+                            std::to_string(cellSize));
+  }
+  return std::max(1, static_cast<int>(cells));
+}
+
+size_t SpatialGrid::cellCount(const WorldBounds& bounds, double cellSize) {
+  const size_t columns = static_cast<size_t>(cellsAcross(bounds.maxX - bounds.minX, cellSize));
+  const size_t rows = static_cast<size_t>(cellsAcross(bounds.maxY - bounds.minY, cellSize));
+  if (columns * rows > ArenaConfig::Sharding::MAX_GRID_CELLS) {
+    throw std::length_error("Сетка боев " + std::to_string(columns) + " x " + std::to_string(rows) +
+                            " больше " + std::to_string(ArenaConfig::Sharding::MAX_GRID_CELLS) + " ячеек");
+  }
+  return columns * rows;
+}
+
+int SpatialGrid::cellIndex(double x, double y) const {
+  int col = static_cast<int>((x - originX_) / cellSize_);
+  int row = static_cast<int>((y - originY_) / cellSize_);
+  col = std::clamp(col, 0, columns_ - 1);
+  row = std::clamp(row, 0, rows_ - 1);
+  return row * columns_ + col;
+}
+
+int SpatialGrid::cellOf(size_t id) const {
+  return id < cellOf_.size() ? cellOf_[id] : NOT_INDEXED;
+}
+
+bool SpatialGrid::contains(size_t id) const {
+  return id < cellOf_.size() && cellOf_[id] != NOT_INDEXED;
+}
+
+void SpatialGrid::attach(size_t id, int cell) {
+  auto& bucket = cells_[cell];
+  cellOf_[id] = cell;
+  slotOf_[id] = bucket.size();
+  bucket.push_back(id);
+}
+
+void SpatialGrid::detach(size_t id) {
+  auto& bucket = cells_[cellOf_[id]];
+  const size_t slot = slotOf_[id];
+  const size_t moved = bucket.back();
+
+  // Удаление перестановкой с последним элементом - O(1)
+  bucket[slot] = moved;
+  slotOf_[moved] = slot;
+  bucket.pop_back();
+  cellOf_[id] = NOT_INDEXED;
+}
+
+void SpatialGrid::insert(size_t id, double x, double y) {
+  if (id >= cellOf_.size()) {
+    cellOf_.resize(id + 1, NOT_INDEXED);
+    slotOf_.resize(id + 1, 0);
+  }
+  if (cellOf_[id] != NOT_INDEXED) {
+    relocate(id, x, y);
+    return;
+  }
+
+  attach(id, cellIndex(x, y));
+  ++indexed_;
+}
+
+void SpatialGrid::relocate(size_t id, double x, double y) {
+  if (!contains(id)) {
+    return;
+  }
+
+  const int cell = cellIndex(x, y);
+  if (cell == cellOf_[id]) {
+    return;
+  }
+
+  detach(id);
+  attach(id, cell);
+}
+
+void SpatialGrid::remove(size_t id) {
+  if (!contains(id)) {
+    return;
+  }
+
+  detach(id);
+  --indexed_;
+}
+
+void SpatialGrid::clear() {
+  for (auto& bucket : cells_) {
+    bucket.clear();
+  }
+  cellOf_.clear();
+  slotOf_.clear();
+  indexed_ = 0;
+}
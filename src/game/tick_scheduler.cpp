@@ -0,0 +1,142 @@
+#include "../../include/game/tick_scheduler.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+
+TickScheduler::TickScheduler(double ticksPerSecond) {
+  setTickRate(ticksPerSecond);
+}
+
+TickScheduler::PhaseId TickScheduler::addPhase(const std::string& name, std::function<void()> body,
+                                               const std::vector<PhaseId>& after) {
+  if (!body) {
+    throw std::invalid_argument("Пустая фаза тика: " + name);
+  }
+
+  size_t level = 0;
+  for (PhaseId dependency : after) {
+    if (dependency >= phases_.size()) {
+      throw std::invalid_argument("Фаза " + name + " зависит от неизвестной фазы");
+    }
+    level = std::max(level, phases_[dependency].level + 1);
+  }
+
+  const PhaseId id = phases_.size();
+  phases_.push_back(Phase{name, std::move(body), after, level, PhaseTiming{name, 0, 0, 0, 0}});
+  if (levels_.size() <= level) {
+    levels_.resize(level + 1);
+  }
+  levels_[level].push_back(id);
+  return id;
+}
+
+void TickScheduler::setWorkerPool(std::shared_ptr<WorkerPool> pool) {
+  pool_ = std::move(pool);
+}
+
+size_t TickScheduler::getMaxConcurrency() const {
+  size_t width = 1;
+  for (const auto& level : levels_) {
+    width = std::max(width, level.size());
+  }
+  return width;
+}
+
+void TickScheduler::setTickRate(double ticksPerSecond) {
+  if (ticksPerSecond < 0) {
+    throw std::invalid_argument("Темп тиков не может быть отрицательным");
+  }
+  tickRate_ = ticksPerSecond;
+  period_ = ticksPerSecond > 0
+      ? std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(1.0 / ticksPerSecond))
+      : std::chrono::steady_clock::duration::zero();
+  paced_ = false;
+}
+
+void TickScheduler::runPhase(Phase& phase) {
+  TraceRecorder* tracer = TraceRecorder::active();
+  TraceScope trace(tracer != nullptr && tracer->recording() ? tracer->intern(phase.name) : "", "phase");
+  auto start = std::chrono::steady_clock::now();
+  phase.body();
+  auto finish = std::chrono::steady_clock::now();
+
+  const double seconds = std::chrono::duration<double>(finish - start).count();
+  phase.timing.lastSeconds = seconds;
+  phase.timing.totalSeconds += seconds;
+  phase.timing.maxSeconds = std::max(phase.timing.maxSeconds, seconds);
+  ++phase.timing.runs;
+}
+
+void TickScheduler::runLevel(const std::vector<PhaseId>& level) {
+  if (level.size() == 1) {
+    runPhase(phases_[level.front()]);
+    return;
+  }
+
+  // Свой пул создается, только если общий не задан
+  if (!pool_) {
+    pool_ = std::make_shared<WorkerPool>(getMaxConcurrency());
+  }
+  pool_->parallelFor(level.size(), [&](size_t, size_t begin, size_t end) {
+    for (size_t k = begin; k < end; ++k) {
+      runPhase(phases_[level[k]]);
+    }
+  }, 1);
+}
+
+void TickScheduler::runTick() {
+  TraceRecorder::beginTick(ticks_);
+  TraceScope trace("тик", "tick");
+  auto start = std::chrono::steady_clock::now();
+  for (const auto& level : levels_) {
+    runLevel(level);
+  }
+  auto finish = std::chrono::steady_clock::now();
+
+  tickSeconds_ += std::chrono::duration<double>(finish - start).count();
+  if (tickLatency_ != nullptr) {
+    tickLatency_->record(static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(finish - start).count()));
+  }
+  ++ticks_;
+}
+
+void TickScheduler::waitForNextTick() {
+  if (period_ == std::chrono::steady_clock::duration::zero()) {
+    return;
+  }
+
+  auto now = std::chrono::steady_clock::now();
+  if (!paced_) {
+    nextTick_ = now;
+    paced_ = true;
+  }
+
+  if (now < nextTick_) {
+    std::this_thread::sleep_until(nextTick_);
+  } else if (now - nextTick_ > period_) {
+    ++overruns_;
+    nextTick_ = now;
+  }
+  nextTick_ += period_;
+}
+
+size_t TickScheduler::run(size_t ticks, const std::function<bool()>& keepRunning) {
+  size_t done = 0;
+  while (done < ticks && (!keepRunning || keepRunning())) {
+    waitForNextTick();
+    runTick();
+    ++done;
+  }
+  return done;
+}
+
+std::vector<TickScheduler::PhaseTiming> TickScheduler::getTimings() const {
+  std::vector<PhaseTiming> timings;
+  timings.reserve(phases_.size());
+  for (const auto& phase : phases_) {
+    timings.push_back(phase.timing);
+  }
+  return timings;
+}
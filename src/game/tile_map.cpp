@@ -0,0 +1,326 @@
+#include "../../include/game/tile_map.hpp"
+#include "../../include/game/random_stream.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+  // Половина окрестности 3x3, как в SpatialGrid::forEachCellBlock
+  constexpr int FORWARD[4][2] = {{1, 0}, {-1, 1}, {0, 1}, {1, 1}};
+
+  bool battleOrder(const TileMap::Battle& lhs, const TileMap::Battle& rhs) {
+    return CombatPairOrder{}(lhs.pair, rhs.pair);
+  }
+}
+
+void TileMap::configure(const SpatialGrid& grid, size_t columns, size_t rows) {
+  tiles_.clear();
+  tileOfCell_.clear();
+  columns_ = rows_ = 0;
+  stats_ = Stats{0, 0, 0, 0};
+  if (columns == 0 || rows == 0) {
+    return;
+  }
+  if (columns > static_cast<size_t>(grid.getColumns()) ||
+      rows > static_cast<size_t>(grid.getRows())) {
+    throw std::invalid_argument("Тайлов больше, чем ячеек сетки");
+  }
+
+  columns_ = columns;
+  rows_ = rows;
+  gridColumns_ = grid.getColumns();
+  const int gridRows = grid.getRows();
+  const size_t count = columns * rows;
+  tileOfCell_.assign(static_cast<size_t>(gridColumns_) * gridRows, 0);
+
+  for (size_t index = 0; index < count; ++index) {
+    auto tile = std::make_unique<Tile>();
+    const size_t tx = index % columns;
+    const size_t ty = index / columns;
+    tile->colBegin = static_cast<int>(tx * gridColumns_ / columns);
+    tile->colEnd = static_cast<int>((tx + 1) * gridColumns_ / columns);
+    tile->rowBegin = static_cast<int>(ty * gridRows / rows);
+    tile->rowEnd = static_cast<int>((ty + 1) * gridRows / rows);
+    tile->inbox.resize(count);
+    tile->borderInbox.resize(count);
+
+    for (int row = tile->rowBegin; row < tile->rowEnd; ++row) {
+      for (int col = tile->colBegin; col < tile->colEnd; ++col) {
+        tileOfCell_[row * gridColumns_ + col] = static_cast<uint32_t>(index);
+      }
+    }
+
+    // Рамка ореола: столбец слева, столбец справа и строка снизу. Левая
+    // ячейка верхней строки соседом вперед не бывает
+    const int width = tile->colEnd - tile->colBegin;
+    const int height = tile->rowEnd - tile->rowBegin;
+    tile->haloSlotOf.assign(static_cast<size_t>(width + 2) * (height + 1), -1);
+    for (int row = tile->rowBegin; row <= tile->rowEnd; ++row) {
+      for (int col = tile->colBegin - 1; col <= tile->colEnd; ++col) {
+        const bool inside = col >= tile->colBegin && col < tile->colEnd && row < tile->rowEnd;
+        const bool upperLeft = col < tile->colBegin && row == tile->rowBegin;
+        if (inside || upperLeft || col < 0 || col >= gridColumns_ || row >= gridRows) {
+          continue;
+        }
+        const size_t local = (row - tile->rowBegin) * (width + 2) + (col - tile->colBegin + 1);
+        tile->haloSlotOf[local] = static_cast<int>(tile->haloCells.size());
+        tile->haloCells.push_back(row * gridColumns_ + col);
+      }
+    }
+    tile->haloStart.assign(tile->haloCells.size() + 1, 0);
+    tiles_.push_back(std::move(tile));
+  }
+  stats_.tiles = count;
+}
+
+int TileMap::haloSlot(const Tile& tile, int col, int row) const {
+  const int width = tile.colEnd - tile.colBegin;
+  const int localCol = col - tile.colBegin + 1;
+  const int localRow = row - tile.rowBegin;
+  if (localCol < 0 || localCol >= width + 2 || localRow < 0 ||
+      localRow > tile.rowEnd - tile.rowBegin) {
+    return -1;
+  }
+  return tile.haloSlotOf[localRow * (width + 2) + localCol];
+}
+
+void TileMap::move(CreatureStore& creatures, SpatialGrid& grid, WorkerPool& pool,
+                   uint64_t seed, uint64_t tick) {
+  // Мигранты прошлого движения без доставки сначала встают в сетку
+  deliver(creatures, grid, pool);
+
+  pool.parallelFor(tiles_.size(), [&](size_t, size_t begin, size_t end) {
+    for (size_t index = begin; index < end; ++index) {
+      moveTile(index, creatures, grid, seed, tick);
+    }
+  }, 1);
+
+  stats_.migrants = 0;
+  for (const auto& tile : tiles_) {
+    stats_.migrants += tile->migrants;
+  }
+}
+
+void TileMap::moveTile(size_t index, CreatureStore& creatures, SpatialGrid& grid,
+                       uint64_t seed, uint64_t tick) {
+  Tile& tile = *tiles_[index];
+
+  // Снимок жителей: ячейки тайла меняются по ходу движения
+  tile.residents.clear();
+  for (int row = tile.rowBegin; row < tile.rowEnd; ++row) {
+    for (int col = tile.colBegin; col < tile.colEnd; ++col) {
+      const auto& cell = grid.cell(row * gridColumns_ + col);
+      tile.residents.insert(tile.residents.end(), cell.begin(), cell.end());
+    }
+  }
+
+  tile.migrants = 0;
+  for (size_t id : tile.residents) {
+    RandomStream stream(seed, tick, id, RandomPurpose::MOVEMENT);
+    MoveDirection direction = static_cast<MoveDirection>(stream.uniformInt(0, 3));
+    creatures.move(id, direction, false);
+
+    const int cell = grid.cellIndex(creatures.x(id), creatures.y(id));
+    if (cell == grid.cellOf(id)) continue;
+
+    const uint32_t target = tileOfCell_[cell];
+    if (target == index) {
+      grid.relocate(id, creatures.x(id), creatures.y(id));
+    } else {
+      grid.remove(id);
+      tiles_[target]->inbox[index].push_back(id);
+      ++tile.migrants;
+    }
+  }
+}
+
+void TileMap::deliver(const CreatureStore& creatures, SpatialGrid& grid, WorkerPool& pool) {
+  pool.parallelFor(tiles_.size(), [&](size_t, size_t begin, size_t end) {
+    for (size_t index = begin; index < end; ++index) {
+      deliverTile(*tiles_[index], creatures, grid);
+    }
+  }, 1);
+}
+
+void TileMap::deliverTile(Tile& tile, const CreatureStore& creatures, SpatialGrid& grid) {
+  // Отправители по порядку номеров; погибшие в пути в сетку не встают
+  for (auto& mailbox : tile.inbox) {
+    for (size_t id : mailbox) {
+      if (creatures.isAlive(id)) {
+        grid.insert(id, creatures.x(id), creatures.y(id));
+      }
+    }
+    mailbox.clear();
+  }
+}
+
+size_t TileMap::detect(const CreatureStore& creatures, const SpatialGrid& grid, WorkerPool& pool) {
+  // Ореолы копируются до поиска: во время поиска тайлы читают только себя
+  pool.parallelFor(tiles_.size(), [&](size_t, size_t begin, size_t end) {
+    for (size_t index = begin; index < end; ++index) {
+      exchangeHalo(*tiles_[index], creatures, grid);
+    }
+  }, 1);
+  pool.parallelFor(tiles_.size(), [&](size_t, size_t begin, size_t end) {
+    for (size_t index = begin; index < end; ++index) {
+      detectTile(*tiles_[index], creatures, grid);
+    }
+  }, 1);
+
+  size_t pairTests = 0;
+  stats_.haloCreatures = 0;
+  for (const auto& tile : tiles_) {
+    pairTests += tile->pairTests;
+    stats_.haloCreatures += tile->haloIds.size();
+  }
+  return pairTests;
+}
+
+void TileMap::exchangeHalo(Tile& tile, const CreatureStore& creatures, const SpatialGrid& grid) {
+  tile.halo.clear();
+  tile.haloIds.clear();
+  for (size_t slot = 0; slot < tile.haloCells.size(); ++slot) {
+    tile.haloStart[slot] = tile.haloIds.size();
+    for (size_t id : grid.cell(tile.haloCells[slot])) {
+      tile.halo.append(creatures, id);
+      tile.haloIds.push_back(id);
+    }
+  }
+  tile.haloStart[tile.haloCells.size()] = tile.haloIds.size();
+}
+
+void TileMap::detectTile(Tile& tile, const CreatureStore& creatures, const SpatialGrid& grid) {
+  const int gridRows = grid.getRows();
+  tile.pairs.clear();
+  tile.crossPairs.clear();
+  tile.pairTests = 0;
+
+  for (int row = tile.rowBegin; row < tile.rowEnd; ++row) {
+    for (int col = tile.colBegin; col < tile.colEnd; ++col) {
+      const auto& cell = grid.cell(row * gridColumns_ + col);
+      if (cell.empty()) continue;
+
+      // Блок как в SpatialGrid::forEachCellBlock, чужие ячейки - из ореола
+      tile.block.assign(cell.begin(), cell.end());
+      tile.remote.assign(cell.size(), 0);
+      tile.packed.pack(creatures, cell);
+      for (const auto& offset : FORWARD) {
+        const int nCol = col + offset[0];
+        const int nRow = row + offset[1];
+        if (nCol < 0 || nCol >= gridColumns_ || nRow >= gridRows) continue;
+
+        const int slot = haloSlot(tile, nCol, nRow);
+        if (slot < 0) {
+          for (size_t id : grid.cell(nRow * gridColumns_ + nCol)) {
+            tile.block.push_back(id);
+            tile.remote.push_back(0);
+            tile.packed.append(creatures, id);
+          }
+        } else {
+          const size_t begin = tile.haloStart[slot];
+          const size_t end = tile.haloStart[slot + 1];
+          tile.block.insert(tile.block.end(), tile.haloIds.begin() + begin,
+                            tile.haloIds.begin() + end);
+          tile.remote.insert(tile.remote.end(), end - begin, 1);
+          tile.packed.append(tile.halo, begin, end);
+        }
+      }
+
+      tile.pairTests += RangeKernel::forEachBlockHit(tile.packed, tile.block, cell.size(), tile.hits,
+          [&](size_t attacker, size_t defender, size_t k) {
+            (tile.remote[k] ? tile.crossPairs : tile.pairs).emplace_back(attacker, defender);
+          });
+    }
+  }
+}
+
+size_t TileMap::resolve(CreatureStore& creatures, const SpatialGrid& grid, WorkerPool& pool,
+                        const CombatMediator& mediator, std::vector<Battle>& battles) {
+  components_.reset(creatures.size());
+
+  // Участники пограничных пар помечаются; чужие - через почту владельца
+  pool.parallelFor(tiles_.size(), [&](size_t, size_t begin, size_t end) {
+    for (size_t index = begin; index < end; ++index) {
+      markBorder(index, grid);
+    }
+  }, 1);
+  pool.parallelFor(tiles_.size(), [&](size_t, size_t begin, size_t end) {
+    for (size_t index = begin; index < end; ++index) {
+      resolveTile(*tiles_[index], creatures, mediator);
+    }
+  }, 1);
+
+  // Отложенные бои - в одном потоке в порядке пар
+  std::vector<const std::vector<CombatPair>*> deferredLists;
+  std::vector<const std::vector<Battle>*> battleLists;
+  for (const auto& tile : tiles_) {
+    deferredLists.push_back(&tile->deferred);
+    battleLists.push_back(&tile->battles);
+  }
+  mergeSorted(deferredLists, deferred_, CombatPairOrder{});
+
+  deferredBattles_.clear();
+  for (const auto& combat : deferred_) {
+    if (!creatures.isAlive(combat.first) || !creatures.isAlive(combat.second)) continue;
+
+    const BattleOutcome outcome = mediator.decide(NPC(creatures, combat.first),
+                                                  NPC(creatures, combat.second));
+    if (outcome == NO_CONTEST) continue;
+    creatures.setAlive(outcome == ATTACKER_VICTORY ? combat.second : combat.first, false);
+    deferredBattles_.push_back(Battle{combat, outcome});
+  }
+  battleLists.push_back(&deferredBattles_);
+  mergeSorted(battleLists, battles, battleOrder);
+
+  stats_.deferredCombats = deferred_.size();
+  return deferred_.size();
+}
+
+void TileMap::markBorder(size_t index, const SpatialGrid& grid) {
+  for (const auto& combat : tiles_[index]->crossPairs) {
+    for (size_t id : {combat.first, combat.second}) {
+      const int cell = grid.cellOf(id);
+      if (cell < 0) continue;
+
+      const uint32_t owner = tileOfCell_[cell];
+      if (owner == index) {
+        components_.markBorder(id);
+      } else {
+        tiles_[owner]->borderInbox[index].push_back(id);
+      }
+    }
+  }
+}
+
+void TileMap::resolveTile(Tile& tile, CreatureStore& creatures, const CombatMediator& mediator) {
+  for (auto& mailbox : tile.borderInbox) {
+    for (size_t id : mailbox) {
+      components_.markBorder(id);
+    }
+    mailbox.clear();
+  }
+  components_.build(tile.pairs);
+
+  std::sort(tile.pairs.begin(), tile.pairs.end(), CombatPairOrder{});
+  std::sort(tile.crossPairs.begin(), tile.crossPairs.end(), CombatPairOrder{});
+  tile.deferred.clear();
+  tile.battles.clear();
+  for (const auto& combat : tile.pairs) {
+    if (components_.deferred(combat)) {
+      tile.deferred.push_back(combat);
+      continue;
+    }
+    if (!creatures.isAlive(combat.first) || !creatures.isAlive(combat.second)) continue;
+
+    const BattleOutcome outcome = mediator.decide(NPC(creatures, combat.first),
+                                                  NPC(creatures, combat.second));
+    if (outcome == NO_CONTEST) continue;
+    creatures.setAlive(outcome == ATTACKER_VICTORY ? combat.second : combat.first, false);
+    tile.battles.push_back(Battle{combat, outcome});
+  }
+  
+  // Отложенные тайла тоже упорядочены: свои и пограничные сливаются
+  const size_t local = tile.deferred.size();
+  tile.deferred.insert(tile.deferred.end(), tile.crossPairs.begin(), tile.crossPairs.end());
+  std::inplace_merge(tile.deferred.begin(), tile.deferred.begin() + local, tile.deferred.end(),
+                     CombatPairOrder{});
+}
@@ -0,0 +1,189 @@
+#include "../../include/game/trace.hpp"
+#include <fstream>
+#include <iomanip>
+#include <stdexcept>
+
+std::atomic<TraceRecorder*> TraceRecorder::active_{nullptr};
+std::atomic<uint64_t> TraceRecorder::generations_{0};
+
+namespace {
+  // Буфер потока привязан к поколению регистратора: новый регистратор
+  // по тому же адресу не получит чужой буфер
+  struct ThreadSlot {
+    uint64_t generation = 0;
+    void* buffer = nullptr;
+    std::string name;
+  };
+  thread_local ThreadSlot traceSlot;
+
+  void writeEscaped(std::ostream& out, const char* text) {
+    out << '"';
+    for (const char* c = text; *c != '\0'; ++c) {
+      switch (*c) {
+        case '"': out << "\\\""; break;
+        case '\\': out << "\\\\"; break;
+        case '\n': out << "\\n"; break;
+        default:
+          if (static_cast<unsigned char>(*c) < 0x20) {
+            out << ' ';
+          } else {
+            out << *c;
+          }
+      }
+    }
+    out << '"';
+  }
+
+  // Trace Event считает время в микросекундах
+  double micros(uint64_t nanos) {
+    return static_cast<double>(nanos) / 1000.0;
+  }
+}
+
+TraceRecorder::TraceRecorder(const std::string& fileName, uint64_t firstTick, uint64_t lastTick,
+                             size_t eventsPerThread)
+    : fileName_(fileName),
+      firstTick_(firstTick),
+      lastTick_(lastTick),
+      capacity_(eventsPerThread),
+      generation_(generations_.fetch_add(1) + 1),
+      origin_(std::chrono::steady_clock::now()),
+      recording_(firstTick == 0) {
+  if (firstTick_ > lastTick_) {
+    throw std::invalid_argument("Окно трассы пусто");
+  }
+  if (capacity_ == 0) {
+    throw std::invalid_argument("Буфер трассы должен вмещать хотя бы одно событие");
+  }
+  // Файл проверяем сразу, а не в конце прогона
+  std::ofstream probe(fileName_, std::ios::trunc);
+  if (!probe.is_open()) {
+    throw std::runtime_error("Не удалось открыть файл трассы '" + fileName_ + "'");
+  }
+
+  TraceRecorder* expected = nullptr;
+  if (!active_.compare_exchange_strong(expected, this)) {
+    throw std::logic_error("Трасса уже записывается");
+  }
+}
+
+TraceRecorder::~TraceRecorder() {
+  try {
+    finish();
+  } catch (const std::exception&) {
+    // Деструктор не бросает; ошибку записи увидит явный finish()
+  }
+}
+
+void TraceRecorder::beginTick(uint64_t tick) {
+  TraceRecorder* recorder = active();
+  if (recorder == nullptr) return;
+
+  recorder->tick_.store(tick, std::memory_order_relaxed);
+  recorder->recording_.store(tick >= recorder->firstTick_ && tick <= recorder->lastTick_,
+                             std::memory_order_relaxed);
+}
+
+void TraceRecorder::setThreadName(const std::string& name) {
+  traceSlot.name = name;
+}
+
+TraceRecorder::ThreadBuffer& TraceRecorder::threadBuffer() {
+  if (traceSlot.generation == generation_) {
+    return *static_cast<ThreadBuffer*>(traceSlot.buffer);
+  }
+
+  std::lock_guard lock(buffersMutex_);
+  ThreadBuffer& buffer = buffers_.emplace_back();
+  buffer.events = std::make_unique<Event[]>(capacity_);
+  buffer.threadId = buffers_.size();
+  buffer.threadName = traceSlot.name.empty()
+      ? "поток " + std::to_string(buffer.threadId) : traceSlot.name;
+
+  traceSlot.generation = generation_;
+  traceSlot.buffer = &buffer;
+  return buffer;
+}
+
+void TraceRecorder::record(const char* name, const char* category, uint64_t start, uint64_t finish) {
+  ThreadBuffer& buffer = threadBuffer();
+  const size_t size = buffer.size.load(std::memory_order_relaxed);
+  if (size == capacity_) {
+    buffer.dropped.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  buffer.events[size] = Event{name, category, start, finish - start,
+                              tick_.load(std::memory_order_relaxed)};
+  // Писатель файла читает только опубликованные события
+  buffer.size.store(size + 1, std::memory_order_release);
+}
+
+const char* TraceRecorder::intern(const std::string& name) {
+  std::lock_guard lock(buffersMutex_);
+  return names_.insert(name).first->c_str();
+}
+
+void TraceRecorder::finish() {
+  std::lock_guard lock(buffersMutex_);
+  if (finished_) return;
+  finished_ = true;
+  recording_.store(false, std::memory_order_relaxed);
+  TraceRecorder* expected = this;
+  active_.compare_exchange_strong(expected, nullptr);
+
+  std::ofstream out(fileName_, std::ios::trunc);
+  if (!out.is_open()) {
+    throw std::runtime_error("Не удалось открыть файл трассы '" + fileName_ + "'");
+  }
+  out << std::fixed << std::setprecision(3);
+  out << "{\"displayTimeUnit\": \"ms\",\n\"traceEvents\": [\n";
+
+  const char* separator = "";
+  for (const auto& buffer : buffers_) {
+    out << separator << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": "
+        << buffer.threadId << ", \"args\": {\"name\": ";
+    writeEscaped(out, buffer.threadName.c_str());
+    out << "}}";
+    separator = ",\n";
+
+    const size_t size = buffer.size.load(std::memory_order_acquire);
+    for (size_t k = 0; k < size; ++k) {
+      const Event& event = buffer.events[k];
+      out << separator << "{\"name\": ";
+      writeEscaped(out, event.name);
+      out << ", \"cat\": ";
+      writeEscaped(out, event.category);
+      out << ", \"ph\": \"X\", \"pid\": 1, \"tid\": " << buffer.threadId
+          << ", \"ts\": " << micros(event.start) << ", \"dur\": " << micros(event.duration)
+          << ", \"args\": {\"tick\": " << event.tick << "}}";
+    }
+  }
+
+  out << "\n],\n\"otherData\": {\"first_tick\": " << firstTick_ << ", \"last_tick\": " << lastTick_
+      << ", \"dropped_events\": " << getDroppedEventsLocked() << "}}\n";
+  if (!out) {
+    throw std::runtime_error("Не удалось записать трассу в '" + fileName_ + "'");
+  }
+}
+
+size_t TraceRecorder::getEventCount() const {
+  std::lock_guard lock(buffersMutex_);
+  size_t total = 0;
+  for (const auto& buffer : buffers_) {
+    total += buffer.size.load(std::memory_order_acquire);
+  }
+  return total;
+}
+
+size_t TraceRecorder::getDroppedEvents() const {
+  std::lock_guard lock(buffersMutex_);
+  return getDroppedEventsLocked();
+}
+
+size_t TraceRecorder::getDroppedEventsLocked() const {
+  size_t total = 0;
+  for (const auto& buffer : buffers_) {
+    total += buffer.dropped.load(std::memory_order_relaxed);
+  }
+  return total;
+}
@@ -0,0 +1,521 @@
+#include "../../include/game/trajectory.hpp"
+#include "../../include/game/snapshot.hpp"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+  uint64_t zigzag(int64_t value) {
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+  }
+
+  int64_t unzigzag(uint64_t value) {
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+  }
+
+  void putVarint(std::string& out, uint64_t value) {
+    while (value >= 0x80) {
+      out.push_back(static_cast<char>((value & 0x7F) | 0x80));
+      value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+  }
+
+  // Округление до ближайшего без вызова llround (горячий цикл capture)
+  int64_t quantize(double value) {
+    return value >= 0 ? static_cast<int64_t>(value + 0.5) : -static_cast<int64_t>(0.5 - value);
+  }
+
+  void putSigned(std::string& out, int64_t value) {
+    putVarint(out, zigzag(value));
+  }
+
+  // Флаги жизни [begin, end) по биту на существо
+  void putBits(std::string& out, const std::vector<uint8_t>& alive, size_t begin, size_t end) {
+    for (size_t base = begin; base < end; base += 8) {
+      uint8_t byte = 0;
+      for (size_t bit = 0; bit < 8 && base + bit < end; ++bit) {
+        byte |= static_cast<uint8_t>((alive[base + bit] != 0) << bit);
+      }
+      out.push_back(static_cast<char>(byte));
+    }
+  }
+
+  // Чтение куска с проверкой границ
+  class ChunkCursor {
+    private:
+      const unsigned char* data_;
+      const unsigned char* end_;
+
+      [[noreturn]] static void corrupted() {
+        throw std::runtime_error("Кусок траекторий поврежден");
+      }
+
+    public:
+      ChunkCursor(const char* data, size_t size)
+          : data_(reinterpret_cast<const unsigned char*>(data)), end_(data_ + size) {}
+
+      bool atEnd() const { return data_ == end_; }
+
+      uint64_t varint() {
+        uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+          if (data_ == end_) corrupted();
+          const unsigned char byte = *data_++;
+          value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+          if ((byte & 0x80) == 0) return value;
+        }
+        corrupted();
+      }
+
+      int64_t signedVarint() { return unzigzag(varint()); }
+
+      void bits(std::vector<uint8_t>& alive, size_t begin, size_t end) {
+        for (size_t base = begin; base < end; base += 8) {
+          if (data_ == end_) corrupted();
+          const unsigned char byte = *data_++;
+          for (size_t bit = 0; bit < 8 && base + bit < end; ++bit) {
+            alive[base + bit] = (byte >> bit) & 1;
+          }
+        }
+      }
+  };
+}
+
+Trajectory::Writer::Writer(const std::string& fileName, const WorldBounds& world, uint64_t seed,
+                           const WriterOptions& options)
+    : options_(options) {
+  if (!(options_.quantum > 0) || options_.ticksPerChunk == 0 || options_.bufferedTicks == 0) {
+    throw std::invalid_argument("Параметры записи траекторий должны быть положительными");
+  }
+
+  out_.open(fileName, std::ios::binary | std::ios::trunc);
+  if (!out_.is_open()) {
+    throw std::invalid_argument("Не удалось открыть файл траекторий для записи");
+  }
+
+  std::memset(&header_, 0, sizeof(header_));
+  std::memcpy(header_.magic, MAGIC, sizeof(MAGIC));
+  header_.version = VERSION;
+  header_.headerSize = sizeof(Header);
+  header_.originX = world.minX;
+  header_.originY = world.minY;
+  header_.quantum = options_.quantum;
+  header_.seed = seed;
+  header_.ticksPerChunk = options_.ticksPerChunk;
+  out_.write(reinterpret_cast<const char*>(&header_), sizeof(header_));
+  if (!out_) {
+    throw std::runtime_error("Ошибка записи траекторий: " + fileName);
+  }
+  stats_.bytes = sizeof(header_);
+
+  frames_.resize(options_.bufferedTicks);
+  for (size_t slot = 0; slot < frames_.size(); ++slot) {
+    free_.push_back(slot);
+  }
+  writer_ = std::thread(&Writer::writerLoop, this);
+}
+
+Trajectory::Writer::~Writer() {
+  try {
+    close();
+  } catch (const std::exception&) {
+    // Деструктор не бросает; ошибку увидит явный close()
+  }
+}
+
+void Trajectory::Writer::capture(const CreatureStore& creatures, uint64_t tick) {
+  size_t slot;
+  {
+    std::unique_lock lock(queueMutex_);
+    if (closing_) {
+      throw std::logic_error("Запись траекторий уже закрыта");
+    }
+    if (captured_ && tick <= lastTick_) {
+      throw std::invalid_argument("Тики траекторий должны возрастать");
+    }
+    if (free_.empty()) {
+      ++stalls_;
+      queueChanged_.wait(lock, [this]() { return !free_.empty(); });
+    }
+    if (failure_) {
+      std::rethrow_exception(failure_);
+    }
+    slot = free_.back();
+    free_.pop_back();
+    captured_ = true;
+    lastTick_ = tick;
+  }
+
+  // Только квантование: остальное - в потоке писателя
+  Frame& frame = frames_[slot];
+  const size_t count = creatures.size();
+  const double* xs = creatures.xData();
+  const double* ys = creatures.yData();
+  const double scale = 1.0 / header_.quantum;
+  frame.tick = tick;
+  frame.x.resize(count);
+  frame.y.resize(count);
+  for (size_t i = 0; i < count; ++i) {
+    frame.x[i] = quantize((xs[i] - header_.originX) * scale);
+    frame.y[i] = quantize((ys[i] - header_.originY) * scale);
+  }
+  frame.alive.assign(creatures.aliveData(), creatures.aliveData() + count);
+
+  {
+    std::lock_guard lock(queueMutex_);
+    ready_.push_back(slot);
+  }
+  queueChanged_.notify_all();
+}
+
+void Trajectory::Writer::writerLoop() {
+  while (true) {
+    size_t slot;
+    {
+      std::unique_lock lock(queueMutex_);
+      queueChanged_.wait(lock, [this]() { return !ready_.empty() || closing_; });
+      if (ready_.empty()) break;
+      slot = ready_.front();
+      ready_.pop_front();
+    }
+
+    try {
+      encode(frames_[slot]);
+      // Буфер предыдущего тика уходит в свободные
+      std::swap(previous_, frames_[slot]);
+      hasPrevious_ = true;
+    } catch (...) {
+      std::lock_guard lock(queueMutex_);
+      if (!failure_) failure_ = std::current_exception();
+    }
+
+    {
+      std::lock_guard lock(queueMutex_);
+      free_.push_back(slot);
+    }
+    queueChanged_.notify_all();
+  }
+
+  try {
+    flushChunk();
+  } catch (...) {
+    std::lock_guard lock(queueMutex_);
+    if (!failure_) failure_ = std::current_exception();
+  }
+}
+
+bool Trajectory::Writer::needsKeyframe(const Frame& frame) const {
+  if (chunkHeader_.tickCount == 0) return true;
+  if (frame.size() < previous_.size()) return true;
+
+  for (size_t i = 0; i < previous_.size(); ++i) {
+    if (!previous_.alive[i] && !frame.alive[i] &&
+        (frame.x[i] != previous_.x[i] || frame.y[i] != previous_.y[i])) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void Trajectory::Writer::encode(const Frame& frame) {
+  if (chunkHeader_.tickCount == options_.ticksPerChunk) {
+    flushChunk();
+  }
+  const bool keyframe = !hasPrevious_ || needsKeyframe(frame);
+  if (keyframe && chunkHeader_.tickCount > 0) {
+    flushChunk();
+  }
+
+  const size_t count = frame.size();
+  if (chunkHeader_.tickCount == 0) {
+    chunkHeader_.firstTick = frame.tick;
+    putVarint(chunk_, 0);
+  } else {
+    putVarint(chunk_, frame.tick - chunkHeader_.lastTick);
+  }
+  putVarint(chunk_, count);
+
+  // Опорный тик: все существа новые
+  const size_t known = keyframe ? 0 : previous_.size();
+  if (known > 0) {
+    // Смены флага идут первыми: по ним читатель узнает, у кого есть разности
+    size_t flips = 0;
+    for (size_t i = 0; i < known; ++i) {
+      flips += previous_.alive[i] != frame.alive[i];
+    }
+    putVarint(chunk_, flips);
+    size_t next = 0;
+    for (size_t i = 0; i < known; ++i) {
+      if (previous_.alive[i] != frame.alive[i]) {
+        putVarint(chunk_, i - next);
+        next = i + 1;
+      }
+    }
+
+    // Разности по существам, живым до или после тика
+    for (size_t i = 0; i < known; ++i) {
+      if (previous_.alive[i] || frame.alive[i]) putSigned(chunk_, frame.x[i] - previous_.x[i]);
+    }
+    for (size_t i = 0; i < known; ++i) {
+      if (previous_.alive[i] || frame.alive[i]) putSigned(chunk_, frame.y[i] - previous_.y[i]);
+    }
+  }
+
+  for (size_t i = known; i < count; ++i) putSigned(chunk_, frame.x[i]);
+  for (size_t i = known; i < count; ++i) putSigned(chunk_, frame.y[i]);
+  putBits(chunk_, frame.alive, known, count);
+
+  chunkHeader_.lastTick = frame.tick;
+  ++chunkHeader_.tickCount;
+  ++stats_.ticks;
+  stats_.rawBytes += count * (2 * sizeof(double) + 1);
+}
+
+void Trajectory::Writer::flushChunk() {
+  if (chunkHeader_.tickCount == 0) return;
+
+  chunkHeader_.payloadSize = chunk_.size();
+  chunkHeader_.checksum = Snapshot::checksum(chunk_.data(), chunk_.size());
+  index_.push_back(IndexEntry{chunkHeader_.firstTick, chunkHeader_.lastTick, stats_.bytes});
+
+  out_.write(reinterpret_cast<const char*>(&chunkHeader_), sizeof(chunkHeader_));
+  out_.write(chunk_.data(), static_cast<std::streamsize>(chunk_.size()));
+  if (!out_) {
+    throw std::runtime_error("Ошибка записи куска траекторий");
+  }
+  stats_.bytes += sizeof(chunkHeader_) + chunk_.size();
+  ++stats_.chunks;
+
+  chunk_.clear();
+  chunkHeader_ = ChunkHeader{};
+}
+
+void Trajectory::Writer::close() {
+  if (closed_) return;
+  {
+    std::lock_guard lock(queueMutex_);
+    closing_ = true;
+  }
+  queueChanged_.notify_all();
+  if (writer_.joinable()) {
+    writer_.join();
+  }
+  closed_ = true;
+  if (failure_) {
+    std::rethrow_exception(failure_);
+  }
+
+  Footer footer;
+  std::memset(&footer, 0, sizeof(footer));
+  footer.indexOffset = stats_.bytes;
+  footer.chunkCount = index_.size();
+  std::memcpy(footer.magic, FOOTER_MAGIC, sizeof(FOOTER_MAGIC));
+
+  out_.write(reinterpret_cast<const char*>(index_.data()),
+             static_cast<std::streamsize>(index_.size() * sizeof(IndexEntry)));
+  out_.write(reinterpret_cast<const char*>(&footer), sizeof(footer));
+  out_.close();
+  if (!out_) {
+    throw std::runtime_error("Ошибка записи индекса траекторий");
+  }
+  stats_.bytes += index_.size() * sizeof(IndexEntry) + sizeof(footer);
+}
+
+Trajectory::Writer::Stats Trajectory::Writer::getStats() const {
+  Stats stats = stats_;
+  stats.stalls = stalls_;
+  return stats;
+}
+
+Trajectory::Reader::Reader(const std::string& fileName) {
+  int fd = ::open(fileName.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw std::invalid_argument("Не удалось открыть файл траекторий для чтения");
+  }
+
+  struct stat info;
+  if (::fstat(fd, &info) != 0 ||
+      static_cast<size_t>(info.st_size) < sizeof(Header) + sizeof(Footer)) {
+    ::close(fd);
+    throw std::runtime_error("Файл траекторий поврежден: " + fileName);
+  }
+
+  size_ = static_cast<size_t>(info.st_size);
+  mapping_ = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (mapping_ == MAP_FAILED) {
+    mapping_ = nullptr;
+    throw std::runtime_error("Не удалось отобразить траектории в память: " + fileName);
+  }
+
+  const auto* base = static_cast<const char*>(mapping_);
+  header_ = reinterpret_cast<const Header*>(base);
+  try {
+    validate(fileName);
+  } catch (...) {
+    ::munmap(mapping_, size_);
+    throw;
+  }
+
+  const auto* footer = reinterpret_cast<const Footer*>(base + size_ - sizeof(Footer));
+  index_ = reinterpret_cast<const IndexEntry*>(base + footer->indexOffset);
+  chunkCount_ = footer->chunkCount;
+}
+
+void Trajectory::Reader::validate(const std::string& fileName) const {
+  const Header& header = *header_;
+  if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0) {
+    throw std::runtime_error("Файл не является записью траекторий: " + fileName);
+  }
+  if (header.version != VERSION || header.headerSize != sizeof(Header)) {
+    throw std::runtime_error("Неподдерживаемая версия траекторий: " + fileName);
+  }
+
+  // Без конца файла запись не закрыта (процесс прервали)
+  const auto* base = static_cast<const char*>(mapping_);
+  const auto* footer = reinterpret_cast<const Footer*>(base + size_ - sizeof(Footer));
+  if (std::memcmp(footer->magic, FOOTER_MAGIC, sizeof(FOOTER_MAGIC)) != 0) {
+    throw std::runtime_error("Запись траекторий не закрыта: " + fileName);
+  }
+  if (footer->indexOffset < sizeof(Header) ||
+      footer->chunkCount > size_ / sizeof(IndexEntry) ||
+      footer->indexOffset + footer->chunkCount * sizeof(IndexEntry) + sizeof(Footer) != size_) {
+    throw std::runtime_error("Файл траекторий поврежден: " + fileName);
+  }
+
+  const auto* index = reinterpret_cast<const IndexEntry*>(base + footer->indexOffset);
+  for (uint64_t k = 0; k < footer->chunkCount; ++k) {
+    if (index[k].offset + sizeof(ChunkHeader) > footer->indexOffset ||
+        (k > 0 && index[k].firstTick <= index[k - 1].lastTick)) {
+      throw std::runtime_error("Файл траекторий поврежден: " + fileName);
+    }
+    const auto* chunk = reinterpret_cast<const ChunkHeader*>(base + index[k].offset);
+    if (index[k].offset + sizeof(ChunkHeader) + chunk->payloadSize > footer->indexOffset) {
+      throw std::runtime_error("Файл траекторий поврежден: " + fileName);
+    }
+  }
+}
+
+Trajectory::Reader::~Reader() {
+  if (mapping_ != nullptr) {
+    ::munmap(mapping_, size_);
+  }
+}
+
+uint64_t Trajectory::Reader::firstTick() const {
+  if (empty()) {
+    throw std::out_of_range("Запись траекторий пуста");
+  }
+  return index_[0].firstTick;
+}
+
+uint64_t Trajectory::Reader::lastTick() const {
+  if (empty()) {
+    throw std::out_of_range("Запись траекторий пуста");
+  }
+  return index_[chunkCount_ - 1].lastTick;
+}
+
+void Trajectory::Reader::decodeChunk(size_t chunk,
+                                     const std::function<bool(const Frame&)>& visit) const {
+  const auto* base = static_cast<const char*>(mapping_);
+  const auto* header = reinterpret_cast<const ChunkHeader*>(base + index_[chunk].offset);
+  const char* payload = reinterpret_cast<const char*>(header + 1);
+  if (Snapshot::checksum(payload, header->payloadSize) != header->checksum) {
+    throw std::runtime_error("Контрольная сумма куска траекторий не совпадает");
+  }
+
+  ChunkCursor cursor(payload, header->payloadSize);
+  Frame frame;
+  frame.tick = header->firstTick;
+  std::vector<uint8_t> before;
+
+  for (uint32_t k = 0; k < header->tickCount; ++k) {
+    frame.tick += cursor.varint();
+    const uint64_t count = cursor.varint();
+    const size_t known = k == 0 ? 0 : frame.size();
+    // Новое существо занимает в столбцах не меньше двух байт
+    if (count < known || (count - known) / 2 > header->payloadSize) {
+      throw std::runtime_error("Кусок траекторий поврежден");
+    }
+
+    if (known > 0) {
+      // Флаги до тика нужны, чтобы найти существ со строками разностей
+      before.assign(frame.alive.begin(), frame.alive.end());
+      const uint64_t flips = cursor.varint();
+      size_t next = 0;
+      for (uint64_t f = 0; f < flips; ++f) {
+        const uint64_t gap = cursor.varint();
+        if (gap >= known - next) {
+          throw std::runtime_error("Кусок траекторий поврежден");
+        }
+        next += gap;
+        frame.alive[next] = !frame.alive[next];
+        ++next;
+      }
+
+      for (size_t i = 0; i < known; ++i) {
+        if (before[i] || frame.alive[i]) frame.x[i] += cursor.signedVarint();
+      }
+      for (size_t i = 0; i < known; ++i) {
+        if (before[i] || frame.alive[i]) frame.y[i] += cursor.signedVarint();
+      }
+    }
+
+    frame.x.resize(count);
+    frame.y.resize(count);
+    frame.alive.resize(count);
+    for (size_t i = known; i < count; ++i) frame.x[i] = cursor.signedVarint();
+    for (size_t i = known; i < count; ++i) frame.y[i] = cursor.signedVarint();
+    cursor.bits(frame.alive, known, count);
+
+    if (!visit(frame)) return;
+  }
+  if (!cursor.atEnd()) {
+    throw std::runtime_error("Кусок траекторий поврежден");
+  }
+}
+
+Trajectory::Frame Trajectory::Reader::frame(uint64_t tick) const {
+  // Кусок с последним firstTick не больше tick
+  const IndexEntry* end = index_ + chunkCount_;
+  const IndexEntry* entry = std::upper_bound(index_, end, tick,
+      [](uint64_t value, const IndexEntry& chunk) { return value < chunk.firstTick; });
+  if (entry == index_ || tick > (entry - 1)->lastTick) {
+    throw std::out_of_range("Тика " + std::to_string(tick) + " нет в записи траекторий");
+  }
+
+  Frame found;
+  bool present = false;
+  decodeChunk(static_cast<size_t>(entry - 1 - index_), [&](const Frame& frame) {
+    if (frame.tick < tick) return true;
+    if (frame.tick == tick) {
+      found = frame;
+      present = true;
+    }
+    return false;
+  });
+  if (!present) {
+    throw std::out_of_range("Тика " + std::to_string(tick) + " нет в записи траекторий");
+  }
+  return found;
+}
+
+void Trajectory::Reader::scan(uint64_t first, uint64_t last,
+                              const std::function<void(const Frame&)>& visit) const {
+  for (size_t chunk = 0; chunk < chunkCount_; ++chunk) {
+    if (index_[chunk].lastTick < first) continue;
+    if (index_[chunk].firstTick > last) return;
+
+    decodeChunk(chunk, [&](const Frame& frame) {
+      if (frame.tick > last) return false;
+      if (frame.tick >= first) visit(frame);
+      return true;
+    });
+  }
+}
@@ -0,0 +1,168 @@
+#include "../../include/game/worker_pool.hpp"
+#include "../../include/game/trace.hpp"
+#include <algorithm>
+
+namespace {
+  // Поток пула знает свой пул и номер, чтобы вложенный parallelFor
+  // клал задачи в собственную деку
+  thread_local const WorkerPool* localPool = nullptr;
+  thread_local size_t localSlot = 0;
+}
+
+WorkerPool::WorkerPool(size_t workers) {
+  const size_t total = workers > 0 ? workers : hardwareWorkers();
+  slots_.reserve(total);
+  for (size_t i = 0; i < total; ++i) {
+    slots_.push_back(std::make_unique<Slot>());
+  }
+
+  threads_.reserve(total - 1);
+  for (size_t i = 1; i < total; ++i) {
+    threads_.emplace_back(&WorkerPool::workerLoop, this, i);
+  }
+}
+
+WorkerPool::~WorkerPool() {
+  {
+    std::lock_guard lock(wakeMutex_);
+    stopping_ = true;
+  }
+  wakeUp_.notify_all();
+
+  for (auto& thread : threads_) {
+    if (thread.joinable()) thread.join();
+  }
+}
+
+size_t WorkerPool::hardwareWorkers() {
+  return std::max<size_t>(std::thread::hardware_concurrency(), 1);
+}
+
+size_t WorkerPool::currentSlot() const {
+  return localPool == this ? localSlot : 0;
+}
+
+void WorkerPool::pushTask(size_t slot, const Task& task) {
+  // Счетчик растет раньше деки, чтобы не уйти в минус при краже
+  queuedTasks_.fetch_add(1, std::memory_order_release);
+  {
+    std::lock_guard lock(slots_[slot]->mutex);
+    slots_[slot]->tasks.push_back(task);
+  }
+
+  // Пустой захват: спящий работник либо уже проверил счетчик, либо
+  // еще не начал ждать и увидит новую задачу
+  { std::lock_guard lock(wakeMutex_); }
+  wakeUp_.notify_one();
+}
+
+bool WorkerPool::popOwn(size_t slot, RangeJob* job, Task& task) {
+  std::lock_guard lock(slots_[slot]->mutex);
+  auto& tasks = slots_[slot]->tasks;
+  if (tasks.empty() || (job != nullptr && tasks.back().job != job)) {
+    return false;
+  }
+  task = tasks.back();
+  tasks.pop_back();
+  queuedTasks_.fetch_sub(1, std::memory_order_relaxed);
+  return true;
+}
+
+bool WorkerPool::steal(size_t thief, RangeJob* job, Task& task) {
+  const size_t count = slots_.size();
+  for (size_t offset = 1; offset <= count; ++offset) {
+    const size_t victim = (thief + offset) % count;
+    std::lock_guard lock(slots_[victim]->mutex);
+    auto& tasks = slots_[victim]->tasks;
+
+    // Ожидающий владелец берет только куски своей работы
+    auto found = tasks.begin();
+    if (job != nullptr) {
+      found = std::find_if(tasks.begin(), tasks.end(),
+                           [job](const Task& candidate) { return candidate.job == job; });
+    }
+    if (found == tasks.end()) {
+      continue;
+    }
+
+    task = *found;
+    tasks.erase(found);
+    queuedTasks_.fetch_sub(1, std::memory_order_relaxed);
+    if (victim != thief) {
+      steals_.fetch_add(1, std::memory_order_relaxed);
+    }
+    return true;
+  }
+  return false;
+}
+
+void WorkerPool::execute(size_t slot, Task task) {
+  RangeJob& job = *task.job;
+
+  // Верхние половины уходят в деку, где их могут украсть
+  while (task.end - task.begin > job.grain) {
+    const size_t middle = task.begin + (task.end - task.begin) / 2;
+    pushTask(slot, Task{task.job, middle, task.end});
+    task.end = middle;
+  }
+
+  try {
+    TraceScope trace("parallelFor", "pool");
+    job.invoke(job.body, slot, task.begin, task.end);
+  } catch (...) {
+    std::lock_guard lock(job.failureMutex);
+    if (!job.failure) job.failure = std::current_exception();
+  }
+  finish(job, task.end - task.begin);
+}
+
+void WorkerPool::finish(RangeJob& job, size_t items) {
+  if (job.remaining.fetch_sub(items, std::memory_order_acq_rel) == items) {
+    // Последний кусок: будим владельца, который мог уснуть
+    { std::lock_guard lock(wakeMutex_); }
+    wakeUp_.notify_all();
+  }
+}
+
+void WorkerPool::runJob(RangeJob& job, size_t count) {
+  const size_t slot = currentSlot();
+  execute(slot, Task{&job, 0, count});
+
+  while (job.remaining.load(std::memory_order_acquire) != 0) {
+    Task task;
+    if (popOwn(slot, &job, task) || steal(slot, &job, task)) {
+      execute(slot, task);
+      continue;
+    }
+
+    // Оставшиеся куски выполняют другие работники; изредка проверяем,
+    // не появились ли свободные куски своей работы
+    std::unique_lock lock(wakeMutex_);
+    wakeUp_.wait_for(lock, OWNER_RECHECK,
+                     [&]() { return job.remaining.load(std::memory_order_acquire) == 0; });
+  }
+
+  if (job.failure) {
+    std::rethrow_exception(job.failure);
+  }
+}
+
+void WorkerPool::workerLoop(size_t worker) {
+  localPool = this;
+  localSlot = worker;
+  TraceRecorder::setThreadName("работник " + std::to_string(worker));
+
+  while (true) {
+    Task task;
+    if (popOwn(worker, nullptr, task) || steal(worker, nullptr, task)) {
+      execute(worker, task);
+      continue;
+    }
+
+    std::unique_lock lock(wakeMutex_);
+    wakeUp_.wait(lock, [&]() {
+      return stopping_ || queuedTasks_.load(std::memory_order_acquire) > 0;
+    });
+    if (stopping_) return;
+  }
+}
@@ -1,5 +1,12 @@
-#include "include/game/dungeon_master.hpp"
-#include "include/game/constants.hpp"
+#include "../include/game/dungeon_master.hpp"
+#include "../include/game/constants.hpp"
+#include "../include/game/arena_settings.hpp"
+#include "../include/game/tick_scheduler.hpp"
+#include "../include/game/shard_coordinator.hpp"
+#include "../include/game/metrics.hpp"
+#include "../include/game/trace.hpp"
+#include "../include/game/trajectory.hpp"
+#include "../include/game/replay.hpp"
 #include <iostream>
 #include <thread>
 #include <atomic>
@@ -7,24 +14,77 @@
 #include <shared_mutex>
 #include <chrono>
 #include <queue>
-#include <condition_variable>
 #include <iomanip>
+#include <string>
+#include <cstdint>
+#include <memory>
+#include <algorithm>
+#include <vector>
+
+// Параметры запуска из командной строки. Параметры мира собираются
+// в settings: файл --config, поверх него --set и короткие флаги
+struct LaunchOptions {
+    bool headless = false;
+    bool showHelp = false;
+    ArenaSettings settings;
+    std::string configFile;
+    std::vector<std::string> overrides;
+    long long ticks = 1000;
+    bool ticksGiven = false;
+    uint64_t seed = 0;
+    bool seedGiven = false;
+    size_t processes = 1;
+    double tickRate = 0;
+    bool tickRateGiven = false;
+    std::string loadFile;
+    std::string saveFile;
+    std::string metricsFile;
+    long long metricsInterval = 1000;
+    std::string traceFile;
+    uint64_t traceFirstTick = 0;
+    uint64_t traceLastTick = UINT64_MAX;
+    size_t traceBuffer = ArenaConfig::Tracing::EVENTS_PER_THREAD;
+    std::string trajectoryFile;
+    std::string recordFile;
+    uint64_t recordKeyframes = ArenaConfig::Recording::REPLAY_KEYFRAME_TICKS;
+    std::string replayFile;
+    uint64_t replayTarget = UINT64_MAX;
+};
+
+// Трасса по параметрам запуска (nullptr - без трассы)
+std::unique_ptr<TraceRecorder> makeTracer(const LaunchOptions& options) {
+    if (options.traceFile.empty()) {
+        return nullptr;
+    }
+    TraceRecorder::setThreadName("main");
+    return std::make_unique<TraceRecorder>(options.traceFile, options.traceFirstTick,
+                                           options.traceLastTick, options.traceBuffer);
+}
+
+void reportTrace(TraceRecorder& tracer) {
+    tracer.finish();
+    std::cout << "Трасса записана в '" << tracer.getFileName() << "': событий "
+              << tracer.getEventCount() << ", отброшено " << tracer.getDroppedEvents() << "\n";
+}
 
 class GameSession {
 private:
+    // Реестр и трасса объявлены до мира: переживают всех, кто в них пишет
+    MetricsRegistry metrics;
+    std::unique_ptr<TraceRecorder> tracer;
     DungeonMaster world;
+    TickScheduler scheduler{1000.0 / arenaSettings().tickInterval};
     std::atomic<bool> sessionActive{true};
     std::chrono::seconds sessionDuration;
+    int population = 0;
+    std::string saveFile = "final_state.txt";
     
-    // Потоки
-    std::thread movementThread;
-    std::thread combatThread;
+    // Потоки: тики симуляции и вывод (читает кадры мира без блокировок)
+    std::thread simulationThread;
     std::thread displayThread;
     
-    // Синхронизация
     std::mutex consoleMutex;
-    std::condition_variable combatReady;
-    std::atomic<int> pendingCombats{0};
+    std::unique_ptr<MetricsExporter> exporter;
     
     void displayBanner() {
         std::lock_guard<std::mutex> lock(consoleMutex);
@@ -47,73 +107,63 @@ private:
     }
     
 public:
-    GameSession(int durationSeconds) : sessionDuration(durationSeconds) {
+    GameSession(int durationSeconds, const LaunchOptions& options)
+        : tracer(makeTracer(options)), sessionDuration(durationSeconds) {
         displayBanner();
-        world.initializeCreatures(ArenaConfig::INITIAL_POPULATION);
+        if (options.seedGiven) {
+            world.setSeed(options.seed);
+        }
+        if (!options.loadFile.empty()) {
+            world.loadScenario(options.loadFile);
+        } else {
+            world.initializeCreatures(arenaSettings().population);
+        }
+        population = static_cast<int>(world.getCreatureCount());
+        if (!options.saveFile.empty()) {
+            saveFile = options.saveFile;
+        }
+        world.registerTickPhases(scheduler);
+        // Без флага темп - из timing.tick_interval
+        if (options.tickRateGiven) {
+            scheduler.setTickRate(options.tickRate);
+        }
+        if (!options.metricsFile.empty()) {
+            world.enableMetrics(metrics);
+            scheduler.setTickLatency(&metrics.histogram("arena_tick_seconds", "Длительность тика"));
+            exporter = std::make_unique<MetricsExporter>(
+                metrics, options.metricsFile, std::chrono::milliseconds(options.metricsInterval));
+        }
         
         std::cout << "Инициализация арены...\n";
-        std::cout << "Создано " << ArenaConfig::INITIAL_POPULATION << " существ в случайных позициях\n";
+        if (!options.loadFile.empty()) {
+            std::cout << "Загружено " << population << " существ из '" << options.loadFile << "'\n";
+        } else {
+            std::cout << "Создано " << population << " существ в случайных позициях\n";
+        }
         std::cout << "Длительность сессии: " << durationSeconds << " секунд\n";
         std::cout << "──────────────────────────────────────────────\n";
     }
     
-    void movementTask() {
-        std::random_device rd;
-        std::mt19937 gen(rd());
-        
-        while (sessionActive) {
-            {
-                // Используем shared_lock для чтения
-                std::unique_lock lock(*world.getMutex());
-                world.processMovementPhase();
-                world.detectPotentialCombats();
-                pendingCombats++;
-            }
-            
-            combatReady.notify_one();
-            std::this_thread::sleep_for(std::chrono::milliseconds(ArenaConfig::Timing::MOVEMENT_INTERVAL));
-        }
-    }
-    
-    void combatTask() {
-        while (sessionActive) {
-            std::unique_lock<std::mutex> lock(consoleMutex, std::defer_lock);
-            
-            // Ждем новые бои
-            std::unique_lock<std::mutex> cvLock(consoleMutex);
-            combatReady.wait_for(cvLock, std::chrono::milliseconds(100),
-                [this]() { return pendingCombats > 0 || !sessionActive; });
-            
-            if (pendingCombats > 0) {
-                pendingCombats--;
-                cvLock.unlock();
-                
-                {
-                    // Используем unique_lock для записи
-                    std::unique_lock lock(*world.getMutex());
-                    world.resolveCombatQueue();
-                }
-            }
-            
-            std::this_thread::sleep_for(std::chrono::milliseconds(ArenaConfig::Timing::COMBAT_INTERVAL));
-        }
+    void simulationTask() {
+        TraceRecorder::setThreadName("simulationTask");
+        // Фазы тика идут по графу в фиксированном темпе
+        scheduler.run(SIZE_MAX, [this]() { return sessionActive.load(); });
     }
     
     void displayTask() {
+        TraceRecorder::setThreadName("displayTask");
         int tick = 0;
         
         while (sessionActive) {
+            TraceScope trace("displayTask", "session");
             {
                 std::lock_guard<std::mutex> lock(consoleMutex);
                 std::cout << "\n=== ТИК " << ++tick << " ===" << std::endl;
-                
-                // Используем shared_lock для чтения
-                std::shared_lock lock(*world.getMutex());
                 world.renderMap();
-                displayStats();
             }
+            displayStats();
             
-            std::this_thread::sleep_for(std::chrono::seconds(1));
+            std::this_thread::sleep_for(std::chrono::milliseconds(arenaSettings().displayInterval));
         }
     }
     
@@ -121,21 +171,19 @@ public:
         auto startTime = std::chrono::steady_clock::now();
         
         // Запускаем потоки
-        movementThread = std::thread(&GameSession::movementTask, this);
-        combatThread = std::thread(&GameSession::combatTask, this);
+        simulationThread = std::thread(&GameSession::simulationTask, this);
         displayThread = std::thread(&GameSession::displayTask, this);
         
         // Ожидаем завершения времени сессии
         std::this_thread::sleep_for(sessionDuration);
         sessionActive = false;
         
-        // Уведомляем все потоки
-        combatReady.notify_all();
-        
         // Ждем завершения потоков
-        if (movementThread.joinable()) movementThread.join();
-        if (combatThread.joinable()) combatThread.join();
+        if (simulationThread.joinable()) simulationThread.join();
         if (displayThread.joinable()) displayThread.join();
+        if (tracer) {
+            reportTrace(*tracer);
+        }
         
         // Вывод финальных результатов
         displayFinalResults();
@@ -150,9 +198,9 @@ public:
         std::cout << "╠══════════════════════════════════════╣\n";
         std::cout << "║        ФИНАЛЬНАЯ СТАТИСТИКА         ║\n";
         std::cout << "╠══════════════════════════════════════╣\n";
-        std::cout << "║ Начало: " << ArenaConfig::INITIAL_POPULATION << " существ          ║\n";
+        std::cout << "║ Начало: " << population << " существ          ║\n";
         std::cout << "║ Выжило: " << std::setw(4) << stats.aliveCreatures << " существ          ║\n";
-        std::cout << "║ Уничтожено: " << std::setw(3) << (ArenaConfig::INITIAL_POPULATION - stats.aliveCreatures) << " существ        ║\n";
+        std::cout << "║ Уничтожено: " << std::setw(3) << (population - stats.aliveCreatures) << " существ        ║\n";
         std::cout << "╠══════════════════════════════════════╣\n";
         std::cout << "║         ВЫЖИВШИЕ СУЩЕСТВА           ║\n";
         std::cout << "╚══════════════════════════════════════╝\n\n";
@@ -161,17 +209,385 @@ public:
         
         // Сохранение финального состояния
         try {
-            world.saveScenario("final_state.txt");
-            std::cout << "\nФинальное состояние сохранено в файл 'final_state.txt'\n";
+            world.saveScenario(saveFile);
+            std::cout << "\nФинальное состояние сохранено в файл '" << saveFile << "'\n";
         } catch (const std::exception& e) {
             std::cout << "\nНе удалось сохранить финальное состояние: " << e.what() << "\n";
         }
     }
 };
 
-int main() {
+// Безголовый режим: фазы идут подряд без пауз и без вывода карты
+class HeadlessSession {
+private:
+    MetricsRegistry metrics;
+    std::unique_ptr<TraceRecorder> tracer;
+    DungeonMaster world{false};
+    TickScheduler scheduler;
+    LaunchOptions options;
+    int population;
+    // Распределенная арена: тик целиком ведут процессы-шарды
+    std::unique_ptr<ShardCoordinator> shards;
+    std::unique_ptr<MetricsExporter> exporter;
+    std::unique_ptr<Trajectory::Writer> trajectory;
+    // Объявлены после мира: отключаются от него раньше, чем он разрушится
+    std::unique_ptr<Replay::Recorder> recorder;
+    std::unique_ptr<Replay::Player> replay;
+    
+    DungeonMaster::GameStats currentStats() const {
+        return shards ? shards->getStats() : world.getCurrentStats();
+    }
+    
+    // Кадр мира публикуется в конце тика; запись только квантует его
+    void captureTrajectory() {
+        world.readFrame([this](const DungeonMaster::WorldFrame& frame) {
+            trajectory->capture(frame.creatures, frame.tick);
+        });
+    }
+    
+public:
+    // Мир, потоки и тайлы берутся из настроек процесса (applyArenaSettings)
+    explicit HeadlessSession(const LaunchOptions& launchOptions)
+        : tracer(makeTracer(launchOptions)), options(launchOptions),
+          population(arenaSettings().population) {
+        if (options.processes > 1) {
+            // Тик ведут шарды; fork() допустим только из однопоточного
+            // процесса, поэтому мир остается без рабочих потоков
+            world.setWorkerThreads(1);
+        }
+        if (options.seedGiven) {
+            world.setSeed(options.seed);
+        }
+        if (!options.replayFile.empty()) {
+            // Ближайший опорный кадр, дальше тики считаются заново до цели
+            replay = std::make_unique<Replay::Player>(options.replayFile);
+            const uint64_t target = std::min(options.replayTarget, replay->endTick());
+            const uint64_t restored = replay->restore(world, target);
+            options.ticks = static_cast<long long>(target - restored);
+            population = static_cast<int>(world.getCreatureCount());
+        } else if (!options.loadFile.empty()) {
+            world.loadScenario(options.loadFile);
+            population = static_cast<int>(world.getCreatureCount());
+        } else {
+            world.initializeCreatures(population);
+        }
+        
+        if (options.processes > 1) {
+            shards = std::make_unique<ShardCoordinator>(world, options.processes);
+            scheduler.setWorkerPool(world.getWorkerPool());
+            scheduler.addPhase("шарды", [this]() { shards->runTick(); });
+        } else {
+            world.registerTickPhases(scheduler);
+        }
+        scheduler.setTickRate(options.tickRate);
+        
+        if (!options.trajectoryFile.empty()) {
+            const Trajectory::WriterOptions recording{ArenaConfig::Recording::TRAJECTORY_QUANTUM,
+                                                      ArenaConfig::Recording::TRAJECTORY_CHUNK_TICKS,
+                                                      ArenaConfig::Recording::TRAJECTORY_BUFFERED_TICKS};
+            trajectory = std::make_unique<Trajectory::Writer>(options.trajectoryFile, arenaSettings().world,
+                                                              world.getSeed(), recording);
+            captureTrajectory();
+        }
+        
+        if (!options.recordFile.empty()) {
+            recorder = std::make_unique<Replay::Recorder>(options.recordFile, world, options.recordKeyframes);
+        }
+        
+        if (!options.metricsFile.empty()) {
+            // Шарды считают тик в своих процессах: у мира остаются только сохранение и загрузка
+            world.enableMetrics(metrics);
+            scheduler.setTickLatency(&metrics.histogram("arena_tick_seconds", "Длительность тика"));
+            exporter = std::make_unique<MetricsExporter>(
+                metrics, options.metricsFile, std::chrono::milliseconds(options.metricsInterval));
+        }
+    }
+    
+    void run() {
+        double creatureTicks = 0;
+        
+        auto startTime = std::chrono::steady_clock::now();
+        for (long long tick = 0; tick < options.ticks; ++tick) {
+            creatureTicks += currentStats().aliveCreatures;
+            scheduler.waitForNextTick();
+            if (replay) {
+                replay->applyInputs(world);
+            }
+            scheduler.runTick();
+            if (trajectory) {
+                captureTrajectory();
+            }
+            if (recorder) {
+                recorder->afterTick();
+            }
+        }
+        auto finishTime = std::chrono::steady_clock::now();
+        
+        double elapsed = std::chrono::duration<double>(finishTime - startTime).count();
+        displayReport(elapsed, creatureTicks);
+        
+        if (replay) {
+            std::cout << "Повтор '" << options.replayFile << "': тики " << replay->startTick() << ".."
+                      << replay->endTick() << ", опорных кадров " << replay->keyframeCount()
+                      << ", воздействий " << replay->inputCount() << ", мир на тике " << world.getTick() << "\n";
+            if (world.getTick() == replay->endTick()) {
+                std::cout << (replay->finish(world) ? "Итог совпал с записью\n"
+                                                    : "Итог РАСХОДИТСЯ с записью\n");
+            }
+        }
+        if (recorder) {
+            recorder->close();
+            auto recorded = recorder->getStats();
+            std::cout << "Повтор записан в '" << options.recordFile << "': тиков " << recorded.ticks
+                      << ", воздействий " << recorded.inputs << ", опорных кадров " << recorded.keyframes
+                      << ", " << recorded.bytes << " байт\n";
+        }
+        if (!options.saveFile.empty()) {
+            if (shards) {
+                shards->collect();
+            }
+            world.saveScenario(options.saveFile);
+            std::cout << "Состояние сохранено в файл '" << options.saveFile << "'\n";
+        }
+        if (trajectory) {
+            trajectory->close();
+            auto recorded = trajectory->getStats();
+            std::cout << "Траектории записаны в '" << options.trajectoryFile << "': тиков " << recorded.ticks
+                      << ", кусков " << recorded.chunks << ", " << recorded.bytes << " байт (без сжатия "
+                      << recorded.rawBytes << "), ожиданий записи " << recorded.stalls << "\n";
+        }
+        if (tracer) {
+            reportTrace(*tracer);
+        }
+    }
+    
+    void displayReport(double elapsed, double creatureTicks) {
+        auto stats = currentStats();
+        auto perTick = [this](double seconds) {
+            return options.ticks > 0 ? seconds * 1000.0 / options.ticks : 0.0;
+        };
+        
+        std::cout << std::fixed << std::setprecision(3);
+        std::cout << "=== БЕЗГОЛОВЫЙ РЕЖИМ ===\n";
+        std::cout << "Существ: " << population
+                  << ", тиков: " << options.ticks
+                  << ", потоков: " << world.getWorkerThreads()
+                  << ", тайлов: " << world.getTileStats().tiles
+                  << ", процессов: " << options.processes
+                  << ", зерно: " << world.getSeed() << "\n";
+        if (scheduler.getTickRate() > 0) {
+            std::cout << "Темп: " << scheduler.getTickRate() << " тиков/с, просрочено тиков: "
+                      << scheduler.getOverruns() << "\n";
+        }
+        std::cout << "Время: " << elapsed << " с\n";
+        std::cout << "Тиков/с: " << (elapsed > 0 ? options.ticks / elapsed : 0.0) << "\n";
+        std::cout << "Существо-тиков/с: " << (elapsed > 0 ? creatureTicks / elapsed : 0.0) << "\n";
+        std::cout << "Фазы, мс/тик (всего, с; максимум, мс):\n";
+        for (const auto& phase : scheduler.getTimings()) {
+            std::cout << "  " << phase.name << ": " << perTick(phase.totalSeconds)
+                      << " (" << phase.totalSeconds << "; " << phase.maxSeconds * 1000.0 << ")\n";
+        }
+        std::cout << "Выжило: " << stats.aliveCreatures << " (рыцари " << stats.knights
+                  << ", эльфы " << stats.elves << ", драконы " << stats.dragons << ")\n";
+        
+        auto queue = world.getCombatQueueStats();
+        std::cout << "Очередь боев: пик " << queue.highWaterMark << " из " << queue.capacity
+                  << ", всего " << queue.pushed << ", в резерв " << queue.overflowed << "\n";
+        
+        auto tiles = world.getTileStats();
+        if (tiles.tiles > 0) {
+            std::cout << "Тайлы: мигрантов " << tiles.migrants << ", в ореолах " << tiles.haloCreatures
+                      << ", пограничных боев " << tiles.deferredCombats << " (последний тик)\n";
+        }
+        
+        if (shards) {
+            auto sharded = shards->getShardStats();
+            std::cout << "Шарды: " << sharded.shards << ", мигрантов " << sharded.migrants
+                      << ", в ореолах " << sharded.haloCreatures << ", пограничных боев "
+                      << sharded.deferredCombats << " (последний тик), передано "
+                      << sharded.bytesSent + sharded.bytesReceived << " байт\n";
+        }
+    }
+};
+
+void displayUsage(const char* program) {
+    std::cout << "Использование: " << program << " [--headless] [параметры]\n"
+              << "  --headless          симуляция без пауз и вывода карты\n"
+              << "  --config FILE       файл настроек мира (строки \"ключ = значение\")\n"
+              << "  --set KEY=VALUE     параметр настроек поверх файла (world.max_x=5000, elf.range=40...)\n"
+              << "  --population N      число существ (по умолчанию "
+              << ArenaConfig::INITIAL_POPULATION << ")\n"
+              << "  --ticks N           число тиков (только --headless, по умолчанию 1000)\n"
+              << "  --seed S            главное зерно симуляции\n"
+              << "  --threads N         число рабочих потоков (по умолчанию - по числу ядер)\n"
+              << "  --tiles N           разбиение мира на N x N тайлов (0 - без тайлов, по умолчанию "
+              << ArenaConfig::Sharding::TILE_COLUMNS << ")\n"
+              << "  --processes N       распределенная арена из N процессов (только --headless)\n"
+              << "  --tick-rate HZ      темп тиков в секунду (0 - без пауз; по умолчанию без пауз\n"
+              << "                      в --headless и timing.tick_interval в окне)\n"
+              << "  --load FILE         начать с сохраненного сценария или снимка\n"
+              << "  --save FILE         сохранить итог (" << ArenaConfig::Files::SNAPSHOT_EXTENSION
+              << " - двоичный снимок; окно без флага пишет final_state.txt)\n"
+              << "  --metrics FILE      периодическая выгрузка метрик (.json - JSON, иначе Prometheus)\n"
+              << "  --metrics-interval MS  период выгрузки метрик (по умолчанию 1000)\n"
+              << "  --trajectory FILE   траектории по тикам (только --headless, без --processes)\n"
+              << "  --record FILE       запись повтора: начальный мир, зерно и воздействия (только --headless,\n"
+              << "                      без --processes)\n"
+              << "  --record-keyframes N  опорный кадр повтора каждые N тиков (по умолчанию "
+              << ArenaConfig::Recording::REPLAY_KEYFRAME_TICKS << ")\n"
+              << "  --replay FILE       воспроизвести запись (только --headless, вместо --load;\n"
+              << "                      мир, шаги и дальности - из записи)\n"
+              << "  --replay-to TICK    остановить повтор на тике (по умолчанию - конец записи)\n"
+              << "  --trace FILE        трасса Chrome/Perfetto (JSON Trace Event)\n"
+              << "  --trace-ticks A:B   окно тиков трассы (с нуля, включительно; по умолчанию - все)\n"
+              << "  --trace-buffer N    событий трассы на поток (по умолчанию "
+              << ArenaConfig::Tracing::EVENTS_PER_THREAD << ")\n"
+              << "  --help              эта справка\n";
+}
+
+LaunchOptions parseOptions(int argc, char* argv[]) {
+    LaunchOptions options;
+    
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto value = [&]() -> std::string {
+            if (i + 1 >= argc) {
+                throw std::invalid_argument("Не указано значение для " + arg);
+            }
+            return argv[++i];
+        };
+        
+        if (arg == "--headless") {
+            options.headless = true;
+        } else if (arg == "--config") {
+            options.configFile = value();
+        } else if (arg == "--set") {
+            options.overrides.push_back(value());
+        } else if (arg == "--population") {
+            options.overrides.push_back("population=" + value());
+        } else if (arg == "--ticks") {
+            options.ticks = std::stoll(value());
+            options.ticksGiven = true;
+        } else if (arg == "--seed") {
+            options.seed = std::stoull(value());
+            options.seedGiven = true;
+        } else if (arg == "--threads") {
+            options.overrides.push_back("threads=" + value());
+        } else if (arg == "--tiles") {
+            options.overrides.push_back("tiles=" + value());
+        } else if (arg == "--processes") {
+            options.processes = std::stoul(value());
+        } else if (arg == "--tick-rate") {
+            options.tickRate = std::stod(value());
+            options.tickRateGiven = true;
+        } else if (arg == "--load") {
+            options.loadFile = value();
+        } else if (arg == "--save") {
+            options.saveFile = value();
+        } else if (arg == "--metrics") {
+            options.metricsFile = value();
+        } else if (arg == "--metrics-interval") {
+            options.metricsInterval = std::stoll(value());
+        } else if (arg == "--trajectory") {
+            options.trajectoryFile = value();
+        } else if (arg == "--record") {
+            options.recordFile = value();
+        } else if (arg == "--record-keyframes") {
+            options.recordKeyframes = std::stoull(value());
+        } else if (arg == "--replay") {
+            options.replayFile = value();
+        } else if (arg == "--replay-to") {
+            options.replayTarget = std::stoull(value());
+        } else if (arg == "--trace") {
+            options.traceFile = value();
+        } else if (arg == "--trace-ticks") {
+            const std::string window = value();
+            const auto colon = window.find(':');
+            if (colon == std::string::npos) {
+                throw std::invalid_argument("Окно трассы задается как ПЕРВЫЙ:ПОСЛЕДНИЙ");
+            }
+            options.traceFirstTick = std::stoull(window.substr(0, colon));
+            options.traceLastTick = std::stoull(window.substr(colon + 1));
+        } else if (arg == "--trace-buffer") {
+            options.traceBuffer = std::stoul(value());
+        } else if (arg == "--help" || arg == "-h") {
+            options.showHelp = true;
+        } else {
+            throw std::invalid_argument("Неизвестный параметр: " + arg);
+        }
+    }
+    
+    if (options.ticks < 0 || options.tickRate < 0 || options.metricsInterval <= 0 ||
+        options.recordKeyframes == 0) {
+        throw std::invalid_argument("Параметры запуска должны быть положительными");
+    }
+    // Несовместимые режимы отклоняются до запуска мира и шардов.
+    // Окно длится заданное число секунд, а не тиков
+    if (options.ticksGiven && !options.headless) {
+        throw std::invalid_argument("--ticks работает только с --headless");
+    }
+    if (!options.trajectoryFile.empty() && !options.headless) {
+        throw std::invalid_argument("--trajectory работает только с --headless");
+    }
+    if (!options.recordFile.empty() && !options.headless) {
+        throw std::invalid_argument("--record работает только с --headless");
+    }
+    if (options.processes > 1) {
+        if (!options.headless) {
+            throw std::invalid_argument("--processes работает только с --headless");
+        }
+        if (!options.trajectoryFile.empty()) {
+            throw std::invalid_argument("Траектории пишутся только без --processes");
+        }
+        if (!options.recordFile.empty()) {
+            throw std::invalid_argument("Повтор пишется только без --processes");
+        }
+    }
+    // Снимок переносит свое зерно и тик - явное зерно было бы молча потеряно
+    if (options.seedGiven && !options.loadFile.empty() && Snapshot::looksLikeSnapshot(options.loadFile)) {
+        throw std::invalid_argument("--seed нельзя сочетать с загрузкой снимка: зерно берется из снимка");
+    }
+    if (!options.replayFile.empty()) {
+        if (!options.headless || !options.loadFile.empty() || options.processes > 1) {
+            throw std::invalid_argument("--replay работает только с --headless, без --load и --processes");
+        }
+        if (options.seedGiven) {
+            throw std::invalid_argument("--seed нельзя сочетать с --replay: зерно берется из записи");
+        }
+    }
+    
+    // Командная строка сильнее файла независимо от порядка флагов
+    if (!options.configFile.empty()) {
+        options.settings.loadFile(options.configFile);
+    }
+    for (const auto& assignment : options.overrides) {
+        options.settings.set(assignment);
+    }
+    if (!options.replayFile.empty()) {
+        // Мир, шаги и дальности повтора - из записи, поверх файла и --set
+        Replay::Player(options.replayFile).applySettings(options.settings);
+    }
+    options.settings.validate();
+    return options;
+}
+
+int main(int argc, char* argv[]) {
     try {
-        const int DEFAULT_SESSION_TIME = 30;
+        LaunchOptions options = parseOptions(argc, argv);
+        
+        if (options.showHelp) {
+            displayUsage(argv[0]);
+            return 0;
+        }
+        applyArenaSettings(options.settings);
+        
+        if (options.headless) {
+            HeadlessSession session(options);
+            session.run();
+            return 0;
+        }
+        
+        const int DEFAULT_SESSION_TIME = std::max(1, arenaSettings().sessionDuration / 1000);
         
         std::cout << "Введите длительность сессии (секунд, по умолчанию " 
                   << DEFAULT_SESSION_TIME << "): ";
@@ -189,7 +605,7 @@ int main() {
             }
         }
         
-        GameSession arena(sessionTime);
+        GameSession arena(sessionTime, options);
         arena.run();
         
     } catch (const std::exception& e) {
@@ -1,28 +1,28 @@
 #include "../../include/npc/npc.hpp"
 #include "../../include/npc/dragon.hpp"
-#include "../../include/game/constants.hpp"
+#include "../../include/game/arena_settings.hpp"
+#include "../../include/game/random_stream.hpp"
 
 Dragon::Dragon(): NPC(NPCType::DRAGON) {}
 
+Dragon::Dragon(std::shared_ptr<CreatureStore> owner, size_t slot): NPC(std::move(owner), slot) {}
+
 Dragon::Dragon(double x, double y, const std::string &name): 
   NPC(NPCType::DRAGON, x, y, name,
-      ArenaConfig::Mobility::DRAGON_STEP,
-      ArenaConfig::Combat::DRAGON_BREATH_RANGE) {}
+      arenaSettings().step[NPCType::DRAGON],
+      arenaSettings().range[NPCType::DRAGON]) {}
 
 Dragon::Dragon(double x, double y):
   NPC(NPCType::DRAGON, x, y, generateRandomName(NPCType::DRAGON),
-      ArenaConfig::Mobility::DRAGON_STEP,
-      ArenaConfig::Combat::DRAGON_BREATH_RANGE) {}
+      arenaSettings().step[NPCType::DRAGON],
+      arenaSettings().range[NPCType::DRAGON]) {}
 
 std::string Dragon::getColor() const {
   static const std::vector<std::string> colors = {
     "Красный", "Зеленый", "Синий", "Черный", "Золотой", "Серебряный", "Бронзовый"
   };
-  static std::random_device rd;
-  static std::mt19937 gen(rd());
-  std::uniform_int_distribution<int> dist(0, colors.size() - 1);
-  
-  return colors[dist(gen)];
+  RandomStream stream = nextSharedStream(RandomPurpose::TRAITS);
+  return colors[stream.uniformInt(0, static_cast<int>(colors.size()) - 1)];
 }
 
 bool Dragon::canFly() const {
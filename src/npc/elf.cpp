@@ -1,28 +1,28 @@
 #include "../../include/npc/npc.hpp"
 #include "../../include/npc/elf.hpp"
-#include "../../include/game/constants.hpp"
+#include "../../include/game/arena_settings.hpp"
+#include "../../include/game/random_stream.hpp"
 
 Elf::Elf(): NPC(NPCType::ELF) {}
 
+Elf::Elf(std::shared_ptr<CreatureStore> owner, size_t slot): NPC(std::move(owner), slot) {}
+
 Elf::Elf(double x, double y, const std::string &name): 
   NPC(NPCType::ELF, x, y, name,
-      ArenaConfig::Mobility::ELF_STEP,
-      ArenaConfig::Combat::ELF_BOW_RANGE) {}
+      arenaSettings().step[NPCType::ELF],
+      arenaSettings().range[NPCType::ELF]) {}
 
 Elf::Elf(double x, double y):
   NPC(NPCType::ELF, x, y, generateRandomName(NPCType::ELF),
-      ArenaConfig::Mobility::ELF_STEP,
-      ArenaConfig::Combat::ELF_BOW_RANGE) {}
+      arenaSettings().step[NPCType::ELF],
+      arenaSettings().range[NPCType::ELF]) {}
 
 std::string Elf::getClan() const {
   static const std::vector<std::string> clans = {
     "Лунный", "Лесной", "Речной", "Горный", "Звездный", "Теневой"
   };
-  static std::random_device rd;
-  static std::mt19937 gen(rd());
-  std::uniform_int_distribution<int> dist(0, clans.size() - 1);
-  
-  return clans[dist(gen)];
+  RandomStream stream = nextSharedStream(RandomPurpose::TRAITS);
+  return clans[stream.uniformInt(0, static_cast<int>(clans.size()) - 1)];
 }
 
 bool Elf::canUseMagic() const {
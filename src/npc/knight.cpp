@@ -1,28 +1,28 @@
 #include "../../include/npc/npc.hpp"
 #include "../../include/npc/knight.hpp"
-#include "../../include/game/constants.hpp"
+#include "../../include/game/arena_settings.hpp"
+#include "../../include/game/random_stream.hpp"
 
 Knight::Knight(): NPC(NPCType::KNIGHT) {}
 
+Knight::Knight(std::shared_ptr<CreatureStore> owner, size_t slot): NPC(std::move(owner), slot) {}
+
 Knight::Knight(double x, double y, const std::string &name):
   NPC(NPCType::KNIGHT, x, y, name, 
-      ArenaConfig::Mobility::KNIGHT_STEP, 
-      ArenaConfig::Combat::KNIGHT_SWORD_REACH) {}
+      arenaSettings().step[NPCType::KNIGHT],
+      arenaSettings().range[NPCType::KNIGHT]) {}
 
 Knight::Knight(double x, double y):
   NPC(NPCType::KNIGHT, x, y, generateRandomName(NPCType::KNIGHT),
-      ArenaConfig::Mobility::KNIGHT_STEP,
-      ArenaConfig::Combat::KNIGHT_SWORD_REACH) {}
+      arenaSettings().step[NPCType::KNIGHT],
+      arenaSettings().range[NPCType::KNIGHT]) {}
 
 std::string Knight::getTitle() const {
   static const std::vector<std::string> titles = {
     "Сэр", "Лорд", "Барон", "Герцог", "Граф", "Витязь", "Паладин"
   };
-  static std::random_device rd;
-  static std::mt19937 gen(rd());
-  std::uniform_int_distribution<int> dist(0, titles.size() - 1);
-  
-  return titles[dist(gen)];
+  RandomStream stream = nextSharedStream(RandomPurpose::TRAITS);
+  return titles[stream.uniformInt(0, static_cast<int>(titles.size()) - 1)];
 }
 
 bool Knight::canDefend() const {
@@ -1,69 +1,88 @@
 #include "../../include/npc/npc.hpp"
-#include "../../include/game/constants.hpp"
+#include "../../include/game/arena_settings.hpp"
+#include "../../include/game/creature_store.hpp"
+#include "../../include/game/random_stream.hpp"
+#include "../../include/game/creature_pool.hpp"
 #include <string>
 #include <cmath>
 #include <array>
 #include <algorithm>
-#include <random>
 #include <sstream>
 
-NPC::NPC(): type_(NPCType::UNKNOWN) {}
+NPC::NPC(): NPC(NPCType::UNKNOWN) {}
 
-NPC::NPC(NPCType type): type_(type) {}
+NPC::NPC(NPCType type): NPC(type, 0, 0, "", 1.0, 1.0) {}
 
 NPC::NPC(NPCType type, double x, double y, const std::string &name, 
          double moveDistance, double attackRange): 
-  type_(type), x_(x), y_(y), name_(name), 
-  moveDistance_(moveDistance), attackRange_(attackRange) {}
+  owner_(std::make_shared<CreatureStore>()), store_(owner_.get()),
+  slot_(store_->add(type, x, y, name, moveDistance, attackRange)) {}
+
+NPC::NPC(CreatureStore &store, size_t slot): store_(&store), slot_(slot) {}
+
+NPC::NPC(std::shared_ptr<CreatureStore> owner, size_t slot):
+  owner_(std::move(owner)), store_(owner_.get()), slot_(slot) {}
+
+static_assert(sizeof(NPC) <= CreaturePool::SLOT_SIZE, "NPC не помещается в слот пула");
+
+void *NPC::operator new(size_t size) {
+  return CreaturePool::allocate(size);
+}
+
+void NPC::operator delete(void *pointer, size_t size) {
+  CreaturePool::deallocate(pointer, size);
+}
+
+size_t NPC::getSlot() const {
+  return slot_;
+}
 
 NPCType NPC::getType() const {
-  return type_;
+  return store_->type(slot_);
 }
 
 std::string NPC::getTypeString() const {
-  switch (type_) {
-    case NPCType::KNIGHT: return "Странствующий рыцарь";
-    case NPCType::ELF: return "Эльф";
-    case NPCType::DRAGON: return "Дракон";
-    default: return "Неизвестный";
-  }
+  return convertTypeToString(getType());
 }
 
 double NPC::getX() const {
-  std::shared_lock lock(positionMutex_);
-  return x_;
+  return store_->x(slot_);
 }
 
 double NPC::getY() const {
-  std::shared_lock lock(positionMutex_);
-  return y_;
+  return store_->y(slot_);
 }
 
 std::pair<double, double> NPC::getPosition() const {
-  std::shared_lock lock(positionMutex_);
-  return {x_, y_};
+  return {store_->x(slot_), store_->y(slot_)};
 }
 
 std::string NPC::getName() const {
-  return name_;
+  return std::string(store_->name(slot_));
+}
+
+NameId NPC::getNameId() const {
+  return store_->nameId(slot_);
+}
+
+std::string_view NPC::getNameView() const {
+  return store_->name(slot_);
 }
 
 bool NPC::isAlive() const {
-  std::lock_guard lock(stateMutex_);
-  return alive_;
+  return store_->isAlive(slot_);
 }
 
 double NPC::getMoveDistance() const {
-  return moveDistance_;
+  return store_->moveDistance(slot_);
 }
 
 double NPC::getAttackRange() const {
-  return attackRange_;
+  return store_->attackRange(slot_);
 }
 
 void NPC::setAlive(bool alive) {
-  std::lock_guard lock(stateMutex_);
-  alive_ = alive;
+  store_->setAlive(slot_, alive);
 }
 
 void NPC::move(MoveDirection direction) {
@@ -71,67 +90,43 @@ void NPC::move(MoveDirection direction) {
     return;
   }
 
-  std::unique_lock lock(positionMutex_);
-  switch (direction) {
-    case MoveDirection::TOP: 
-      y_ = std::clamp(y_ + moveDistance_, ArenaConfig::WORLD_MIN_Y, ArenaConfig::WORLD_MAX_Y); 
-      break;
-    case MoveDirection::RIGHT: 
-      x_ = std::clamp(x_ + moveDistance_, ArenaConfig::WORLD_MIN_X, ArenaConfig::WORLD_MAX_X); 
-      break;
-    case MoveDirection::BOTTOM: 
-      y_ = std::clamp(y_ - moveDistance_, ArenaConfig::WORLD_MIN_Y, ArenaConfig::WORLD_MAX_Y); 
-      break;
-    case MoveDirection::LEFT: 
-      x_ = std::clamp(x_ - moveDistance_, ArenaConfig::WORLD_MIN_X, ArenaConfig::WORLD_MAX_X); 
-      break;
-  }
+  store_->move(slot_, direction);
 }
 
 void NPC::updatePosition(double newX, double newY) {
-  std::unique_lock lock(positionMutex_);
-  x_ = newX;
-  y_ = newY;
+  store_->setPosition(slot_, newX, newY);
 }
 
 bool NPC::isValidPosition(double x, double y) const {
-  return (x >= ArenaConfig::WORLD_MIN_X && x <= ArenaConfig::WORLD_MAX_X &&
-          y >= ArenaConfig::WORLD_MIN_Y && y <= ArenaConfig::WORLD_MAX_Y);
+  return arenaSettings().world.contains(x, y);
 }
 
 bool NPC::canKill(const NPC &other) const {
-  if (!isAlive() || !other.isAlive()) {
+  if (!canPrey(getType(), other.getType()) || !isAlive() || !other.isAlive()) {
     return false;
   }
 
-  if (distance(other) <= attackRange_) {
-    switch (type_) {
-      case NPCType::KNIGHT: return (other.type_ == NPCType::DRAGON);
-      case NPCType::ELF: return (other.type_ == NPCType::KNIGHT);
-      case NPCType::DRAGON: return true;
-      default: return false;
-    }
-  }
-  return false;
+  const double distanceX = getX() - other.getX();
+  const double distanceY = getY() - other.getY();
+  const double range = getAttackRange();
+  return distanceX * distanceX + distanceY * distanceY <= range * range;
 }
 
 bool NPC::isWithinRange(const NPC &other) const {
-  return distance(other) <= attackRange_;
+  return distance(other) <= getAttackRange();
 }
 
 bool NPC::hasAdvantageOver(const NPC &other) const {
-  switch (type_) {
-    case NPCType::KNIGHT: return other.type_ == NPCType::DRAGON;
-    case NPCType::ELF: return other.type_ == NPCType::KNIGHT;
-    case NPCType::DRAGON: return true;
-    default: return false;
-  }
+  return canPrey(getType(), other.getType());
 }
 
 void NPC::load(std::ifstream &in) {
-  std::string type;
-  in >> type >> name_ >> x_ >> y_;
-  type_ = convertTypeFromString(type);
+  std::string type, name;
+  double x, y;
+  in >> type >> name >> x >> y;
+  store_->setType(slot_, convertTypeFromString(type));
+  store_->setName(slot_, name);
+  store_->setPosition(slot_, x, y);
 }
 
 void NPC::save(std::ofstream &out) const {
@@ -140,29 +135,29 @@ void NPC::save(std::ofstream &out) const {
   }
 
   out << getTypeString() << " "
-      << name_ << " "
-      << x_ << " "
-      << y_ << " "
+      << getNameView() << " "
+      << getX() << " "
+      << getY() << " "
       << (isAlive() ? "жив" : "мертв") << "\n";
 }
 
 void NPC::display() const {
   std::cout << getTypeString() << " " 
-            << name_ << " ["
-            << x_ << ", "
-            << y_ << "] "
+            << getNameView() << " ["
+            << getX() << ", "
+            << getY() << "] "
             << (isAlive() ? "жив" : "мертв") << "\n";
 }
 
 std::string NPC::serialize() const {
   std::stringstream ss;
-  ss << static_cast<int>(type_) << " "
-     << name_ << " "
-     << x_ << " "
-     << y_ << " "
-     << alive_ << " "
-     << moveDistance_ << " "
-     << attackRange_;
+  ss << static_cast<int>(getType()) << " "
+     << getNameView() << " "
+     << getX() << " "
+     << getY() << " "
+     << isAlive() << " "
+     << getMoveDistance() << " "
+     << getAttackRange();
   return ss.str();
 }
 
@@ -182,26 +177,25 @@ std::unique_ptr<NPC> NPC::deserialize(const std::string &data) {
 }
 
 double NPC::distance(const NPC &other) const {
-  std::shared_lock lock1(positionMutex_, std::defer_lock);
-  std::shared_lock lock2(other.positionMutex_, std::defer_lock);
-  std::lock(lock1, lock2);
-  
-  const double distanceX = x_ - other.x_;
-  const double distanceY = y_ - other.y_;
+  const double distanceX = getX() - other.getX();
+  const double distanceY = getY() - other.getY();
   return std::sqrt(distanceX * distanceX + distanceY * distanceY);
 }
 
 std::istream &operator>>(std::istream &in, NPC &npc) {
-  std::string type;
-  in >> type >> npc.x_ >> npc.y_ >> npc.name_;
-  npc.type_ = convertTypeFromString(type);
+  std::string type, name;
+  double x, y;
+  in >> type >> x >> y >> name;
+  npc.store_->setType(npc.slot_, convertTypeFromString(type));
+  npc.store_->setPosition(npc.slot_, x, y);
+  npc.store_->setName(npc.slot_, name);
   return in;
 }
 
 std::ostream &operator<<(std::ostream &out, const NPC &npc) {
   out << "NPC: "
       << "type=\"" << npc.getTypeString() << "\", "
-      << "name=" << npc.name_ << ", "
+      << "name=" << npc.getNameView() << ", "
       << "x=" << npc.getX() << ", "
       << "y=" << npc.getY() << ", "
       << "alive=" << (npc.isAlive() ? "да" : "нет") << std::endl;
@@ -218,6 +212,15 @@ NPCType convertTypeFromString(const std::string &type) {
   return NPCType::UNKNOWN;
 }
 
+std::string convertTypeToString(NPCType type) {
+  switch (type) {
+    case NPCType::KNIGHT: return "Странствующий рыцарь";
+    case NPCType::ELF: return "Эльф";
+    case NPCType::DRAGON: return "Дракон";
+    default: return "Неизвестный";
+  }
+}
+
 MoveDirection convertDirectionFromString(const std::string &direction) {
   if (direction == "вверх" || direction == "up" || direction == "TOP") 
     return MoveDirection::TOP;
@@ -241,10 +244,6 @@ std::string convertDirectionToString(MoveDirection direction) {
 }
 
 std::string generateRandomName(NPCType type) {
-  static std::random_device rd;
-  static std::mt19937 gen(rd());
-  static std::uniform_int_distribution<int> dist(1000, 9999);
-  
   std::string base;
   switch (type) {
     case NPCType::KNIGHT: base = "Рыцарь_"; break;
@@ -253,5 +252,5 @@ std::string generateRandomName(NPCType type) {
     default: base = "Существо_";
   }
   
-  return base + std::to_string(dist(gen));
+  return base + std::to_string(nextSharedStream(RandomPurpose::NAMING).uniformInt(1000, 9999));
 }
\ No newline at end of file